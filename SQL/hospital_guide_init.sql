@@ -9,7 +9,10 @@ CREATE TABLE IF NOT EXISTS Patients (
     BirthDate DATE NOT NULL,
     Gender ENUM('Male', 'Female', 'Other') NOT NULL,
     VisitType ENUM('Outpatient', 'Inpatient') NOT NULL,
-    PhotoPath VARCHAR(255)
+    PhotoPath VARCHAR(255),
+    -- 机器人端按修改时间增量同步
+    UpdatedAt TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP,
+    INDEX idx_patients_updated (UpdatedAt)
 );
 
 CREATE TABLE IF NOT EXISTS Departments (
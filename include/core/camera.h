@@ -0,0 +1,174 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#define CAMERA_DEVICE "/dev/video0"
+
+// 一帧灰度图，像素缓冲在帧池创建时分配，之后反复复用
+struct CameraFrame {
+    cv::Mat gray;
+    uint64_t seq = 0;
+    uint64_t t_ns = 0;   // 采集完成时刻（Clock::nowNs）
+};
+
+// 帧来源：把下一帧灰度图写进调用方给的缓冲（尺寸为 width() x height()）
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+    virtual bool open() = 0;
+    virtual void close() = 0;
+    virtual int width() const = 0;
+    virtual int height() const = 0;
+    // 等待下一帧，超时或出错返回 false
+    virtual bool grab(cv::Mat& gray, int timeout_ms) = 0;
+};
+
+// V4L2 采集：驱动的 MMAP 缓冲轮转使用，YUYV / NV12 直接取 Y 平面得到灰度，不经过 BGR
+class V4l2Source : public FrameSource {
+public:
+    explicit V4l2Source(const std::string& device = CAMERA_DEVICE, int width = 640, int height = 480, int buffers = 4);
+    ~V4l2Source() override;
+
+    bool open() override;
+    void close() override;
+    int width() const override { return w; }
+    int height() const override { return h; }
+    bool grab(cv::Mat& gray, int timeout_ms) override;
+
+private:
+    struct Buffer {
+        void* start = nullptr;
+        size_t length = 0;
+    };
+
+    bool setFormat();
+    bool mapBuffers();
+
+    std::string device;
+    int fd = -1;
+    int w;
+    int h;
+    int buffer_count;
+    uint32_t pixel_format = 0;
+    uint32_t bytes_per_line = 0;
+    std::vector<Buffer> buffers;
+};
+
+// 测试用：按文件名顺序读一个目录（或单个文件）里的图片，按 fps 节拍出帧，可循环
+class FileSequenceSource : public FrameSource {
+public:
+    explicit FileSequenceSource(const std::string& path, double fps = 15.0, bool loop = true);
+
+    bool open() override;
+    void close() override {}
+    int width() const override { return w; }
+    int height() const override { return h; }
+    bool grab(cv::Mat& gray, int timeout_ms) override;
+
+private:
+    std::string path;
+    uint64_t period_ns;
+    bool loop;
+    std::vector<std::string> files;
+    size_t next = 0;
+    uint64_t next_due_ns = 0;
+    int w = 0;
+    int h = 0;
+};
+
+// 固定帧池 + 只留最新帧的有界队列：
+// 采集端总能拿到空闲帧（没有空闲时回收最旧的待取帧），消费端取最新帧时更早的待取帧直接作废，
+// 识别看到的永远是最新画面。帧和索引表都在构造时分配，运行期间不再分配内存。
+class FramePool {
+public:
+    // depth：最多保留几帧待取，1 表示只留最新一帧
+    FramePool(int width, int height, size_t depth = 1);
+
+    // 采集端：取一帧来写，写完 publish，采集失败 discard
+    CameraFrame* acquire();
+    void publish(CameraFrame* frame);
+    void discard(CameraFrame* frame);
+
+    // 消费端：取走最新一帧，没有时最多等 timeout_ms；用完必须 release
+    CameraFrame* takeLatest(int timeout_ms);
+    void release(CameraFrame* frame);
+
+    // 唤醒所有等待的消费者（停止采集时）
+    void wake();
+
+    uint64_t dropped() const { return dropped_frames.load(); }
+    int width() const { return frames.front().gray.cols; }
+    int height() const { return frames.front().gray.rows; }
+
+private:
+    std::vector<CameraFrame> frames;
+    std::vector<CameraFrame*> free_list;
+    std::vector<CameraFrame*> ready;      // 先后顺序，最多 depth 个
+    size_t depth;
+    uint64_t next_seq = 1;
+    uint64_t wake_gen = 0;
+    std::atomic<uint64_t> dropped_frames{0};
+
+    std::mutex mtx;
+    std::condition_variable cv;
+};
+
+// 摄像头：后台线程从 FrameSource 采集到 FramePool，识别端随取随用
+class Camera {
+public:
+    // 持有一帧，析构时还回帧池；同时持有帧池，尺寸变化换池后旧池等最后一帧还回才释放
+    class Frame {
+    public:
+        Frame() = default;
+        Frame(std::shared_ptr<FramePool> pool, CameraFrame* frame) : pool(std::move(pool)), frame(frame) {}
+        Frame(Frame&& other) noexcept : pool(std::move(other.pool)), frame(other.frame) { other.frame = nullptr; }
+        Frame& operator=(Frame&& other) noexcept;
+        Frame(const Frame&) = delete;
+        Frame& operator=(const Frame&) = delete;
+        ~Frame() { reset(); }
+
+        explicit operator bool() const { return frame != nullptr; }
+        const CameraFrame& operator*() const { return *frame; }
+        const CameraFrame* operator->() const { return frame; }
+        void reset();
+
+    private:
+        std::shared_ptr<FramePool> pool;
+        CameraFrame* frame = nullptr;
+    };
+
+    explicit Camera(std::unique_ptr<FrameSource> source, size_t depth = 1);
+    ~Camera();
+
+    // spec 以 /dev/ 开头走 V4L2，否则当作图片目录或文件；打开并开始采集，失败返回空
+    static std::unique_ptr<Camera> open(const std::string& spec);
+
+    bool start();
+    void stop();
+    bool isRunning() const { return running.load(); }
+
+    // 最新一帧（每帧只会被取走一次），超时返回空 Frame
+    Frame latest(int timeout_ms);
+
+    uint64_t droppedFrames() const { return pool ? pool->dropped() : 0; }
+
+private:
+    void captureLoop();
+
+    std::unique_ptr<FrameSource> source;
+    size_t depth;
+    std::shared_ptr<FramePool> pool;
+    std::atomic<bool> running{false};
+    std::thread capture_thread;
+};
+
+#endif // CAMERA_H
@@ -0,0 +1,78 @@
+#ifndef COMMAND_SERVER_H
+#define COMMAND_SERVER_H
+
+#include <functional>
+#include <map>
+#include <string>
+#include "json.hpp"
+
+#define COMMAND_SOCKET_PATH "/tmp/robo_core.sock"
+
+// 本机命令接口：Unix 域套接字上的 JSON-lines 协议，每行一个请求、一行一个应答，
+//   -> {"id": 1, "cmd": "navigate", "target": "Emergency Room"}
+//   <- {"id": 1, "ok": true}
+// 单线程 epoll，非阻塞读写，每个连接只有一对输入/输出缓冲，不为连接开线程。
+// 请求在调用 poll() 的线程里交给 handler 顺序处理。
+// 耗时的请求（人脸识别）不能卡住 poll 线程：handler 里调用 defer() 并返回 null，
+// 之后在 poll 线程里用 complete() 写回应答；这类应答可能排在后续请求的应答之后，客户端按 id 对应。
+class CommandServer {
+public:
+    // 返回应答（不需要填 id，服务端会带回请求里的 id）；返回 null 表示已 defer()
+    using Handler = std::function<nlohmann::json(const nlohmann::json& request)>;
+
+    explicit CommandServer(Handler handler);
+    ~CommandServer();
+
+    CommandServer(const CommandServer&) = delete;
+    CommandServer& operator=(const CommandServer&) = delete;
+
+    // 监听 path，已存在的旧套接字文件会被删除
+    bool listen(const std::string& path = COMMAND_SOCKET_PATH);
+    void close();
+    bool listening() const { return listen_fd >= 0; }
+
+    // 处理已就绪的连接和请求，最多等待 timeout_ms
+    void poll(int timeout_ms);
+
+    size_t clientCount() const { return clients.size(); }
+
+    // 只能在 handler 内调用：当前请求稍后应答，返回令牌
+    uint64_t defer();
+    // 写回 defer() 的请求的应答；客户端已断开时丢弃
+    void complete(uint64_t token, nlohmann::json response);
+
+private:
+    struct Client {
+        std::string in;
+        std::string out;
+        uint64_t serial = 0;   // fd 会被复用，延迟应答靠它认出原来的连接
+        int deferred = 0;      // 还没写回的延迟应答
+        bool closing = false;  // 对端已关闭写方向，应答写完后断开
+    };
+    struct Pending {
+        int fd;
+        uint64_t serial;
+        nlohmann::json id;
+    };
+
+    void accept();
+    void readFrom(int fd);
+    void writeTo(int fd);
+    void drop(int fd);
+    void updateInterest(int fd);
+    std::string handleLine(const std::string& line);
+
+    Handler handler;
+    std::string path;
+    int listen_fd = -1;
+    int epoll_fd = -1;
+    std::map<int, Client> clients;
+    uint64_t next_serial = 0;
+    // handleLine 正在处理的请求，供 defer() 使用
+    int current_fd = -1;
+    const nlohmann::json* current_request = nullptr;
+    std::map<uint64_t, Pending> pending;
+    uint64_t next_token = 0;
+};
+
+#endif // COMMAND_SERVER_H
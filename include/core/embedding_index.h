@@ -0,0 +1,78 @@
+#ifndef EMBEDDING_INDEX_H
+#define EMBEDDING_INDEX_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 图库超过这么多张脸时建倒排索引，之前暴力扫描已经在亚毫秒级
+#define EMBEDDING_IVF_MIN_ROWS 50000
+
+struct EmbeddingMatch {
+    int row = -1;
+    float similarity = -1.0f;   // 余弦相似度
+};
+
+// 一行向量来自的图片文件，缓存重新加载时据此判断图片是否换过
+struct EmbeddingSource {
+    uint64_t size = 0;
+    int64_t mtime = 0;          // 文件修改时间，文件系统时钟的计数
+
+    bool operator==(const EmbeddingSource& o) const { return size == o.size && mtime == o.mtime; }
+    bool operator!=(const EmbeddingSource& o) const { return !(*this == o); }
+};
+
+// 人脸特征向量库：向量先归一化再按行量化成 int8，连续存放在一块内存里（每行补齐到 32 字节），
+// 查询时用 NEON / AVX2 做 int8 点积，乘上两边的量化系数就是余弦相似度。
+// 512 维每人约 0.5KB，LBPH 默认参数每人 16k 个直方图元素。
+// 可选 IVF：球面 k-means 聚成 nlist 个簇，查询只扫最近的 nprobe 个簇。
+// 查询是只读的，可并发；add / buildIvf / load 需要调用方保证没有并发查询。
+class EmbeddingIndex {
+public:
+    explicit EmbeddingIndex(int dim = 128);
+
+    int dim() const { return d; }
+    size_t size() const { return names.size(); }
+    size_t bytesPerRow() const { return stride + sizeof(float); }
+
+    // 加入一个向量，同名已存在时覆盖，返回行号
+    int add(const std::string& name, const float* embedding, const EmbeddingSource& source = {});
+    // 删除一行，最后一行挪到它的位置；已建的 IVF 作废，需要重新 buildIvf
+    bool remove(const std::string& name);
+    bool contains(const std::string& name) const { return rows.count(name) > 0; }
+    // 行号，不存在时为 -1
+    int find(const std::string& name) const;
+    const std::string& name(int row) const { return names[row]; }
+    const EmbeddingSource& source(int row) const { return sources[row]; }
+
+    // 相似度最高的 k 个，从高到低
+    std::vector<EmbeddingMatch> search(const float* query, size_t k = 1) const;
+
+    // nlist 为 0 时取 sqrt(行数)；之后新增的行不进簇，查询时单独暴力扫描
+    void buildIvf(int nlist = 0, int nprobe = 16);
+    bool hasIvf() const { return !lists.empty(); }
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+private:
+    float quantize(const float* v, int8_t* out) const;
+    float similarity(const int8_t* q, float q_scale, int row) const;
+    void scanRow(const int8_t* q, float q_scale, int row, std::vector<EmbeddingMatch>& best, size_t k) const;
+
+    int d;
+    size_t stride;                      // 每行字节数，补齐到 32
+    std::vector<int8_t> codes;          // size() * stride
+    std::vector<float> scales;          // 每行反量化系数
+    std::vector<std::string> names;
+    std::vector<EmbeddingSource> sources;
+    std::unordered_map<std::string, int> rows;
+
+    std::vector<float> centroids;       // nlist * d，单位长度
+    std::vector<std::vector<int>> lists;
+    int nprobe = 16;
+    size_t ivf_rows = 0;                // 建簇时的行数，之后的行在簇外
+};
+
+#endif // EMBEDDING_INDEX_H
@@ -0,0 +1,71 @@
+#ifndef FACE_DETECTOR_H
+#define FACE_DETECTOR_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include <opencv2/dnn.hpp>
+
+#define HAAR_CASCADE_PATH "/usr/local/share/opencv4/haarcascades/haarcascade_frontalface_default.xml"
+// OpenCV 的 res10 SSD 人脸检测模型（fp16 权重约 5MB），也可以换成同结构的 int8 ONNX
+#define DNN_FACE_MODEL "../source/models/res10_300x300_ssd_iter_140000_fp16.caffemodel"
+#define DNN_FACE_CONFIG "../source/models/deploy.prototxt"
+
+// 人脸检测接口：输入灰度或 BGR 帧，返回帧坐标系下的人脸框
+class FaceDetector {
+public:
+    virtual ~FaceDetector() = default;
+    virtual const char* name() const = 0;
+    virtual std::vector<cv::Rect> detect(const cv::Mat& frame) = 0;
+    // 一次检测多帧，默认逐帧调用 detect
+    virtual std::vector<std::vector<cv::Rect>> detectBatch(const std::vector<cv::Mat>& frames);
+};
+
+// 原来的 Haar 级联检测
+class HaarFaceDetector : public FaceDetector {
+public:
+    bool load(const std::string& cascade_path = HAAR_CASCADE_PATH);
+    const char* name() const override { return "haar"; }
+    std::vector<cv::Rect> detect(const cv::Mat& frame) override;
+
+private:
+    cv::CascadeClassifier cascade;
+    cv::Mat gray;
+};
+
+// OpenCV DNN 上跑的 SSD 类 CNN 检测器（输出 [1,1,N,7]：图号、类别、置信度、归一化 x1 y1 x2 y2）
+struct DnnDetectorConfig {
+    std::string model = DNN_FACE_MODEL;
+    std::string config = DNN_FACE_CONFIG;   // ONNX 模型留空
+    cv::Size input_size = cv::Size(300, 300);
+    cv::Scalar mean = cv::Scalar(104.0, 177.0, 123.0);
+    float score_threshold = 0.6f;
+    int threads = 2;                        // OpenCV 线程池大小（全局设置），<= 0 不修改
+};
+
+class DnnFaceDetector : public FaceDetector {
+public:
+    bool load(const DnnDetectorConfig& config = DnnDetectorConfig());
+    const char* name() const override { return "dnn"; }
+    std::vector<cv::Rect> detect(const cv::Mat& frame) override;
+    // 多帧拼成一个 batch 前向一次
+    std::vector<std::vector<cv::Rect>> detectBatch(const std::vector<cv::Mat>& frames) override;
+
+private:
+    const cv::Mat& toBgr(const cv::Mat& frame, cv::Mat& scratch);
+    void parse(const std::vector<cv::Size>& sizes, std::vector<std::vector<cv::Rect>>& faces);
+
+    DnnDetectorConfig cfg;
+    cv::dnn::Net net;
+    // 输入 blob、输出和颜色转换缓冲都复用，尺寸不变时不重新分配
+    cv::Mat blob;
+    cv::Mat output;
+    std::vector<cv::Mat> bgr;
+    std::vector<cv::Mat> batch;
+};
+
+// kind 为 "dnn" 时优先加载 DNN 检测器，加载失败或其他取值用 Haar；都失败返回空
+std::unique_ptr<FaceDetector> makeFaceDetector(const std::string& kind);
+
+#endif // FACE_DETECTOR_H
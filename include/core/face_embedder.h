@@ -0,0 +1,32 @@
+#ifndef FACE_EMBEDDER_H
+#define FACE_EMBEDDER_H
+
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include <opencv2/dnn.hpp>
+
+// OpenCV Zoo 的 SFace（int8 量化 ONNX，约 10MB），输入 112x112 BGR，输出 128 维
+#define FACE_EMBED_MODEL "../source/models/face_recognition_sface_2021dec_int8.onnx"
+
+// 人脸特征提取：把一张人脸裁图映射成定长向量，同一个人的向量余弦相似度高，对光照不敏感
+class FaceEmbedder {
+public:
+    bool load(const std::string& model = FACE_EMBED_MODEL);
+    bool loaded() const { return d > 0; }
+    int dim() const { return d; }
+
+    // face：检测框裁出的灰度或 BGR 图；结果写入 out（dim() 个 float）
+    bool embed(const cv::Mat& face, std::vector<float>& out);
+
+private:
+    cv::dnn::Net net;
+    cv::Size input_size = cv::Size(112, 112);
+    int d = 0;
+    // 颜色转换、输入 blob 和输出都复用
+    cv::Mat bgr;
+    cv::Mat blob;
+    cv::Mat output;
+};
+
+#endif // FACE_EMBEDDER_H
@@ -0,0 +1,46 @@
+#ifndef FACE_PREFETCH_H
+#define FACE_PREFETCH_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "face_recognizer.h"
+#include "patient_store.h"
+
+// 按挂号预取人脸：每天早上读取当天 Registrations.AppointmentTime，
+// 把这些患者的人脸模板装进 FaceRecognizerLib 的热层，全量图库仍留在磁盘/冷层
+class FacePrefetcher {
+public:
+    FacePrefetcher(PatientStore& store, FaceRecognizerLib& recognizer, int refresh_hour = 6);
+    ~FacePrefetcher();
+
+    // 立即预取一次今天，之后每天 refresh_hour 点刷新
+    void start();
+    void stop();
+
+    // 装载 day（YYYY-MM-DD）有挂号的患者，返回热层人数
+    size_t prefetch(const std::string& day);
+
+    // 同步回调：当天新挂号的患者追加进热层（可直接挂在 PatientSync 的变更回调上）
+    void notifyPatients(const std::vector<int>& patientIds);
+
+private:
+    void scheduleLoop();
+    static std::string currentDay();
+    static std::string faceFileFor(const PatientRecord& patient);
+
+    PatientStore& store;
+    FaceRecognizerLib& recognizer;
+    int refresh_hour;
+
+    std::atomic<bool> running{false};
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::thread schedule_thread;
+    std::string loaded_day;
+};
+
+#endif // FACE_PREFETCH_H
@@ -0,0 +1,84 @@
+#ifndef FACE_QUALITY_H
+#define FACE_QUALITY_H
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+// 人脸质量门限，清晰度和姿态在缩放到 FaceQualityGate::NORM_SIZE 的裁图上计算，与距离无关
+struct FaceQualityConfig {
+    int min_size = 60;               // 人脸框短边（像素）
+    double min_sharpness = 50.0;     // 拉普拉斯方差，运动模糊时远低于这个值
+    double min_brightness = 40.0;    // 平均亮度
+    double max_brightness = 215.0;
+    double max_clipped = 0.3;        // 过暗（<16）或过曝（>239）像素占比上限
+    double min_symmetry = 0.35;      // 眼部条带左右镜像相关系数，侧脸明显偏低
+};
+
+struct FaceQuality {
+    enum class Reject { None, Small, Blur, Exposure, Pose };
+
+    int size = 0;
+    double sharpness = 0.0;
+    double brightness = 0.0;
+    double clipped = 0.0;
+    double symmetry = 0.0;
+    Reject reject = Reject::None;
+    double score = 0.0;              // 越大越好，只在通过门限的裁图之间比较
+
+    bool ok() const { return reject == Reject::None; }
+};
+
+const char* faceRejectName(FaceQuality::Reject reject);
+
+// 廉价的人脸预筛：尺寸、模糊、曝光、正脸程度，不合格的裁图不进入匹配
+class FaceQualityGate {
+public:
+    static constexpr int NORM_SIZE = 96;
+
+    explicit FaceQualityGate(const FaceQualityConfig& config = FaceQualityConfig());
+
+    // gray 中 face 框的质量，按尺寸、模糊、曝光、姿态的顺序检查，遇到第一个不合格项就返回
+    FaceQuality assess(const cv::Mat& gray, const cv::Rect& face);
+
+    const FaceQualityConfig& config() const { return cfg; }
+
+private:
+    double symmetry() const;
+
+    FaceQualityConfig cfg;
+    // 归一化裁图和拉普拉斯结果复用
+    cv::Mat norm;
+    cv::Mat laplacian;
+};
+
+// 跨帧跟踪人脸（按框重叠关联），每条轨迹保留质量最好的一张裁图，
+// 一次导引只对最好的那张做匹配，模糊和侧脸帧不浪费识别时间
+class FaceTracker {
+public:
+    struct Track {
+        int id = 0;
+        cv::Rect rect;               // 最近一帧的位置
+        int missed = 0;              // 连续未出现的帧数
+        int frames = 0;
+        bool has_crop = false;
+        FaceQuality best;
+        cv::Mat crop;                // 质量最好的一张裁图（灰度）
+        uint64_t crop_t_ns = 0;
+    };
+
+    // 更新一帧的检测结果，quality 与 faces 一一对应
+    void update(const cv::Mat& gray, const std::vector<cv::Rect>& faces,
+                const std::vector<FaceQuality>& quality, uint64_t t_ns);
+
+    // 所有轨迹里质量最好的一张合格裁图，没有则为空
+    const Track* best() const;
+    size_t size() const { return tracks.size(); }
+    void reset();
+
+private:
+    std::vector<Track> tracks;
+    int next_id = 1;
+};
+
+#endif // FACE_QUALITY_H
@@ -3,26 +3,78 @@
 
 #include <opencv2/opencv.hpp>
 #include <opencv2/face.hpp>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <map>
+#include "embedding_index.h"
+#include "face_detector.h"
+#include "face_embedder.h"
+#include "face_quality.h"
 
 class FaceRecognizerLib {
 public:
-    // 初始化并加载人脸数据
+    // 初始化并加载人脸数据；检测器默认 Haar，ROBO_FACE_DETECTOR=dnn 时用 DNN 检测器；
+    // 匹配默认 LBPH，ROBO_FACE_RECOGNIZER=embedding 时用特征向量库
     bool init(const std::string& face_folder);
+    bool usesEmbeddings() const { return gallery != nullptr; }
+
+    // 替换人脸检测后端
+    void setDetector(std::unique_ptr<FaceDetector> detector);
+    const char* detectorName() const { return detector ? detector->name() : "none"; }
 
     // 识别给定图片中的人脸，返回最相似的人脸图片名
+    // 先匹配热层（今天有挂号的患者），距离超过热层阈值再查全量冷层
     std::pair<std::string, double> recognize(const std::string& capture_image_path);
+    // 同上，直接识别一帧（灰度或 BGR），摄像头帧池的帧不经过磁盘
+    std::pair<std::string, double> recognize(const cv::Mat& frame);
+    // 以上两个都先过质量门限，没有合格的人脸时返回未知
+
+    // 检测一帧并按质量更新跟踪器，只做检测和打分不做匹配；
+    // 连续几帧之后用 tracker.best() 的裁图调 recognizeCrop，一次导引只匹配一次
+    void track(const cv::Mat& frame, FaceTracker& tracker, uint64_t t_ns);
+    // 匹配一张已经裁好的人脸（灰度），不再检测
+    std::pair<std::string, double> recognizeCrop(const cv::Mat& crop);
+
+    // 热层：用人脸库目录下的这些图片（文件名）替换 / 追加热层模板
+    size_t loadHotFaces(const std::vector<std::string>& filenames);
+    size_t addHotFaces(const std::vector<std::string>& filenames);
+    size_t hotSize();
+
+    // 热层直接命中的最大 LBPH 距离，要明显小于最终接受阈值；超过则再查冷层，取两层中更近的
+    void setHotThreshold(double distance) { hot_threshold = distance; }
 
 private:
-    cv::CascadeClassifier face_cascade;
+    std::unique_ptr<FaceDetector> detector;
     cv::Ptr<cv::face::LBPHFaceRecognizer> recognizer;
     std::map<int, std::string> label_to_name;
     int current_label = 0;
+    std::string folder;
+
+    // 热层模型与标签，预取线程会替换，识别时加锁读取
+    std::mutex hot_mtx;
+    cv::Ptr<cv::face::LBPHFaceRecognizer> hot;
+    std::map<int, std::string> hot_label_to_name;
+    double hot_threshold = 50.0;
+
+    // 嵌入后端：冷层是启动时建好的只读向量库，热层是当天新增、冷层里还没有的人脸
+    std::unique_ptr<FaceEmbedder> embedder;
+    std::unique_ptr<EmbeddingIndex> gallery;
+    std::unique_ptr<EmbeddingIndex> hot_gallery;
+    // 检测器和特征模型都不可重入，识别与预取线程补图时互斥
+    std::mutex model_mtx;
+    FaceQualityGate gate;
 
     void loadFacesFromFolder(const std::string& folder);
+    void loadEmbeddingsFromFolder(const std::string& folder);
+    bool embedFile(const std::string& filename, std::vector<float>& embedding);
+    std::vector<cv::Rect> detectFaces(const cv::Mat& frame, cv::Mat& gray);
+    static void countReject(FaceQuality::Reject reject);
+    std::pair<std::string, double> matchFaces(const cv::Mat& gray, const std::vector<cv::Rect>& faces);
+    std::pair<std::string, double> matchEmbeddings(const cv::Mat& gray, const std::vector<cv::Rect>& faces);
     std::string getFaceFileNameFromLabel(int label);
+    bool readFace(const std::string& filename, cv::Mat& face);
 };
 
 #endif // FACE_RECOGNIZER_H
\ No newline at end of file
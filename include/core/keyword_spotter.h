@@ -0,0 +1,62 @@
+#ifndef KEYWORD_SPOTTER_H
+#define KEYWORD_SPOTTER_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "mfcc.h"
+#include "vad.h"
+#include "audio_capture.h"
+#include "json.hpp"
+
+// 离线关键词识别：VAD 截取一句话的 MFCC，与每个科室名的录音模板做 DTW 匹配。
+// 模板目录结构：<folder>/<科室名，非字母数字替换为 _>/*.wav（16kHz 单声道），
+// 例如 source/keywords/Emergency_Room/1.wav
+class KeywordSpotter {
+public:
+    using DetectCallback = std::function<void(const std::string& keyword, float distance)>;
+
+    explicit KeywordSpotter(const VadConfig& vad = VadConfig(), float threshold = 12.0f);
+
+    // 词表取自 nav.json 的科室名
+    static std::vector<std::string> vocabularyFromNav(const nlohmann::json& navJson);
+    static std::string folderNameFor(const std::string& keyword);
+
+    // 载入词表中每个词的模板，返回模板总数
+    size_t loadTemplates(const std::string& folder, const std::vector<std::string>& vocabulary);
+    bool enroll(const std::string& keyword, const std::string& wavPath);
+    size_t templateCount() const { return templates.size(); }
+
+    // 送入采集数据（16kHz，10ms 整数倍），可直接挂在 AudioCapture 回调上
+    void feed(const int16_t* samples, size_t count);
+    void setCallback(DetectCallback cb) { callback = std::move(cb); }
+    void reset();
+
+    // 阻塞监听一句话，返回匹配到的关键词，未匹配或超时返回空串
+    std::string listenOnce(AudioCapture& capture, int timeout_ms);
+
+private:
+    struct Template {
+        std::string keyword;
+        std::vector<float> feats;   // 帧数 x NUM_COEFFS，已做倒谱均值归一化
+    };
+
+    static void normalize(std::vector<float>& feats);
+    static float dtw(const std::vector<float>& a, const std::vector<float>& b);
+    std::string match(std::vector<float>& feats, float& distance) const;
+
+    MfccExtractor mfcc;
+    VoiceActivityDetector vad;
+    float threshold;
+    std::vector<Template> templates;
+
+    std::vector<float> history;     // 说话开始前的特征，用于补回起音
+    std::vector<float> utterance;
+    std::vector<float> scratch;
+    bool capturing = false;
+    bool finished = false;          // 一句话已结束（无论是否匹配）
+    std::string last_match;
+    DetectCallback callback;
+};
+
+#endif // KEYWORD_SPOTTER_H
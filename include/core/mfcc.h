@@ -0,0 +1,43 @@
+#ifndef MFCC_H
+#define MFCC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 16kHz 单声道 MFCC 流式提取：25ms 汉明窗、10ms 帧移、512 点 FFT、26 路 Mel 滤波、13 维倒谱
+class MfccExtractor {
+public:
+    static constexpr size_t SAMPLE_RATE = 16000;
+    static constexpr size_t WINDOW = 400;
+    static constexpr size_t HOP = 160;
+    static constexpr size_t FFT_SIZE = 512;
+    static constexpr size_t NUM_FILTERS = 26;
+    static constexpr size_t NUM_COEFFS = 13;
+
+    MfccExtractor();
+
+    // 追加 PCM，每凑够一个帧移就把一帧 NUM_COEFFS 维特征追加到 out，返回新增帧数
+    size_t push(const int16_t* samples, size_t count, std::vector<float>& out);
+    void reset();
+
+    // 原地复数 FFT（长度 FFT_SIZE，实部/虚部分开存放，便于向量化）
+    void fft(float* re, float* im) const;
+
+private:
+    void computeFrame(float* coeffs);
+
+    std::vector<float> window;
+    std::vector<float> twiddle_re;   // 按级连续存放：第 s 级（半长 h）位于 [h-1, 2h-1)
+    std::vector<float> twiddle_im;
+    std::vector<uint16_t> bitrev;
+    std::vector<float> mel_bank;     // NUM_FILTERS x (FFT_SIZE/2+1)
+    std::vector<float> dct;          // NUM_COEFFS x NUM_FILTERS
+
+    std::vector<float> pending;      // 未满一窗的历史采样
+    float prev_sample;               // 预加重状态
+    float re[FFT_SIZE];
+    float im[FFT_SIZE];
+};
+
+#endif // MFCC_H
@@ -0,0 +1,56 @@
+#ifndef MOTION_ARBITER_H
+#define MOTION_ARBITER_H
+
+#include <atomic>
+#include <cstdint>
+#include "motor.h"
+#include "speed_governor.h"
+
+// 能让机器人动（或要求它停）的来源，数值越大优先级越高
+enum class MotionSource : int { Nav = 0, Teleop, Pause, Emergency, Count };
+
+const char* motionSourceName(MotionSource source);
+
+// 运动指令仲裁：每个来源一个无锁槽位（一个原子字），来源随时写入自己的设定值，
+// 控制周期调用 tick() 时取最高优先级的有效请求下发电机。
+// 前进指令再经过障碍物限速器（它限制所有来源，只有停车类请求绕过它）。
+// 高优先级请求撤销后，低优先级来源保留的设定值在下一个周期原样生效，
+// 例如暂停恢复后导航按原来的目标占空比从静止平滑起步。
+class MotionArbiter {
+public:
+    explicit MotionArbiter(SpeedGovernor& governor);
+
+    // 请求以 duty 行驶，正为前进、负为后退（-100..100），直到 release()
+    void drive(MotionSource source, int duty);
+    // 请求停车（暂停、急停、遥控松杆）
+    void hold(MotionSource source);
+    // 撤销请求，交还给低优先级来源
+    void release(MotionSource source);
+
+    bool active(MotionSource source) const;
+    bool holding(MotionSource source) const;
+    // 该来源保留的设定值（停车请求为 0）
+    int setpoint(MotionSource source) const;
+
+    // 每个控制周期调用一次，返回实际施加的占空比（后退为负）。
+    // 同一时刻只有一个线程能执行 tick，其他线程的调用直接返回上次结果
+    int tick(Motor& motor);
+
+    // 上个周期生效的来源，没有任何请求时为 Count
+    MotionSource winner() const;
+    int applied() const;
+    // 距上次 tick 的时间（ns），用来判断控制循环是否还在跑
+    uint64_t sinceLastTickNs() const;
+
+private:
+    static uint32_t pack(bool hold, int duty);
+
+    SpeedGovernor& governor;
+    std::atomic<uint32_t> slots[static_cast<int>(MotionSource::Count)];
+    std::atomic<bool> ticking{false};
+    std::atomic<int> last_winner{static_cast<int>(MotionSource::Count)};
+    std::atomic<int> last_applied{0};
+    std::atomic<uint64_t> last_tick_ns{0};
+};
+
+#endif // MOTION_ARBITER_H
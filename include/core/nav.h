@@ -2,36 +2,56 @@
 #define NAV_H
 
 #include <atomic>
-#include <mutex>
-#include <condition_variable>
+#include <string>
 #include <thread>
 #include "motor.h"
 #include "servo.h"
 //#include "servonew.h" // 替换原来的 "servo.h"
 #include "yaw_tracker.h"
+#include "speed_governor.h"
+#include "motion_arbiter.h"
 #include "json.hpp"  // nlohmann::json 的头文件
 
 namespace Nav {
 
-// 全局控制标志与同步机制
+// 全局控制标志
 extern std::atomic<bool> startNavigation;
-extern std::atomic<bool> pauseNavigation;
-extern std::mutex navMutex;
-extern std::condition_variable navCV;
 
-// 暂停检查函数，暂停时停止电机运行
-void checkPause(Motor& motor);
+// 障碍物限速器，每个控制周期根据超声波距离调节占空比
+extern SpeedGovernor speedGovernor;
+
+// 驱动电机的运动仲裁器：导航、遥控、暂停、急停各写自己的槽位，
+// 暂停 = motion.hold(MotionSource::Pause)，恢复 = motion.release(MotionSource::Pause)
+extern MotionArbiter motion;
+
+// 当前导航进度快照，供状态总线等外部观察者读取
+struct Progress {
+    std::string target;
+    int step = -1;          // 正在执行的步骤序号，未在导航时为 -1
+    int steps = 0;
+    std::string action;
+    int value = 0;
+};
+Progress progress();
+
+// 控制周期（毫秒）
+constexpr int NAV_TICK_MS = 20;
+
+// 以目标占空比驱动一个控制周期（经仲裁器和限速器），返回导航实际得到的占空比，
+// 被暂停、急停或遥控接管时为 0
+int driveTick(Motor& motor, int targetDuty);
 
 // 前进函数，参数 duration_ms 为前进时长（毫秒）
 void moveForward(Motor& motor, int duration_ms);
 
-// 左转函数，参数 angle 为转动角度（度）
+// 左转函数，参数 angle 为转动角度（度）；yaw 须已按 YAW_RATE_HZ 启动（HardwareContext / 仿真负责）
 void turnLeft(Motor& motor, Servo& servo, YawTracker& yaw, float angle);
 
 // 右转函数，参数 angle 为转动角度（度）
 void turnRight(Motor& motor, Servo& servo, YawTracker& yaw, float angle);
 
 // 导航线程函数：轮询控制标志完成一次导航动作（前进、左转、前进、右转）
+// startNavigation 被置为 false 时在当前控制周期结束后退出
 void navigationThread(Motor* motor, Servo* servo, YawTracker* yaw, const std::string& target, nlohmann::json navJson);
 
 }  // namespace Nav
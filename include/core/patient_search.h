@@ -0,0 +1,87 @@
+#ifndef PATIENT_SEARCH_H
+#define PATIENT_SEARCH_H
+
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "patient_store.h"
+
+// 手动身份确认用的患者模糊检索：
+//   姓名三元组（trigram）倒排索引 + 性别/出生年份位图过滤，按三元组重合度排 top-k。
+// 三元组匹配天然容忍错别字与词序变化，输入每多一个字只需合并新增三元组的倒排表。
+struct PatientMatch {
+    int patientId = 0;
+    std::string name;
+    std::string birthDate;
+    std::string gender;
+    float score = 0.0f;     // 0~1，三元组 Jaccard 相似度
+};
+
+struct PatientSearchFilter {
+    std::string birthDate;  // 可为前缀：1990 / 1990-01 / 1990-01-01，空表示不过滤
+    std::string gender;     // Male / Female / Other，空表示不过滤
+};
+
+class PatientSearchIndex {
+public:
+    PatientSearchIndex() = default;
+
+    // 从本地患者库全量构建
+    void build(PatientStore& store);
+
+    // 新增或更新一个患者（旧条目标记删除，追加新条目）
+    void upsert(const PatientRecord& patient);
+
+    size_t size() const;
+
+    // 一个输入框对应一个会话，会话保存上一次查询的计数，支持逐键增量检索
+    class Session {
+    public:
+        explicit Session(const PatientSearchIndex& index) : index(index) {}
+
+        std::vector<PatientMatch> search(const std::string& text, const PatientSearchFilter& filter, size_t k = 10);
+        void reset();
+
+    private:
+        void apply(uint64_t gram, int delta);
+        void compact();
+
+        const PatientSearchIndex& index;
+        std::vector<uint64_t> active;               // 当前查询的三元组（已排序去重）
+        std::vector<uint16_t> counts;               // 每个条目命中的三元组数
+        std::vector<uint32_t> touched;              // counts 非零过的条目
+        size_t generation = 0;                      // 与索引版本不一致时重置
+    };
+
+private:
+    struct Doc {
+        int patientId;
+        std::string name;
+        std::string birthDate;
+        std::string gender;
+    };
+
+    // 按 UTF-8 码点切分，ASCII 转小写，空白/标点折叠为单个空格
+    static std::vector<uint32_t> normalize(const std::string& name);
+    // 码点三元组（21 bit x 3 打包进 64 位），前补两个空格；padEnd 为 false 时用于未输完的查询
+    static std::vector<uint64_t> trigrams(const std::string& name, bool padEnd);
+    static int genderCode(const std::string& gender);
+    static void setBit(std::vector<uint64_t>& bitmap, uint32_t doc);
+    static bool testBit(const std::vector<uint64_t>& bitmap, uint32_t doc);
+
+    void addLocked(const PatientRecord& patient);
+
+    mutable std::shared_mutex mtx;
+    std::vector<Doc> docs;
+    std::vector<uint16_t> doc_grams;        // 每个条目去重后的三元组数（排序时顺序访问，单独存放）
+    std::vector<uint64_t> deleted;          // 已删除条目位图
+    std::unordered_map<uint64_t, std::vector<uint32_t>> postings;
+    std::unordered_map<int, uint32_t> by_patient;
+    std::vector<uint64_t> gender_bitmaps[3];
+    std::unordered_map<int, std::vector<uint64_t>> year_bitmaps;
+    size_t generation = 0;  // 条目被删除/重建时递增
+};
+
+#endif // PATIENT_SEARCH_H
@@ -0,0 +1,101 @@
+#ifndef PATIENT_STORE_H
+#define PATIENT_STORE_H
+
+#include <sqlite3.h>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+// 与 SQL/hospital_guide_init.sql 中 HospitalGuide 库对应的记录
+struct PatientRecord {
+    int id = 0;
+    std::string name;
+    std::string birthDate;     // YYYY-MM-DD
+    std::string gender;        // Male / Female / Other
+    std::string visitType;     // Outpatient / Inpatient
+    std::string photoPath;
+};
+
+struct DepartmentRecord {
+    int id = 0;
+    std::string name;
+    int x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+};
+
+struct RegistrationRecord {
+    int id = 0;
+    int patientId = 0;
+    int departmentId = 0;
+    std::string appointmentTime;   // YYYY-MM-DD HH:MM:SS
+    std::string notes;
+};
+
+// 机器人本地的患者/科室/挂号镜像（SQLite），离线可用，查询走预编译语句与索引
+class PatientStore {
+public:
+    PatientStore() = default;
+    ~PatientStore();
+    PatientStore(const PatientStore&) = delete;
+    PatientStore& operator=(const PatientStore&) = delete;
+
+    // 失败时关闭连接，之后可以重新 open
+    bool open(const std::string& path);
+    void close();
+    const std::string& path() const { return db_path; }
+
+    // 批量写入时包一层事务；中途有写入失败时回滚，不留下半批数据。
+    // 事务属于整个连接，批量写入的线程要用自己打开的 PatientStore，不能和查询线程共用
+    bool beginBatch();
+    bool commitBatch();
+    bool rollbackBatch();
+
+    bool upsertPatient(const PatientRecord& p);
+    bool upsertDepartment(const DepartmentRecord& d);
+    bool upsertRegistration(const RegistrationRecord& r);
+    bool removeRegistration(int registrationId);
+
+    std::optional<PatientRecord> findPatient(int patientId);
+    // 遍历全部患者（回调内不可再访问本 store）
+    void forEachPatient(const std::function<void(const PatientRecord&)>& fn);
+    std::vector<PatientRecord> findPatients(const std::string& name, const std::string& birthDate);
+    std::optional<DepartmentRecord> findDepartment(int departmentId);
+    std::vector<DepartmentRecord> allDepartments();
+
+    // 某患者在 after（含）之后最近的一次挂号
+    std::optional<RegistrationRecord> nextRegistration(int patientId, const std::string& after);
+    // 时间区间 [from, to) 内的全部挂号
+    std::vector<RegistrationRecord> registrationsBetween(const std::string& from, const std::string& to);
+
+    // 增量同步水位（各表已同步的最大 ID、最近修改时间等）
+    long long syncMark(const std::string& key);
+    bool setSyncMark(const std::string& key, long long value);
+
+private:
+    bool exec(const char* sql);
+    sqlite3_stmt* prepare(const char* sql);
+    bool step(sqlite3_stmt* stmt);
+    void closeLocked();
+
+    sqlite3* db = nullptr;
+    std::string db_path;
+    std::mutex mtx;
+    std::vector<sqlite3_stmt*> statements;
+
+    sqlite3_stmt* stmt_upsert_patient = nullptr;
+    sqlite3_stmt* stmt_upsert_department = nullptr;
+    sqlite3_stmt* stmt_upsert_registration = nullptr;
+    sqlite3_stmt* stmt_remove_registration = nullptr;
+    sqlite3_stmt* stmt_find_patient = nullptr;
+    sqlite3_stmt* stmt_find_patients = nullptr;
+    sqlite3_stmt* stmt_all_patients = nullptr;
+    sqlite3_stmt* stmt_find_department = nullptr;
+    sqlite3_stmt* stmt_all_departments = nullptr;
+    sqlite3_stmt* stmt_next_registration = nullptr;
+    sqlite3_stmt* stmt_registrations_between = nullptr;
+    sqlite3_stmt* stmt_get_mark = nullptr;
+    sqlite3_stmt* stmt_set_mark = nullptr;
+};
+
+#endif // PATIENT_STORE_H
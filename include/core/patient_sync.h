@@ -0,0 +1,54 @@
+#ifndef PATIENT_SYNC_H
+#define PATIENT_SYNC_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "patient_store.h"
+
+// 医院 MySQL 连接参数（对应 SQL/hospital_guide_init.sql 的 HospitalGuide 库）
+struct HospitalDbConfig {
+    std::string host = "localhost";
+    int port = 3306;
+    std::string user = "remote_user";
+    std::string password;
+    std::string database = "HospitalGuide";
+};
+
+// 后台定期把 MySQL 的增量数据拉到本地 PatientStore：
+//   Departments 全量；Patients 按 UpdatedAt 水位增量（新增和修改都会拉到）；
+//   Registrations 按 RegistrationID 水位增量，并重新核对今天及以后的挂号（捕获改约/取消）
+// 网络不可达时跳过本轮，本地镜像继续提供查询
+class PatientSync {
+public:
+    // 本轮同步中新增、修改的患者或挂号有变化的 PatientID（在同步线程中回调）
+    using ChangeCallback = std::function<void(const std::vector<int>& patientIds)>;
+
+    PatientSync(PatientStore& store, const HospitalDbConfig& config, int interval_sec = 60);
+    ~PatientSync();
+
+    void setChangeCallback(ChangeCallback cb);
+    void start();
+    void stop();
+
+private:
+    void syncLoop();
+    // 写入 mirror（同一个库的另一条连接），store 只用来提供库路径
+    bool syncOnce(const std::string& connection, PatientStore& mirror);
+
+    PatientStore& store;
+    HospitalDbConfig config;
+    int interval_sec;
+
+    std::atomic<bool> running{false};
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::thread sync_thread;
+    ChangeCallback on_change;
+};
+
+#endif // PATIENT_SYNC_H
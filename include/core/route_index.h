@@ -0,0 +1,55 @@
+#ifndef ROUTE_INDEX_H
+#define ROUTE_INDEX_H
+
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "patient_store.h"
+
+// 识别结果到导航目标的预计算索引：
+//   人脸图片名（Patients.PhotoPath 的文件名，如 101.jpg） -> PatientID -> 最近一次挂号 -> 科室
+// 识别出人脸后只需两次哈希查找即可拿到科室，不再查库
+struct PatientRoute {
+    int patientId = 0;
+    std::string patientName;
+    int registrationId = 0;
+    std::string appointmentTime;
+    int departmentId = 0;
+    std::string departmentName;
+};
+
+class RouteIndex {
+public:
+    explicit RouteIndex(PatientStore& store);
+
+    // 全量重建（启动时或跨天时调用），today 格式 YYYY-MM-DD
+    void rebuild(const std::string& today);
+
+    // 增量更新：重新计算这些患者的图片名与最近挂号（可直接挂在 PatientSync 的变更回调上）
+    void update(const std::vector<int>& patientIds);
+
+    // 按人脸图片名查路由；没有今天及以后的挂号时返回空
+    std::optional<PatientRoute> lookup(const std::string& faceLabel) const;
+    std::optional<PatientRoute> lookupPatient(int patientId) const;
+
+    // 索引对应的日期（YYYY-MM-DD），跨天后需要 rebuild
+    std::string builtFor() const;
+    size_t size() const;
+
+private:
+    static std::string labelFromPhotoPath(const std::string& photoPath);
+    std::optional<PatientRoute> computeRoute(const PatientRecord& patient);
+
+    PatientStore& store;
+    std::string today;
+    std::unordered_map<int, std::string> department_names;
+
+    mutable std::shared_mutex mtx;
+    std::unordered_map<std::string, int> label_to_patient;
+    std::unordered_map<int, std::string> patient_to_label;
+    std::unordered_map<int, PatientRoute> routes;
+};
+
+#endif // ROUTE_INDEX_H
@@ -0,0 +1,49 @@
+#ifndef SPEED_GOVERNOR_H
+#define SPEED_GOVERNOR_H
+
+#include <atomic>
+#include "range_source.h"
+
+// 连续这么多个控制周期（20ms）读到传感器故障才判定失效，偶发一次读失败不降速
+#define GOVERNOR_FAULT_TICKS 10
+
+// 根据前方障碍距离连续调节电机占空比：
+//   距离 <= stop_cm         -> 0（停车）
+//   stop_cm ~ clear_cm      -> 线性降速
+//   距离 >= clear_cm / 无回波 -> 目标占空比
+//   传感器连续故障          -> 最多 min_duty（慢速区），直到读数恢复
+// 每个控制周期占空比变化不超过 ramp_step，实现平滑减速/起步
+class SpeedGovernor {
+public:
+    SpeedGovernor(float stop_cm = 20.0f, float clear_cm = 60.0f, int min_duty = 20, int ramp_step = 4);
+
+    // 绑定测距源（可为空，空时不限速）
+    void attach(const RangeSource* sensor);
+
+    // 每个控制周期调用一次，返回本周期应施加的占空比
+    int update(int target_duty);
+
+    // 从静止重新起步（新动作开始或暂停恢复后调用）
+    void reset();
+
+    // 当前是否因障碍物而停车
+    bool blocked() const;
+
+    // 测距源是否处于故障状态（连续 GOVERNOR_FAULT_TICKS 个周期读到 RANGE_ERROR）
+    bool sensorFault() const;
+
+private:
+    int limitFor(int target_duty, float distance);
+
+    std::atomic<const RangeSource*> sensor;
+    float stop_cm;
+    float clear_cm;
+    int min_duty;
+    int ramp_step;
+    int current_duty;
+    int error_ticks;
+    std::atomic<bool> is_blocked;
+    std::atomic<bool> is_faulted;
+};
+
+#endif // SPEED_GOVERNOR_H
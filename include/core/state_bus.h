@@ -0,0 +1,109 @@
+#ifndef STATE_BUS_H
+#define STATE_BUS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#define STATE_BUS_NAME "/robo_state_bus"
+#define STATE_BUS_TEXT 64
+#define COMMAND_RING_SLOTS 64        // 2 的幂
+
+// 机器人核心进程发布的状态快照（定长 POD，直接放在共享内存里）
+// Stopped 表示急停生效中，不论是否在导航
+enum class NavState : int32_t { Idle = 0, Running, Paused, Stopped };
+
+struct RobotState {
+    uint64_t t_ns = 0;                    // 发布时刻，CLOCK_MONOTONIC，两个进程可直接比较
+    uint32_t heartbeat = 0;               // 每次发布加一
+    NavState nav = NavState::Idle;
+    char target[STATE_BUS_TEXT] = {};     // 当前或上一次导航的科室
+    int32_t step = -1;                    // 正在执行的步骤序号，未导航时为 -1
+    int32_t steps = 0;
+    char action[16] = {};
+    int32_t value = 0;
+    float heading_deg = 0.0f;             // 陀螺仪积分的航向（位姿里只有这一项有传感器）
+    float obstacle_cm = -1.0f;            // 超声波读数，<0 表示无读数
+    bool range_fault = false;             // 超声波失效，前进限速在慢速区
+    float battery_v = 0.0f;               // 没有电池检测硬件时为 NaN
+    int32_t left_duty = 0;                // 电机指令，带方向的占空比
+    int32_t right_duty = 0;
+    int32_t servo_us = 0;
+    int32_t motion_source = 4;            // 当前控制电机的来源（MotionSource），4 表示无
+    bool hardware_ready = false;
+    uint32_t recognition_id = 0;          // 最近一次处理完的识别命令编号
+    char recognized[STATE_BUS_TEXT] = {}; // 该次识别得到的科室，空表示未识别出
+};
+
+enum class BusCommandType : uint32_t {
+    Navigate = 1,          // text = 科室
+    Pause,
+    Resume,
+    Cancel,
+    Recognize,             // 只识别，结果写回 RobotState::recognized
+    RecognizeAndGuide,     // 识别后直接导航
+    VoiceStart,
+    VoiceStop,
+    Teleop,                // value = 占空比（正前进、负后退）
+    TeleopRelease,
+    EmergencyStop          // value 非 0 急停，0 解除
+};
+
+struct BusCommand {
+    BusCommandType type = BusCommandType::Cancel;
+    uint32_t id = 0;
+    int32_t value = 0;
+    char text[STATE_BUS_TEXT] = {};
+};
+
+// GUI 进程与机器人核心进程之间的共享内存总线：
+// 状态块是单写者 seqlock，读者不加锁也不会阻塞写者，读到写了一半的数据时重试；
+// 命令环是有界无锁队列（每槽一个序号），多个 GUI/脚本进程可以同时投递，核心进程单独消费。
+// 核心进程 create()，其他进程 attach()；核心退出时 unlink。
+class StateBus {
+public:
+    static std::unique_ptr<StateBus> create(const std::string& name = STATE_BUS_NAME);
+    static std::unique_ptr<StateBus> attach(const std::string& name = STATE_BUS_NAME);
+    ~StateBus();
+
+    StateBus(const StateBus&) = delete;
+    StateBus& operator=(const StateBus&) = delete;
+
+    // 只允许核心进程的一个线程调用
+    void publish(const RobotState& state);
+    // 从未发布过，或发布者停在写入中途（进程被杀）读不到一致快照时返回 false
+    bool read(RobotState& out) const;
+    // 最近 max_age_ns 内有过发布，用来判断核心进程是否还活着
+    bool alive(uint64_t max_age_ns) const;
+
+    // 队列满时返回 false
+    bool send(const BusCommand& cmd);
+    // 核心进程取命令，没有命令时返回 false
+    bool receive(BusCommand& cmd);
+
+    // 给命令分配编号（跨进程递增）
+    uint32_t nextCommandId();
+
+    static uint64_t nowNs();
+
+private:
+    struct Layout;
+    StateBus(Layout* layout, std::string name, bool owner);
+
+    Layout* layout;
+    std::string name;
+    bool owner;
+};
+
+// 定长字符串字段赋值，超长截断
+template <size_t N>
+inline void copyBusText(char (&dst)[N], const std::string& src) {
+    size_t n = src.size() < N - 1 ? src.size() : N - 1;
+    std::memcpy(dst, src.data(), n);
+    dst[n] = '\0';
+}
+
+#endif // STATE_BUS_H
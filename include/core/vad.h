@@ -0,0 +1,47 @@
+#ifndef VAD_H
+#define VAD_H
+
+#include <cstddef>
+#include <cstdint>
+
+// 语音端点检测参数，时间单位均为 10ms 帧
+struct VadConfig {
+    float threshold_db = -45.0f;   // 绝对能量门限（dBFS）
+    float noise_margin_db = 9.0f;  // 高于自适应噪声底的裕量
+    float max_zcr = 0.35f;         // 过零率上限，过高视为嘶声/噪声
+    int onset_frames = 3;          // 连续多少帧有声才判定开始说话
+    int hangover_frames = 50;      // 连续多少帧静音才判定说话结束（500ms）
+};
+
+// 基于短时能量 + 过零率的帧级 VAD，输入 16kHz 单声道 PCM
+class VoiceActivityDetector {
+public:
+    enum class Event { None, SpeechStart, SpeechEnd };
+
+    static constexpr size_t FRAME_SAMPLES = 160;   // 10ms @ 16kHz
+
+    explicit VoiceActivityDetector(const VadConfig& config = VadConfig());
+
+    // 处理一帧 10ms 数据
+    Event processFrame(const int16_t* frame);
+
+    // 处理任意整数个 10ms 帧（例如采集的 20ms 帧），返回其中最后一个事件
+    Event process(const int16_t* samples, size_t count);
+
+    bool inSpeech() const { return in_speech; }
+    const VadConfig& config() const { return cfg; }
+    float noiseFloorDb() const { return noise_floor_db; }
+    void reset();
+
+    // 帧能量（平方和），按平台选用 NEON/SSE2 实现
+    static uint64_t frameEnergy(const int16_t* samples, size_t count);
+
+private:
+    VadConfig cfg;
+    bool in_speech;
+    int voiced_run;
+    int silent_run;
+    float noise_floor_db;
+};
+
+#endif // VAD_H
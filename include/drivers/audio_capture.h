@@ -0,0 +1,64 @@
+#ifndef AUDIO_CAPTURE_H
+#define AUDIO_CAPTURE_H
+
+#include <alsa/asoundlib.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// 麦克风流式采集：ALSA 读取 16kHz 单声道，按 20ms 一帧写入无锁环形缓冲。
+// 下游既可以 readFrame/waitFrame 拉取，也可以注册回调在采集线程里逐帧处理（注册回调后不再写环形缓冲）。
+class AudioCapture {
+public:
+    static constexpr unsigned SAMPLE_RATE = 16000;
+    static constexpr unsigned FRAME_SAMPLES = SAMPLE_RATE / 50;   // 20ms
+    static constexpr size_t RING_FRAMES = 64;                     // 约 1.28s
+
+    using FrameCallback = std::function<void(const int16_t* frame, size_t samples)>;
+
+    explicit AudioCapture(const std::string& device = "plughw:0,0");
+    ~AudioCapture();
+
+    // 上次采集因设备错误停下时，先回收旧线程再重新打开设备
+    bool start();
+    void stop();
+    // 设备读失败（例如拔掉麦克风）后返回 false，需要 stop() 或重新 start()
+    bool isRunning() const { return running.load() && !failed.load(); }
+
+    // 采集线程内回调，需在 start() 前设置；回调应尽快返回
+    void setFrameCallback(FrameCallback cb);
+
+    // 非阻塞取一帧（FRAME_SAMPLES 个采样），无数据返回 false
+    bool readFrame(int16_t* out);
+
+    // 阻塞等待一帧，超时返回 false
+    bool waitFrame(int16_t* out, int timeout_ms);
+
+    // 因消费者过慢而丢弃的帧数
+    uint64_t droppedFrames() const { return dropped.load(); }
+
+private:
+    void captureLoop();
+
+    std::string device;
+    snd_pcm_t* pcm_handle = nullptr;
+
+    int16_t ring[RING_FRAMES][FRAME_SAMPLES];
+    std::atomic<size_t> head{0};   // 生产者写位置
+    std::atomic<size_t> tail{0};   // 消费者读位置
+    std::atomic<uint64_t> dropped{0};
+
+    std::mutex wait_mtx;
+    std::condition_variable wait_cv;
+
+    FrameCallback callback;
+    std::atomic<bool> running{false};   // 只由 start/stop 修改，决定是否要回收线程
+    std::atomic<bool> failed{false};    // 采集线程遇到不可恢复的读错误后退出
+    std::thread capture_thread;
+};
+
+#endif // AUDIO_CAPTURE_H
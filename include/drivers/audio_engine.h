@@ -0,0 +1,80 @@
+#ifndef AUDIO_ENGINE_H
+#define AUDIO_ENGINE_H
+
+#include <alsa/asoundlib.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 进程内音频播放：提示音启动时一次性载入为 PCM，
+// ALSA 设备常驻打开，后台混音线程把重叠的提示音叠加输出。
+//
+// 提示音缓存：若音频旁存在同名 .pcm 文件（44.1kHz 立体声 s16le 裸数据，
+// 例如 ffmpeg -i hold.mp3 -f s16le -ar 44100 -ac 2 hold.pcm），直接 mmap，
+// 否则用 libsndfile 解码一次。播放时不分配内存，单路播放直接把缓存交给设备。
+class AudioEngine {
+public:
+    static constexpr unsigned SAMPLE_RATE = 44100;
+    static constexpr unsigned CHANNELS = 2;
+    static constexpr unsigned PERIOD_FRAMES = 1024;
+    static constexpr size_t MAX_VOICES = 8;
+
+    static AudioEngine& instance();
+
+    // 打开 ALSA 设备并启动混音线程
+    bool init(const std::string& device = "default");
+    void shutdown();
+
+    // 载入音频文件（优先 mmap 同名 .pcm，否则解码 wav/mp3）并以 name 缓存
+    bool load(const std::string& name, const std::string& path);
+
+    // 异步播放一次，立即返回；未加载的 name 会按文件路径即时载入一次
+    void play(const std::string& name);
+
+    // 无缝循环播放，直到 stop(name)；已在循环中则忽略
+    void loop(const std::string& name);
+    void stop(const std::string& name);
+
+private:
+    AudioEngine() = default;
+    ~AudioEngine();
+    AudioEngine(const AudioEngine&) = delete;
+    AudioEngine& operator=(const AudioEngine&) = delete;
+
+    struct Clip {
+        const int16_t* data = nullptr;   // 交错立体声
+        size_t samples = 0;
+        std::vector<int16_t> decoded;    // 解码得到的数据
+        void* mapped = nullptr;          // 或 mmap 的 .pcm 文件
+        size_t mapped_len = 0;
+    };
+
+    struct Voice {
+        const Clip* clip = nullptr;      // 为空表示空闲槽位
+        size_t pos = 0;
+        bool looping = false;
+    };
+
+    bool mapRaw(const std::string& path, Clip& clip);
+    bool decode(const std::string& path, Clip& clip);
+    const Clip* findOrLoad(const std::string& name);
+    void start(const std::string& name, bool looping);
+    void mixLoop();
+    void writePeriod(const int16_t* data);
+
+    snd_pcm_t* pcm_handle = nullptr;
+    std::map<std::string, Clip> clips;
+    Voice voices[MAX_VOICES];
+    size_t active_voices = 0;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::atomic<bool> running{false};
+    std::thread mix_thread;
+};
+
+#endif // AUDIO_ENGINE_H
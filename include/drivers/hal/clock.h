@@ -0,0 +1,34 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <chrono>
+#include <cstdint>
+
+// 时间源接口：默认真实时间；仿真器换成锁步虚拟时钟后，
+// 导航、舵机等待、IMU 采样循环都按虚拟时间推进，可以远快于真实时间运行。
+// 注意：PWM 波形循环仍用真实时间，不走这里。
+class ClockSource {
+public:
+    virtual ~ClockSource() = default;
+
+    virtual uint64_t nowNs() = 0;
+    virtual void sleepNs(uint64_t ns) = 0;
+};
+
+namespace Clock {
+
+// nullptr 恢复真实时间
+void setSource(ClockSource* source);
+
+uint64_t nowNs();
+void sleepNs(uint64_t ns);
+
+template <class Rep, class Period>
+void sleepFor(std::chrono::duration<Rep, Period> d) {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+    if (ns > 0) sleepNs(static_cast<uint64_t>(ns));
+}
+
+}  // namespace Clock
+
+#endif // CLOCK_H
@@ -0,0 +1,35 @@
+#ifndef GPIO_LINE_H
+#define GPIO_LINE_H
+
+#include <chrono>
+#include <cstdint>
+
+// 单根 GPIO 线的抽象：真实后端走 libgpiod，仿真后端记录边沿时间戳
+class GpioLine {
+public:
+    virtual ~GpioLine() = default;
+
+    virtual void set(int value) = 0;
+    virtual int get() = 0;
+
+    // 等到电平变成 level，t_ns 为边沿时刻（steady_clock 或内核事件时间，只用来求差）；
+    // 超时返回 0，读线出错返回 -1。默认轮询 get()，线程被抢占时时刻会偏后；
+    // Hal::edgeLine 打开的真实线用内核记录的边沿时间戳，不受调度影响
+    virtual int waitLevel(int level, int timeout_us, uint64_t& t_ns) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeout_us);
+        while (true) {
+            int v = get();
+            auto now = std::chrono::steady_clock::now();
+            if (v < 0) return -1;
+            if (v == level) {
+                t_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+                return 1;
+            }
+            if (now > deadline) return 0;
+        }
+    }
+    // 丢弃之前积压的边沿事件，默认没有事件队列
+    virtual void clearEdges() {}
+};
+
+#endif // GPIO_LINE_H
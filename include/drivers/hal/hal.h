@@ -0,0 +1,38 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include <cstdint>
+#include <memory>
+#include "gpio_line.h"
+#include "pwm_channel.h"
+#include "i2c_bus.h"
+
+// 硬件访问入口：驱动只通过这里拿 GPIO/PWM/I2C，
+// 真实后端（libgpiod、/dev/i2c-*、/sys/class/pwm）或仿真后端（SimBoard）二选一。
+// 默认真实后端；环境变量 ROBO_HAL=sim 或 setBackend(Backend::Sim) 切换到仿真，
+// 便于在没有树莓派的开发机/CI 上运行和测时序。
+namespace Hal {
+
+enum class Backend { Real, Sim };
+
+Backend backend();
+void setBackend(Backend b);
+
+// gpiochip0 上的输出/输入线，失败时抛 std::runtime_error
+std::unique_ptr<GpioLine> outputLine(int offset, const char* consumer, int initial = 0);
+std::unique_ptr<GpioLine> inputLine(int offset, const char* consumer);
+// 输入线，同时请求双边沿事件，waitLevel 取内核时间戳（脉宽测量用）；仿真后端同 inputLine
+std::unique_ptr<GpioLine> edgeLine(int offset, const char* consumer);
+
+// 在一根 GPIO 上做软件 PWM，PWM 线程按 role 设置调度参数
+std::unique_ptr<PwmChannel> softPwm(int offset, const char* consumer, int period_us,
+                                    ThreadProfile::Role role = ThreadProfile::Role::None);
+// 硬件 PWM 通道；仿真后端下退化为仿真 GPIO 上的软件 PWM（线号 1000 + chip*10 + channel）
+std::unique_ptr<PwmChannel> hardwarePwm(int chip, int channel, int period_us);
+
+// I2C 从机，失败时抛 std::runtime_error
+std::unique_ptr<I2cBus> i2cBus(const char* device, uint8_t address);
+
+}  // namespace Hal
+
+#endif // HAL_H
@@ -0,0 +1,17 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// 挂在某个从机地址上的 I2C 寄存器访问，失败返回 false
+class I2cBus {
+public:
+    virtual ~I2cBus() = default;
+
+    virtual bool writeRegister(uint8_t reg, uint8_t value) = 0;
+    // 从 reg 开始连续读 len 字节（寄存器地址自增）
+    virtual bool readRegisters(uint8_t reg, uint8_t* buf, size_t len) = 0;
+};
+
+#endif // I2C_BUS_H
@@ -0,0 +1,61 @@
+#ifndef PWM_CHANNEL_H
+#define PWM_CHANNEL_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include "gpio_line.h"
+#include "thread_profile.h"
+
+// PWM 通道抽象：周期与高电平时间（微秒）
+class PwmChannel {
+public:
+    virtual ~PwmChannel() = default;
+
+    virtual void setPeriodUs(int period_us) = 0;
+    virtual void setPulseUs(int pulse_us) = 0;
+    virtual void enable(bool on) = 0;
+};
+
+// 软件 PWM：后台线程翻转一根 GpioLine（GPIO 可以是真实的也可以是仿真的）
+class SoftPwmChannel : public PwmChannel {
+public:
+    // PWM 线程按 role 的线程配置设置调度策略和绑定核心
+    SoftPwmChannel(std::unique_ptr<GpioLine> line, int period_us,
+                   ThreadProfile::Role role = ThreadProfile::Role::None);
+    ~SoftPwmChannel() override;
+
+    void setPeriodUs(int period_us) override;
+    void setPulseUs(int pulse_us) override;
+    void enable(bool on) override;
+
+private:
+    void pwmLoop();
+
+    std::unique_ptr<GpioLine> line;
+    std::atomic<int> period_us;
+    std::atomic<int> pulse_us;
+    std::atomic<bool> enabled;
+    std::atomic<bool> running;
+    ThreadProfile::Role role;
+    std::thread pwm_thread;
+};
+
+// 硬件 PWM（/sys/class/pwm，树莓派 5 为 pwmchip2，需 dtoverlay=pwm-2chan）
+class SysfsPwmChannel : public PwmChannel {
+public:
+    SysfsPwmChannel(int chip, int channel, int period_us);
+    ~SysfsPwmChannel() override;
+
+    void setPeriodUs(int period_us) override;
+    void setPulseUs(int pulse_us) override;
+    void enable(bool on) override;
+
+private:
+    bool writeSys(const std::string& name, long long value) const;
+
+    std::string path;
+};
+
+#endif // PWM_CHANNEL_H
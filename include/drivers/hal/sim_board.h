@@ -0,0 +1,107 @@
+#ifndef SIM_BOARD_H
+#define SIM_BOARD_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "gpio_line.h"
+#include "i2c_bus.h"
+
+// 仿真硬件板：保存每根 GPIO 线和每个 I2C 从机的状态。
+// GPIO 输出的每次电平变化带时间戳记录下来，可离线分析 PWM 周期/抖动；
+// 输入线的电平可直接设置，或由回调按时间计算（如超声波回波）。
+// I2C 从机有 256 字节寄存器表，读取时优先返回预先排好的脚本数据，或交给回调合成。
+// 各回调应在驱动打开线/从机之前设置好。
+class SimBoard {
+public:
+    struct Edge {
+        uint64_t t_ns;
+        int value;
+    };
+
+    struct Line {
+        int offset = 0;
+        bool output = false;
+        std::atomic<int> value{0};
+
+        // 输入线电平回调（参数为当前时间 ns），为空时返回 value
+        std::function<int(uint64_t)> input_handler;
+        // 输出线电平变化回调，在 set() 的线程中调用
+        std::function<void(const Edge&)> edge_handler;
+
+        std::vector<Edge> edges() const;
+        void clearEdges();
+        size_t droppedEdges() const { return dropped; }
+
+    private:
+        friend class SimBoard;
+        mutable std::mutex mtx;
+        std::vector<Edge> log;
+        size_t dropped = 0;
+    };
+
+    struct I2cDevice {
+        uint8_t address = 0;
+        uint8_t regs[256] = {};
+
+        struct Write {
+            uint64_t t_ns;
+            uint8_t reg;
+            uint8_t value;
+        };
+
+        // 排一段脚本：下一次从 reg 开始的读取返回 bytes（按顺序逐次消耗）
+        void script(uint8_t reg, std::vector<uint8_t> bytes);
+        // 读取回调，返回 false 表示模拟 I2C 失败；设置后脚本与寄存器表不再使用
+        std::function<bool(uint8_t reg, uint8_t* buf, size_t len)> read_handler;
+
+        std::vector<Write> writes() const;
+        size_t readCount() const { return reads; }
+
+    private:
+        friend class SimBoard;
+        mutable std::mutex mtx;
+        std::map<uint8_t, std::deque<std::vector<uint8_t>>> scripted;
+        std::vector<Write> write_log;
+        size_t reads = 0;
+    };
+
+    static SimBoard& instance();
+
+    // 时间源，默认 Clock::nowNs()（跟随全局时钟，仿真时即虚拟时间）
+    void setClock(std::function<uint64_t()> clock);
+    uint64_t now() const;
+
+    // 每根线最多记录的边沿数，超出后计数丢弃
+    void setEdgeLimit(size_t limit) { edge_limit = limit; }
+
+    Line& line(int offset);
+    I2cDevice& i2c(uint8_t address);
+
+    // 清空全部线和从机（测试之间调用，需确保没有驱动仍持有句柄）
+    void reset();
+
+    std::unique_ptr<GpioLine> openLine(int offset, bool output, int initial);
+    std::unique_ptr<I2cBus> openI2c(uint8_t address);
+
+private:
+    SimBoard() = default;
+
+    class SimGpioLine;
+    class SimI2cBus;
+
+    void recordEdge(Line& l, int value);
+
+    mutable std::mutex mtx;
+    std::function<uint64_t()> clock;
+    std::map<int, std::unique_ptr<Line>> lines;
+    std::map<uint8_t, std::unique_ptr<I2cDevice>> devices;
+    std::atomic<size_t> edge_limit{1u << 20};
+};
+
+#endif // SIM_BOARD_H
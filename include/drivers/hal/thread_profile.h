@@ -0,0 +1,56 @@
+#ifndef THREAD_PROFILE_H
+#define THREAD_PROFILE_H
+
+#include <sched.h>
+#include <string>
+#include <vector>
+
+// 按线程角色统一设置调度策略、优先级和 CPU 亲和性，配置来自 config/threads.json
+// （ROBO_THREAD_CONFIG 可改路径）。控制线程独占 control 核心，视觉/GUI/音频/后台线程
+// 只在其余核心上跑，免得 OpenCV 的线程池和 PWM、IMU 抢同一个核心。
+// 新线程继承创建者的策略和亲和性，所以 configure() 要在 QApplication、OpenCV 之前调用，
+// 每个长期线程在入口处调用 apply(角色)。configure() 之前 apply() 不做任何事。
+namespace ThreadProfile {
+
+enum class Role { None, MotorPwm, ServoPwm, Imu, Ultrasonic, Nav, Audio, Vision, Gui, Background };
+
+struct Profile {
+    int policy = 0;             // SCHED_OTHER / SCHED_FIFO / SCHED_RR
+    int priority = 0;           // 实时策略下 1..99
+    std::vector<int> cpus;      // 空表示不限制
+    bool control = false;       // 延迟敏感的控制线程，独占 control 核心
+};
+
+// 加载配置、按需 mlockall、把调用线程设为 gui 角色并检查核心隔离；只生效一次
+bool configure(const std::string& path = "");
+bool configured();
+
+const char* roleName(Role role);
+Profile profile(Role role);
+
+// 把当前线程设为该角色的调度参数，失败只打印警告
+void apply(Role role);
+
+// 在作用域内把当前线程设为该角色，离开时恢复原来的策略、优先级和核心集合；
+// 用于只在一段时间内做控制工作的线程（导航线程结束后还要播提示音、写行程记录）
+class Scope {
+public:
+    explicit Scope(Role role);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    bool saved = false;
+    int policy = 0;
+    int priority = 0;
+    cpu_set_t cpus;
+};
+
+// 控制核心是否与视觉/GUI 隔离：配置重叠或主线程仍在控制核心上时返回 false，
+// 控制核心不在内核 isolcpus 里只打印提示
+bool checkIsolation();
+
+}  // namespace ThreadProfile
+
+#endif // THREAD_PROFILE_H
@@ -0,0 +1,54 @@
+#ifndef HARDWARE_CONTEXT_H
+#define HARDWARE_CONTEXT_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include "motor.h"
+#include "servo.h"
+#include "yaw_tracker.h"
+#include "ultrasonic_sensor.h"
+
+#define MOTOR_PINS {17, 16, 22, 23}
+#define SERVO_PIN 18
+#define YAW_RATE_HZ 50
+
+// 常驻的硬件句柄：开机时打开一次 gpiochip、申请引脚、启动 PWM/IMU 线程，
+// 之后控制器与导航线程共用，开始导航不再重新构造驱动（MPU 复位要 100ms+）
+class HardwareContext {
+public:
+    static HardwareContext& instance();
+
+    // 打开全部设备，可重复调用；电机/舵机/IMU 都就绪时返回 true，
+    // 超声波缺失只影响限速器
+    bool init();
+    void shutdown();
+    bool ready() const;
+
+    Motor* motor() const { return motor_.get(); }
+    Servo* servo() const { return servo_.get(); }
+    YawTracker* yaw() const { return yaw_.get(); }
+    UltrasonicSensor* ultrasonic() const { return ultrasonic_.get(); }
+
+    // 同一时间只允许一次导航占用电机
+    bool tryAcquire();
+    void release();
+
+    // 立即停车、舵机回中（退出或急停时调用）
+    void stopAll();
+
+private:
+    HardwareContext() = default;
+    ~HardwareContext();
+    HardwareContext(const HardwareContext&) = delete;
+    HardwareContext& operator=(const HardwareContext&) = delete;
+
+    mutable std::mutex mtx;
+    std::unique_ptr<Motor> motor_;
+    std::unique_ptr<Servo> servo_;
+    std::unique_ptr<YawTracker> yaw_;
+    std::unique_ptr<UltrasonicSensor> ultrasonic_;
+    std::atomic<bool> busy{false};
+};
+
+#endif // HARDWARE_CONTEXT_H
@@ -0,0 +1,142 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+// 控制/采集线程用的日志：调用方只把定长二进制记录（格式串指针 + 参数）写进
+// 本线程的单生产者单消费者环形缓冲，后台线程合并、按时间排序后格式化输出。
+// 缓冲满时丢弃并计数，调用方永不阻塞，也不会去抢 iostream 的锁。
+//
+// 格式串必须是字面量，用 {} 占位；字符串参数（const char* / std::string）会被拷贝，
+// 所有字符串参数合计最多 LOG_TEXT_BYTES 字节，超出截断。
+// 编译期过滤：-DLOG_LEVEL=LOG_LEVEL_WARN 时 LOG_DEBUG/LOG_INFO 整条展开为空。
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO  1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_OFF   4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define LOG_MAX_ARGS 6
+#define LOG_TEXT_BYTES 64
+
+namespace Log {
+
+enum Level : uint8_t { Debug = LOG_LEVEL_DEBUG, Info = LOG_LEVEL_INFO, Warn = LOG_LEVEL_WARN, Error = LOG_LEVEL_ERROR };
+
+struct Record {
+    enum Kind : uint8_t { Int, Uint, Float, Char, Text };
+
+    uint64_t t_ns;
+    const char* fmt;
+    Level level;
+    uint8_t nargs;
+    uint8_t text_len;
+    Kind kinds[LOG_MAX_ARGS];
+    union {
+        int64_t i;
+        uint64_t u;
+        double f;
+    } values[LOG_MAX_ARGS];          // Text 参数存放在 text 中的偏移
+    char text[LOG_TEXT_BYTES];
+};
+
+// 运行期再过滤一层（例如仿真器批量运行时只看告警）
+void setLevel(Level level);
+Level level();
+
+// 因缓冲满被丢弃的记录数
+uint64_t dropped();
+
+// 阻塞到目前已写入的记录全部输出（退出前或测试中使用）
+void flush();
+
+// 以下供宏使用
+Record* claim();
+void publish();
+void drop();
+uint64_t timestamp();
+
+inline void put(Record& r, int64_t v) { r.kinds[r.nargs] = Record::Int; r.values[r.nargs++].i = v; }
+inline void put(Record& r, uint64_t v) { r.kinds[r.nargs] = Record::Uint; r.values[r.nargs++].u = v; }
+inline void put(Record& r, double v) { r.kinds[r.nargs] = Record::Float; r.values[r.nargs++].f = v; }
+inline void put(Record& r, char v) { r.kinds[r.nargs] = Record::Char; r.values[r.nargs++].i = v; }
+inline void put(Record& r, const char* s, size_t len) {
+    r.kinds[r.nargs] = Record::Text;
+    if (r.text_len >= LOG_TEXT_BYTES) {
+        r.values[r.nargs++].u = LOG_TEXT_BYTES - 1;   // 已满，指向最后的 '\0'
+        return;
+    }
+    size_t room = LOG_TEXT_BYTES - 1 - r.text_len;
+    if (len > room) len = room;
+    r.values[r.nargs++].u = r.text_len;
+    std::memcpy(r.text + r.text_len, s, len);
+    r.text_len += static_cast<uint8_t>(len);
+    r.text[r.text_len++] = '\0';
+}
+inline void put(Record& r, const char* s) { put(r, s ? s : "(null)", std::strlen(s ? s : "(null)")); }
+inline void put(Record& r, const std::string& s) { put(r, s.data(), s.size()); }
+inline void put(Record& r, bool v) { put(r, v ? "true" : "false", v ? 4 : 5); }
+
+template <class T>
+inline typename std::enable_if<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value &&
+                               !std::is_same<T, char>::value>::type
+put(Record& r, T v) {
+    if (std::is_floating_point<T>::value) put(r, static_cast<double>(v));
+    else if (std::is_signed<T>::value) put(r, static_cast<int64_t>(v));
+    else put(r, static_cast<uint64_t>(v));
+}
+
+template <class... Args>
+void write(Level level, const char* fmt, const Args&... args) {
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "too many log arguments");
+    if (level < Log::level()) return;
+    Record* r = claim();
+    if (!r) {
+        drop();
+        return;
+    }
+    r->t_ns = timestamp();
+    r->fmt = fmt;
+    r->level = level;
+    r->nargs = 0;
+    r->text_len = 0;
+    (put(*r, args), ...);
+    publish();
+}
+
+}  // namespace Log
+
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) ::Log::write(::Log::Debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(...) ::Log::write(::Log::Info, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(...) ::Log::write(::Log::Warn, __VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) ::Log::write(::Log::Error, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
+
+#endif // LOG_H
@@ -0,0 +1,109 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// 控制回路计时指标：计数器、直方图、周期循环计时，
+// 通过本机 HTTP 端点以 Prometheus 文本格式导出（curl 127.0.0.1:9105/metrics）。
+// 热路径上只有 steady_clock 读取和几次 relaxed 原子加，注册只在第一次取用时加锁，
+// 调用处用 static 引用缓存：
+//   static Metrics::Histogram& h = Metrics::histogram("i2c_read_seconds", "...");
+namespace Metrics {
+
+// 单调时钟（ns），不受仿真虚拟时钟影响
+uint64_t now();
+
+class Counter {
+public:
+    void inc(uint64_t n = 1) { v.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return v.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> v{0};
+};
+
+// 桶上界为 1us * 2^i（i = 0..BUCKETS-2，最大约 4.2s），最后一个桶为 +Inf
+class Histogram {
+public:
+    static constexpr int BUCKETS = 24;
+
+    void observe(uint64_t ns) {
+        uint64_t us = (ns + 999) / 1000;
+        int i = us <= 1 ? 0 : 64 - __builtin_clzll(us - 1);
+        if (i > BUCKETS - 1) i = BUCKETS - 1;
+        buckets[i].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum_ns.fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    uint64_t bucket(int i) const { return buckets[i].load(std::memory_order_relaxed); }
+    uint64_t samples() const { return count.load(std::memory_order_relaxed); }
+    uint64_t sumNs() const { return sum_ns.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> buckets[BUCKETS] = {};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum_ns{0};
+};
+
+// 周期循环：实际周期、与期望周期的偏差、超过 1.5 倍期望周期的次数
+struct Loop {
+    uint64_t expected_ns = 0;
+    Histogram* period = nullptr;
+    Histogram* jitter = nullptr;
+    Counter* overruns = nullptr;
+};
+
+// 每个循环线程各持有一个，tick() 在每个周期开始时调用
+class LoopTimer {
+public:
+    explicit LoopTimer(const Loop& loop) : loop(loop) {}
+
+    void tick() {
+        uint64_t t = now();
+        if (last) {
+            uint64_t period = t - last;
+            loop.period->observe(period);
+            loop.jitter->observe(period > loop.expected_ns ? period - loop.expected_ns : loop.expected_ns - period);
+            if (period * 2 > loop.expected_ns * 3) loop.overruns->inc();
+        }
+        last = t;
+    }
+
+    // 循环暂停后重新开始，不把暂停的时间算作一个周期
+    void restart() { last = 0; }
+
+private:
+    const Loop& loop;
+    uint64_t last = 0;
+};
+
+// 作用域计时
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& h) : h(h), start(now()) {}
+    ~ScopedTimer() { h.observe(now() - start); }
+
+private:
+    Histogram& h;
+    uint64_t start;
+};
+
+// 名字可带标签：nav_step_seconds{action="moveForward"}；同名重复注册返回同一个对象
+Counter& counter(const std::string& name, const std::string& help);
+Histogram& histogram(const std::string& name, const std::string& help);
+// 生成 <name>_period_seconds、<name>_jitter_seconds、<name>_overruns_total（标签沿用 name 中的）
+const Loop& loop(const std::string& name, uint64_t expected_ns, const std::string& help);
+
+// Prometheus 文本格式快照
+std::string render();
+
+// 在 127.0.0.1:port 上提供 GET /metrics；重复调用忽略
+bool serve(int port = 9105);
+void stopServing();
+
+}  // namespace Metrics
+
+#endif // METRICS_H
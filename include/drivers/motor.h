@@ -2,8 +2,9 @@
 #define MOTOR_H
 
 #include <atomic>
-#include <gpiod.h>
+#include <memory>
 #include "pwm.h"
+#include "gpio_line.h"
 #include <thread>
 
 struct MotorPins {
@@ -22,14 +23,17 @@ public:
     void backward(int dutyCycle);
     void stop();
 
-    void pwmLoop(gpiod_line* pin1, gpiod_line* pin2, std::atomic<int>& duty, std::atomic<bool>& direction);
+    // 当前指令占空比，正为前进、负为后退（仿真/遥测读取）
+    int leftCommand() const;
+    int rightCommand() const;
+
+    void pwmLoop(GpioLine* pin1, GpioLine* pin2, std::atomic<int>& duty, std::atomic<bool>& direction);
 
 private:
-    gpiod_chip* chip;
-    gpiod_line* line_AIN1;
-    gpiod_line* line_AIN2;
-    gpiod_line* line_BIN1;
-    gpiod_line* line_BIN2;
+    std::unique_ptr<GpioLine> line_AIN1;
+    std::unique_ptr<GpioLine> line_AIN2;
+    std::unique_ptr<GpioLine> line_BIN1;
+    std::unique_ptr<GpioLine> line_BIN2;
 
     std::atomic<bool> running;
     std::atomic<int> left_duty;
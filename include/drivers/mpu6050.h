@@ -4,8 +4,10 @@
 #include <cstdint>
 #include <functional>
 #include <atomic>
+#include <memory>
 #include <thread>
 #include <stdexcept>
+#include "i2c_bus.h"
 
 class MPU6050 {
 public:
@@ -14,6 +16,8 @@ public:
 
     // 构造函数/析构函数
     MPU6050(const char* i2c_device = "/dev/i2c-1", uint8_t address = 0x68);
+    // 使用外部提供的总线（例如 SimBoard 的仿真从机）
+    explicit MPU6050(std::unique_ptr<I2cBus> bus);
     ~MPU6050();
 
     // 公开接口
@@ -31,7 +35,7 @@ private:
     void readThreadFunc();
 
     // 私有成员变量
-    int file;                           // I2C文件描述符
+    std::unique_ptr<I2cBus> bus;        // I2C 从机（真实或仿真）
     std::atomic<bool> running{false};   // 线程控制标志
     std::thread read_thread;            // 数据读取线程
     DataCallback callback;              // 用户回调函数
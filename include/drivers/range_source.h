@@ -0,0 +1,17 @@
+#ifndef RANGE_SOURCE_H
+#define RANGE_SOURCE_H
+
+// getDistance 的特殊返回值
+#define RANGE_NO_ECHO -1.0f      // 量程内没有障碍物
+#define RANGE_ERROR   -2.0f      // 传感器没有响应（未接线、损坏、GPIO 读失败）
+
+// 前方测距来源：超声波传感器，或仿真器里对楼层地图的射线求交
+class RangeSource {
+public:
+    virtual ~RangeSource() = default;
+
+    // 最近一次距离（cm），无回波/超量程时返回 RANGE_NO_ECHO，传感器故障时返回 RANGE_ERROR
+    virtual float getDistance() const = 0;
+};
+
+#endif // RANGE_SOURCE_H
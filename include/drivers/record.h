@@ -1,11 +1,13 @@
 #ifndef RECORD_H
 #define RECORD_H
 #include <string>
-
+#include "vad.h"
 
 namespace Record {
     bool recordToWav(const std::string& outputPath, int durationSec);
     bool recordWithSilenceDetection(const std::string& outputPath, int silenceThresholdDb, int silenceDurationSec);
+    // 等待开口说话，VAD 判定说话结束（hangover 以 10ms 为步长）后立即停止录音
+    bool recordUtterance(const std::string& outputPath, const VadConfig& config, int maxWaitSec = 10, int maxDurationSec = 15);
 }
 
 #endif
\ No newline at end of file
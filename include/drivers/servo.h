@@ -29,26 +29,27 @@
 #ifndef SERVO_H
 #define SERVO_H
 
-#include <gpiod.h>
 #include <atomic>
-#include <thread>
+#include <memory>
+#include "pwm_channel.h"
 
 class Servo {
 public:
+    // 在 gpio_pin 上做 20ms 周期的软件 PWM（经 HAL，可为仿真 GPIO）
     explicit Servo(int gpio_pin);
+    // 使用外部提供的 PWM 通道（硬件 PWM 或测试替身）
+    explicit Servo(std::unique_ptr<PwmChannel> channel);
     ~Servo();
 
     void center();
     void turn(char direction, int angle);
 
-private:
-    void pwmLoop(struct gpiod_line* line, std::atomic<int>& duty_cycle);
+    // 当前脉宽（us），1500 为中位，小于中位向左
+    int pulseUs() const { return duty_us.load(); }
 
-    struct gpiod_chip* chip;
-    struct gpiod_line* line;
-    std::atomic<bool> running;
+private:
+    std::unique_ptr<PwmChannel> pwm;
     std::atomic<int> duty_us;
-    std::thread pwm_thread;
     int pin;
 };
 
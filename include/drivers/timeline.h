@@ -0,0 +1,66 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// 单次导引的时间线：识别、查库、提示音、每个导航步骤、转向收敛、挂起等阶段
+// 记为区间（span），行程结束时导出为 Chrome trace JSON，用 chrome://tracing 或 ui.perfetto.dev 打开。
+// 只在 begin() 与 end() 之间记录，未开始时 Span 只有一次原子读取：
+//   Timeline::Span span("face_detect", "vision");
+namespace Timeline {
+
+// 开始新行程，丢弃上一次未导出的内容；dir 为空时取 ROBO_TIMELINE_DIR，两者都为空则不记录
+void begin(const std::string& trip, const std::string& dir = "");
+
+// 结束行程并写出 trip-YYYYmmdd-HHMMSS-mmm.json（同名时再加序号），返回文件路径（未在记录时返回空）
+std::string end();
+
+bool active();
+
+// 当前线程在时间线上显示的名字
+void nameThread(const std::string& name);
+
+// 瞬时事件，例如 "patient recognized"
+void instant(const std::string& name, const char* category = "trip", const std::string& detail = "");
+
+// 行程守卫：构造时 begin，析构时若没有 keep() 就结束并导出，
+// 提前返回的失败路径不会把半截行程留给下一次导航；行程已被别处重新开始或结束时析构什么也不做
+class Trip {
+public:
+    explicit Trip(const std::string& trip, const std::string& dir = "");
+    ~Trip();
+
+    // 成功时交给后续阶段（导航线程）去结束
+    void keep() { kept = true; }
+
+    Trip(const Trip&) = delete;
+    Trip& operator=(const Trip&) = delete;
+
+private:
+    uint32_t generation = 0;
+    bool kept = false;
+};
+
+// 区间在析构时记录；行程在区间内部结束或重新开始时丢弃该区间
+class Span {
+public:
+    Span(const char* name, const char* category, std::string detail = "");
+    Span(std::string name, const char* category, std::string detail = "");
+    ~Span();
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    std::string name;
+    const char* category;
+    std::string detail;
+    uint64_t start_ns = 0;
+    uint32_t generation = 0;
+};
+
+}  // namespace Timeline
+
+#endif // TIMELINE_H
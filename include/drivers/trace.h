@@ -0,0 +1,59 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 现场传感器/控制记录：二进制、只追加，方便把现场问题带回桌面复现。
+// 文件头 "RHGTRACE" + uint32 版本 + uint32 保留，之后每条记录为
+//   uint64 时间戳(ns，Clock::nowNs) | uint16 类型 | uint16 负载长度 | 负载
+// 采集线程只把记录拷进内存缓冲，由后台线程批量落盘；断电时最多丢掉最后一段未写完的记录。
+namespace Trace {
+
+enum class Type : uint16_t {
+    Imu = 1,     // float acc[3](g), gyro[3](°/s)
+    Range = 2,   // float cm，-1 为无回波
+    Motor = 3,   // int16 左、右有符号占空比（正为前进）
+    Servo = 4,   // int32 脉宽 us
+    Nav = 5      // uint8 事件, int32 值, 文本
+};
+
+enum class NavEvent : uint8_t {
+    Start = 1,   // 文本：目标科室 \n 路径 JSON
+    Step = 2,    // 值：动作参数，文本：动作名
+    Pause = 3,
+    Resume = 4,
+    End = 5      // 值：1 完成 / 0 取消
+};
+
+struct Sample {
+    uint64_t t_ns = 0;
+    Type type = Type::Imu;
+    float v[6] = {0, 0, 0, 0, 0, 0};   // Imu: acc xyz, gyro xyz；Range: v[0]
+    int a = 0;                         // Motor: 左；Servo: 脉宽；Nav: 事件
+    int b = 0;                         // Motor: 右；Nav: 值
+    std::string text;                  // Nav
+};
+
+// 开始记录到 path（覆盖已有文件）；已在记录时先关闭旧文件
+bool start(const std::string& path);
+// 落盘剩余数据并关闭
+void stop();
+bool active();
+// 缓冲积压过多而丢弃的记录数
+uint64_t dropped();
+
+// 未开启记录时以下调用只有一次原子读
+void imu(const float* acc, const float* gyro);
+void range(float cm);
+void motor(int left, int right);
+void servo(int pulse_us);
+void nav(NavEvent event, int value = 0, const std::string& text = "");
+
+// 读取整个记录文件，末尾不完整的记录忽略
+bool load(const std::string& path, std::vector<Sample>& out);
+
+}  // namespace Trace
+
+#endif // TRACE_H
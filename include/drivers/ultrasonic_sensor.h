@@ -0,0 +1,36 @@
+#ifndef ULTRASONIC_SENSOR_H
+#define ULTRASONIC_SENSOR_H
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include "gpio_line.h"
+#include "range_source.h"
+
+// 默认GPIO引脚定义
+#define TRIG_PIN  24  // GPIO 24
+#define ECHO_PIN  25  // GPIO 25
+
+// HC-SR04 超声波测距，后台线程持续测量，最新距离通过原子变量无锁读取
+class UltrasonicSensor : public RangeSource {
+public:
+    UltrasonicSensor(int trig_pin = TRIG_PIN, int echo_pin = ECHO_PIN, int interval_ms = 60);
+    ~UltrasonicSensor() override;
+
+    // 最近一次测量距离（cm），超量程时返回 RANGE_NO_ECHO，
+    // 触发后回声脚一直不拉高（传感器掉线）时返回 RANGE_ERROR
+    float getDistance() const override;
+
+private:
+    void measureLoop();
+    float measureOnce();
+
+    std::unique_ptr<GpioLine> trig_line;
+    std::unique_ptr<GpioLine> echo_line;
+    std::atomic<bool> running;
+    std::atomic<float> distance_cm;
+    int interval_ms;
+    std::thread sensor_thread;
+};
+
+#endif // ULTRASONIC_SENSOR_H
@@ -1,18 +1,29 @@
 #ifndef YAW_TRACKER_H
 #define YAW_TRACKER_H
 
+#include <memory>
 #include "mpu6050.h"
 #include "MadgwickAHRS.h"
 
 class YawTracker {
 public:
+    YawTracker();
+    // mpu 为空时不采集，只能通过 feed() 送数据（记录回放用）
+    explicit YawTracker(std::unique_ptr<MPU6050> mpu);
+
+    // 按 hz 采样并以同一频率滤波；只在第一次调用时启动采集，之后重复调用直接返回
     void start(int hz = 50);
     float getAngle() const;
     void reset();
 
+    // 直接送入一帧 IMU 数据（g，°/s），不经过采集线程，也不写入记录
+    void feed(const float* acc, const float* gyro);
+
 private:
-    MPU6050 mpu;
+    std::unique_ptr<MPU6050> mpu;
+    mutable Madgwick madgwick;   // 每个实例独立滤波，回放不影响在线的姿态
+    bool started = false;
     void handleMPUData(uint64_t, const float*, const float*);
 };
 
-#endif // YAW_TRACKER_H
\ No newline at end of file
+#endif // YAW_TRACKER_H
@@ -3,9 +3,24 @@
 
 #include <QString>
 #include <QObject>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include "face_recognizer.h"
+#include "camera.h"
+#include "audio_capture.h"
+#include "keyword_spotter.h"
+#include "patient_store.h"
+#include "patient_sync.h"
+#include "route_index.h"
+#include "patient_search.h"
+#include "face_prefetch.h"
+#include "state_bus.h"
 #include "json.hpp"
 
 void playAudio(const std::string& path);
@@ -13,15 +28,91 @@ void playAudio(const std::string& path);
 class MainController{
 public:
     MainController();
+    ~MainController();
+    // With ROBO_CORE=remote attach to the robo_core daemon (initRemote), otherwise open the hardware here
     bool init();
+    bool initLocal();
+    // Forward commands to robo_core over the shared-memory state bus instead of driving hardware here
+    bool initRemote();
+    bool isRemote() const { return bus != nullptr; }
 
+    // Recognize the patient in the latest capture and return their appointment department
     QString recognizeFace();
-    void startNavigationTo(const QString& department);
+    // Same as recognizeFace, and start guiding to the department right away
+    QString recognizeAndGuide();
+    // Runs recognizeFace (or recognizeAndGuide) on the controller's worker thread and calls done there,
+    // so the caller keeps serving stop and pause requests during the 1-2 s recognition window
+    void recognizeAsync(bool guide, std::function<void(const QString& department)> done);
+    // False if the department is unknown, the hardware is not ready or a trip is already running
+    bool startNavigationTo(const QString& department);
+    // Pause holds the motors and keeps the trip's setpoint; resume continues from where it stopped
+    void pauseNavigation();
+    void resumeNavigation();
+    void cancelNavigation();
+    // Manual drive that overrides navigation until released (duty -100..100, negative reverses)
+    void teleop(int duty);
+    void releaseTeleop();
+    // Overrides every other motion source until cleared
+    void emergencyStop(bool engage);
     void exitSystem();
 
+    // Latest robot state: read from the bus in remote mode, sampled locally otherwise
+    bool robotState(RobotState& out);
+    // Used by robo_core: sample the state to publish and run a command from the bus
+    RobotState collectState();
+    void handleCommand(const BusCommand& cmd);
+
+    // Offline lookup in the local patient mirror; empty if no upcoming appointment
+    QString departmentForPatient(const QString& name, const QString& birthDate);
+    // Typo-tolerant candidates for the manual identification form, call on every keystroke
+    std::vector<PatientMatch> searchPatients(const QString& name, const QString& birthDate,
+                                             const QString& gender, int limit = 10);
+
+    // Listen for a spoken department name and start navigating once it is recognized
+    bool startVoiceNavigation();
+    void stopVoiceNavigation();
+
 private:
     std::shared_ptr<FaceRecognizerLib> recognizer;
+    // False when the detector or gallery failed to load; recognition then returns no department
+    bool faceReady = false;
+    std::unique_ptr<Camera> camera;
+    std::unique_ptr<AudioCapture> microphone;
+    std::unique_ptr<KeywordSpotter> spotter;
+    std::atomic<bool> voiceArmed{false};
+    // Set by startVoiceNavigation; the capture thread resets the spotter before its next feed
+    std::atomic<bool> voiceResetPending{false};
+    std::shared_ptr<PatientStore> patientStore;
+    std::unique_ptr<PatientSync> patientSync;
+    std::unique_ptr<RouteIndex> routeIndex;
+    std::unique_ptr<FacePrefetcher> facePrefetcher;
+    PatientSearchIndex patientSearch;
+    std::unique_ptr<PatientSearchIndex::Session> searchSession;
     nlohmann::json navJson;
+
+    bool sendCommand(BusCommandType type, const std::string& text = "", uint32_t* id = nullptr, int32_t value = 0);
+    QString waitForRecognition(uint32_t id);
+    // Ticks the motion arbiter while no trip is running, so teleop and stop requests still reach the motors
+    void motionKeeperLoop();
+    void stopMotionKeeper();
+    // Runs posted jobs in order on the controller's worker thread, off the audio and command threads;
+    // false if the worker is not running
+    bool post(std::function<void()> job);
+    void workerLoop();
+    void stopWorker();
+
+    std::unique_ptr<StateBus> bus;
+    // Written by the worker when a bus recognition finishes, read by collectState
+    std::mutex recognitionMtx;
+    uint32_t lastRecognitionId = 0;
+    std::string lastRecognized;
+    std::thread motionKeeper;
+    std::atomic<bool> keeperRunning{false};
+    std::thread worker;
+    std::mutex workerMtx;
+    std::condition_variable workerCv;
+    std::deque<std::function<void()>> jobs;
+    bool workerRunning = false;
     
     
 };  
\ No newline at end of file
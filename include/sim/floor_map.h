@@ -0,0 +1,56 @@
+#ifndef FLOOR_MAP_H
+#define FLOOR_MAP_H
+
+#include <string>
+#include <vector>
+#include "patient_store.h"
+#include "range_source.h"
+#include "robot_model.h"
+
+// 仿真用楼层平面图：Departments 表里的科室矩形（地图单位）视为实心障碍，
+// 外包矩形视为外墙。scale 为每个地图单位对应的米数。
+class FloorMap {
+public:
+    struct Room {
+        std::string name;
+        double x1, y1, x2, y2;   // 已规范化为 x1<=x2, y1<=y2
+    };
+
+    explicit FloorMap(double scale_m = 0.5);
+
+    // 从本地患者库读取科室
+    bool load(PatientStore& store);
+    // 没有本地库时直接解析建库脚本里的 INSERT INTO Departments
+    bool loadSql(const std::string& path);
+
+    void add(const std::string& name, double x1, double y1, double x2, double y2);
+
+    const std::vector<Room>& rooms() const { return room_list; }
+    const Room* find(const std::string& name) const;
+    double scale() const { return scale_m; }
+
+    // 从 (x, y)（米）沿 heading 方向射线到最近墙面的距离（米），起点所在科室不算障碍
+    double castRay(double x, double y, double heading) const;
+    // 点到科室矩形的距离（米），在矩形内为 0
+    double distanceTo(const Room& room, double x, double y) const;
+
+private:
+    double scale_m;
+    std::vector<Room> room_list;
+    double min_x = 0, min_y = 0, max_x = 0, max_y = 0;
+};
+
+// 对地图做射线求交的仿真超声波：±15° 波束取三条射线的最近值
+class MapRangeSource : public RangeSource {
+public:
+    MapRangeSource(const FloorMap& map, const RobotModel& robot, double max_range_cm = 400.0);
+
+    float getDistance() const override;
+
+private:
+    const FloorMap& map;
+    const RobotModel& robot;
+    double max_range_cm;
+};
+
+#endif // FLOOR_MAP_H
@@ -0,0 +1,80 @@
+#ifndef ROBOT_MODEL_H
+#define ROBOT_MODEL_H
+
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include "motor.h"
+#include "servo.h"
+
+// 小车参数（长度单位米）
+struct RobotParams {
+    double wheelbase_m = 0.16;      // 前后轴距，舵机转向前轮
+    double track_m = 0.14;          // 左右轮距，两侧电机差速
+    double max_speed_mps = 0.6;     // 100% 占空比稳态轮速
+    int deadband_duty = 12;         // 低于该占空比电机转不动
+    double motor_tau_s = 0.15;      // 轮速一阶响应时间常数
+    double steer_ratio = 0.6;       // 前轮转角 / 舵机转角
+    double max_steer_deg = 30.0;    // 前轮最大转角
+    double servo_rate_dps = 600.0;  // 舵机转速（约 0.1s/60°）
+    double ticks_per_m = 390.0;     // 编码器每米脉冲数
+
+    double gyro_noise_dps = 0.05;
+    double gyro_bias_dps = 0.0;
+    double accel_noise_g = 0.003;
+};
+
+struct Pose {
+    double x = 0.0;        // 米
+    double y = 0.0;
+    double heading = 0.0;  // 弧度，逆时针为正
+};
+
+// 运动学模型：两侧电机占空比 + 舵机脉宽 -> 位姿、编码器脉冲、IMU 原始寄存器
+class RobotModel {
+public:
+    explicit RobotModel(const RobotParams& params = RobotParams(), unsigned seed = 1);
+
+    void attach(const Motor* motor, const Servo* servo);
+    void reset(const Pose& pose);
+
+    // 积分 dt 秒
+    void step(double dt);
+
+    Pose pose() const;
+    double speed() const;
+    long leftTicks() const;
+    long rightTicks() const;
+
+    // 以 MPU6050 寄存器格式（0x3B 起 14 字节，大端）输出当前加速度/陀螺仪读数
+    void imuRegisters(uint8_t* buf, size_t len);
+
+    // 给定占空比下的稳态车速（理想路径推算用）
+    double steadySpeed(int duty) const;
+    // 舵机脉宽对应的前轮转角（弧度，向左为正）
+    double steerAngle(int pulse_us) const;
+
+    const RobotParams& params() const { return p; }
+
+private:
+    double wheelTarget(int command) const;
+    void updateEncoders();
+
+    RobotParams p;
+    const Motor* motor = nullptr;
+    const Servo* servo = nullptr;
+
+    mutable std::mutex mtx;
+    Pose state;
+    double v_left = 0.0, v_right = 0.0;
+    double steer = 0.0;
+    double yaw_rate = 0.0;
+    double accel = 0.0;
+    double dist_left = 0.0, dist_right = 0.0;
+    long ticks_left = 0, ticks_right = 0;
+
+    std::mt19937 rng;
+    std::normal_distribution<double> unit{0.0, 1.0};
+};
+
+#endif // ROBOT_MODEL_H
@@ -0,0 +1,68 @@
+#ifndef ROUTE_SIM_H
+#define ROUTE_SIM_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include "floor_map.h"
+#include "json.hpp"
+#include "motor.h"
+#include "robot_model.h"
+#include "servo.h"
+#include "virtual_clock.h"
+#include "yaw_tracker.h"
+
+struct SimOptions {
+    RobotParams robot;
+    Pose start;                 // 起点（米、弧度）
+    double timeout_s = 120.0;   // 单条路线的仿真时间上限，超时后取消导航
+    uint64_t step_ns = 1000000; // 物理积分步长
+    unsigned seed = 1;
+};
+
+struct RouteResult {
+    std::string department;
+    bool timed_out = false;
+    double time_s = 0.0;        // 仿真时间下的到达用时
+    Pose final_pose;
+    Pose ideal_pose;            // 按 nav.json 理想执行（稳态车速、精确转角）推算的终点
+    double error_m = 0.0;       // 终点与理想终点的距离
+    double heading_error_deg = 0.0;
+    double target_distance_m = -1.0;  // 终点到目标科室矩形的距离，地图里没有该科室时为 -1
+    long left_ticks = 0;
+    long right_ticks = 0;
+};
+
+// 在锁步虚拟时钟上运行真实的 Nav::navigationThread：
+// 电机/舵机/IMU 走 SimBoard 仿真后端，RobotModel 在时钟推进时积分，
+// 超声波由 MapRangeSource 对楼层图射线求交给出。一个进程内同时只能有一个实例。
+class RouteSimulator {
+public:
+    RouteSimulator(const FloorMap& map, const SimOptions& options = SimOptions());
+    ~RouteSimulator();
+
+    RouteSimulator(const RouteSimulator&) = delete;
+    RouteSimulator& operator=(const RouteSimulator&) = delete;
+
+    // 从起点执行一条路线，阻塞直到导航结束或超时
+    RouteResult run(const std::string& department, const nlohmann::json& navJson);
+
+    // 理想执行时的终点位姿
+    Pose idealEnd(const nlohmann::json& path) const;
+
+private:
+    void step(uint64_t from_ns, uint64_t to_ns);
+
+    const FloorMap& map;
+    SimOptions opt;
+    VirtualClock clock;
+    RobotModel model;
+    MapRangeSource range;
+    std::unique_ptr<Motor> motor;
+    std::unique_ptr<Servo> servo;
+    std::unique_ptr<YawTracker> yaw;
+    std::atomic<uint64_t> deadline_ns{0};
+    std::atomic<bool> timed_out{false};
+};
+
+#endif // ROUTE_SIM_H
@@ -0,0 +1,57 @@
+#ifndef TRACE_REPLAY_H
+#define TRACE_REPLAY_H
+
+#include <string>
+#include <vector>
+#include "json.hpp"
+#include "trace.h"
+
+// 记录中的一次导航（Nav Start 到 End）
+struct TraceTrip {
+    std::string target;
+    nlohmann::json path;
+    uint64_t start_ns = 0;          // 记录时钟下的开始/结束时刻
+    uint64_t end_ns = 0;
+    bool completed = false;
+    struct Step {
+        std::string action;
+        int value = 0;
+        double at_s = 0.0;          // 相对开始时刻
+    };
+    std::vector<Step> steps;
+    std::vector<std::pair<int, int>> commands;   // 依次出现的不同电机指令（左、右）
+
+    double duration() const { return (end_ns - start_ns) * 1e-9; }
+};
+
+std::vector<TraceTrip> findTrips(const std::vector<Trace::Sample>& samples);
+
+struct ReplayOptions {
+    double speed = 0.0;         // 回放倍速，0 为尽快
+    int imu_rate_hz = 50;       // 交给 Madgwick 的采样率，默认与在线 YAW_RATE_HZ 一致
+    double warmup_s = 10.0;     // 导航开始前先送入这么久的 IMU 数据让滤波器收敛
+    std::string out_path;       // 回放过程另存为记录；为空时写临时文件，比对完删除
+};
+
+struct ReplayReport {
+    TraceTrip recorded;
+    TraceTrip replayed;
+    int imu_samples = 0;
+    int range_samples = 0;
+    int divergence = -1;        // 电机指令序列第一次不一致的位置，-1 为一致
+};
+
+// 把一段记录喂回真实的导航逻辑：IMU 帧按原时间戳送进 YawTracker/Madgwick，
+// 超声波读数按时间戳交给限速器，电机/舵机走 SimBoard 仿真后端，
+// 在虚拟时钟上运行，同一份记录、同一份代码的回放结果完全确定。
+class TraceReplay {
+public:
+    explicit TraceReplay(const std::vector<Trace::Sample>& samples);
+
+    ReplayReport run(const TraceTrip& trip, const ReplayOptions& options = ReplayOptions());
+
+private:
+    const std::vector<Trace::Sample>& samples;
+};
+
+#endif // TRACE_REPLAY_H
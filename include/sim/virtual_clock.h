@@ -0,0 +1,56 @@
+#ifndef VIRTUAL_CLOCK_H
+#define VIRTUAL_CLOCK_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include "clock.h"
+
+// 锁步虚拟时钟：调用过 sleepNs 的线程自动成为参与者，
+// 只有当全部参与者都在睡眠时，时间才跳到最早的唤醒时刻，
+// 中间按 max_step_ns 分段回调 step（物理积分），因此运行速度只受计算量限制。
+// 参与者在 sleep 以外的地方长时间阻塞会卡住时钟，收尾时先 release() 再 join 线程。
+class VirtualClock : public ClockSource {
+public:
+    using StepCallback = std::function<void(uint64_t from_ns, uint64_t to_ns)>;
+
+    explicit VirtualClock(uint64_t max_step_ns = 1000000);
+    ~VirtualClock() override;
+
+    uint64_t nowNs() override;
+    void sleepNs(uint64_t ns) override;
+
+    // 在所有参与者睡眠时调用，持有时钟锁，回调内不能再 sleep
+    void setStepCallback(StepCallback cb);
+
+    // 当前线程显式加入锁步（驱动时间的主线程应在启动其他参与线程之前调用）
+    void enter();
+
+    // 当前线程退出锁步（线程结束时也会自动退出）
+    void leave();
+
+    // 等到至少 n 个线程加入锁步。新线程在第一次 sleep 时才加入，
+    // 启动参与线程后调用，防止时间在它加入之前被其他线程推远
+    void waitForParticipants(int n);
+
+    // 唤醒全部等待者，此后 sleepNs 立即返回
+    void release();
+
+private:
+    void leaveLocked();
+    void advanceLocked();
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    uint64_t now = 0;
+    uint64_t max_step;
+    int participants = 0;
+    int sleeping = 0;
+    bool released = false;
+    std::multimap<uint64_t, int> wakeups;   // 唤醒时刻 -> 占位
+    StepCallback step;
+};
+
+#endif // VIRTUAL_CLOCK_H
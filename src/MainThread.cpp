@@ -1,10 +1,14 @@
 #include "MainThread.h"
-#include "motor.h"
-#include "servo.h"
+#include "hardware_context.h"
 //#include "servonew.h"
 #include "yaw_tracker.h"
 #include "nav.h"
 #include "face_recognizer.h"
+#include "camera.h"
+#include "audio_engine.h"
+#include "record.h"
+#include "keyword_spotter.h"
+#include "timeline.h"
 #include "json.hpp"
 
 #include <iostream>
@@ -15,8 +19,64 @@
 #include <cstdlib>
 
 void playAudio2(const std::string& path) {
-    std::string cmd = "mplayer -volume 100 " + path + " >/dev/null 2>&1";
-    system(cmd.c_str());
+    AudioEngine::instance().play(path);
+}
+
+static bool loadNavJson(nlohmann::json& navJson) {
+    std::ifstream navFile("../config/nav.json");
+    if (!navFile.is_open()) {
+        std::cerr << "[DEBUG] Failed to open navigation config file.\n";
+        return false;
+    }
+    try {
+        navFile >> navJson;
+    } catch (const std::exception& e) {
+        std::cerr << "[DEBUG] Failed to parse navigation config: " << e.what() << "\n";
+        return false;
+    }
+    return true;
+}
+
+static void launchNavigation(const std::string& department, const std::string& audio_start, const std::string& audio_stop) {
+    nlohmann::json navJson;
+    if (!loadNavJson(navJson)) return;
+
+    if (!navJson.contains(department)) {
+        std::cerr << "[DEBUG] Department not found: " << department << "\n";
+        return;
+    }
+
+    HardwareContext& hw = HardwareContext::instance();
+    if (!hw.ready()) {
+        std::cerr << "[DEBUG] Drive hardware not ready.\n";
+        return;
+    }
+    if (!hw.tryAcquire()) {
+        std::cerr << "[DEBUG] Navigation already in progress.\n";
+        return;
+    }
+
+    Timeline::begin(department);
+    Timeline::instant("navigation requested", "trip", department);
+
+    std::thread([&hw, department, navJson, audio_start, audio_stop]() {
+        Timeline::nameThread("nav");
+        {
+            Timeline::Span span("audio_prompt", "audio", "start");
+            playAudio2(audio_start);
+        }
+        Nav::startNavigation.store(true);
+        Nav::motion.release(MotionSource::Pause);
+
+        Nav::navigationThread(hw.motor(), hw.servo(), hw.yaw(), department, navJson);
+
+        hw.release();
+        {
+            Timeline::Span span("audio_prompt", "audio", "stop");
+            playAudio2(audio_stop);
+        }
+        Timeline::end();
+    }).detach();
 }
 
 void startMainThread() {
@@ -25,11 +85,41 @@ void startMainThread() {
     std::string audio_start   = "../source/starts.mp3";
     std::string audio_hold    = "../source/hold.mp3";
     std::string audio_stop    = "../source/stops.mp3";
+    std::string voice_path    = "../source/tmp/record.wav";
+    std::string keyword_folder = "../source/keywords";
+
+    AudioEngine& audio = AudioEngine::instance();
+    if (audio.init()) {
+        audio.load(audio_start, audio_start);
+        audio.load("hold", audio_hold);
+        audio.load(audio_stop, audio_stop);
+    }
 
     FaceRecognizerLib recognizer;
     if (!recognizer.init(face_folder)) {
         std::cerr << "[DEBUG] Failed to initialize face recognition.\n";
     }
+    // 与 MainController 一致：默认打开 CAMERA_DEVICE，ROBO_CAMERA 可指定设备或图片目录；
+    // 打不开或取不到帧时读 capture_path
+    const char* camera_spec = std::getenv("ROBO_CAMERA");
+    std::unique_ptr<Camera> camera = Camera::open(camera_spec && *camera_spec ? camera_spec : CAMERA_DEVICE);
+
+    // 电机、舵机、IMU、超声波开机时初始化一次，之后每次导航复用
+    HardwareContext& hw = HardwareContext::instance();
+    if (!hw.init()) {
+        std::cerr << "[DEBUG] Drive hardware incomplete, navigation disabled.\n";
+    }
+    Nav::speedGovernor.attach(hw.ultrasonic());
+
+    // 离线关键词识别：说完 300ms 即判定端点
+    VadConfig vad;
+    vad.hangover_frames = 30;
+    KeywordSpotter spotter(vad);
+    AudioCapture microphone;
+    nlohmann::json vocabJson;
+    if (loadNavJson(vocabJson)) {
+        spotter.loadTemplates(keyword_folder, KeywordSpotter::vocabularyFromNav(vocabJson));
+    }
 
     while (true) {
         std::string command;
@@ -37,51 +127,17 @@ void startMainThread() {
         std::cin >> command;
 
         if (command == "facedetection") {
-            // std::string result = recognizer.recognize(capture_path);
-            // std::cout << "Face recognition result: " << result << std::endl;
+            Camera::Frame frame;
+            if (camera) frame = camera->latest(500);
+            auto [label, distance] = frame ? recognizer.recognize(frame->gray) : recognizer.recognize(capture_path);
+            std::cout << "Face recognition result: " << label << " (distance " << distance << ")" << std::endl;
         }
         else if (command == "nav") {
             std::string department;
             std::cout << "Enter destination department: ";
             std::cin.ignore();
             std::getline(std::cin, department);
-
-            nlohmann::json navJson;
-            std::ifstream navFile("../config/nav.json");
-            if (!navFile.is_open()) {
-                std::cerr << "[DEBUG] Failed to open navigation config file.\n";
-                continue;
-            }
-
-            try {
-                navFile >> navJson;
-                navFile.close();
-
-                if (!navJson.contains(department)) {
-                    std::cerr << "[DEBUG] Department not found: " << department << "\n";
-                    continue;
-                }
-
-                MotorPins pins = {17, 16, 22, 23};
-                auto motor = std::make_shared<Motor>(pins);
-                auto servo = std::make_shared<Servo>(18);
-                auto yaw   = std::make_shared<YawTracker>();
-
-                std::thread([motor, servo, yaw, department, navJson, audio_start, audio_stop]() {
-                    playAudio2(audio_start);
-                    Nav::startNavigation.store(true);
-                    Nav::pauseNavigation.store(false);
-                    Nav::navCV.notify_all();
-
-                    Nav::navigationThread(motor.get(), servo.get(), yaw.get(), department, navJson);
-
-                    playAudio2(audio_stop);
-                }).detach();
-
-            } catch (const std::exception& e) {
-                std::cerr << "[DEBUG] Navigation startup error: " << e.what() << "\n";
-                continue;
-            }
+            launchNavigation(department, audio_start, audio_stop);
         }
         else if (command == "help") {
             std::cout << "[INFO] Available commands: nav, facedetection, help, list, voice, translate\n";
@@ -90,13 +146,30 @@ void startMainThread() {
             std::cout << "[INFO] List feature not implemented yet.\n";
         }
         else if (command == "voice") {
-            std::cout << "[INFO] Voice recognition feature not implemented yet.\n";
+            if (spotter.templateCount() == 0) {
+                // 没有关键词模板时退回到录音，便于采集模板
+                std::cout << "[INFO] Listening...\n";
+                if (Record::recordUtterance(voice_path, vad)) {
+                    std::cout << "[INFO] Utterance saved to " << voice_path << ", no voice templates loaded.\n";
+                }
+                continue;
+            }
+            std::cout << "[INFO] Say a department name...\n";
+            std::string department = spotter.listenOnce(microphone, 10000);
+            microphone.stop();
+            if (department.empty()) {
+                std::cout << "[INFO] No department recognized.\n";
+                continue;
+            }
+            launchNavigation(department, audio_start, audio_stop);
         }
         else if (command == "translate") {
             std::cout << "[INFO] Translation feature not implemented yet.\n";
         }
         else if (command == "quit") {
             std::cout << "[INFO] Quitting system..." << std::endl;
+            Nav::speedGovernor.attach(nullptr);
+            hw.stopAll();
             break;
         }
         else {
@@ -0,0 +1,407 @@
+#include "camera.h"
+#include "clock.h"
+#include "metrics.h"
+#include "thread_profile.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <iostream>
+#include <linux/videodev2.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+
+#define GRAB_TIMEOUT_MS 200       // 单次等帧上限，stop() 最多等这么久
+#define GRAB_RETRY_MS 10          // 设备出错后的重试间隔，避免空转
+
+static int xioctl(int fd, unsigned long request, void* arg) {
+    int r;
+    do {
+        r = ioctl(fd, request, arg);
+    } while (r < 0 && errno == EINTR);
+    return r;
+}
+
+// ---------------- V4l2Source ----------------
+
+V4l2Source::V4l2Source(const std::string& device, int width, int height, int buffers)
+    : device(device), w(width), h(height), buffer_count(buffers) {}
+
+V4l2Source::~V4l2Source() {
+    close();
+}
+
+bool V4l2Source::open() {
+    fd = ::open(device.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "[ERROR] Cannot open camera " << device << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    v4l2_capability cap{};
+    if (xioctl(fd, VIDIOC_QUERYCAP, &cap) < 0 ||
+        !(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE) || !(cap.capabilities & V4L2_CAP_STREAMING)) {
+        std::cerr << "[ERROR] " << device << " is not a streaming capture device.\n";
+        close();
+        return false;
+    }
+    if (!setFormat() || !mapBuffers()) {
+        close();
+        return false;
+    }
+
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(fd, VIDIOC_STREAMON, &type) < 0) {
+        std::cerr << "[ERROR] VIDIOC_STREAMON failed: " << std::strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    std::cout << "[INFO] Camera " << device << " streaming " << w << "x" << h << " "
+              << (pixel_format == V4L2_PIX_FMT_NV12 ? "NV12" : "YUYV") << " with " << buffers.size() << " buffers\n";
+    return true;
+}
+
+// 只接受首个平面就是完整 Y 的格式，灰度直接从 Y 平面拷出
+bool V4l2Source::setFormat() {
+    for (uint32_t fourcc : {V4L2_PIX_FMT_YUYV, V4L2_PIX_FMT_NV12}) {
+        v4l2_format fmt{};
+        fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        fmt.fmt.pix.width = w;
+        fmt.fmt.pix.height = h;
+        fmt.fmt.pix.pixelformat = fourcc;
+        fmt.fmt.pix.field = V4L2_FIELD_NONE;
+        if (xioctl(fd, VIDIOC_S_FMT, &fmt) < 0 || fmt.fmt.pix.pixelformat != fourcc) continue;
+
+        // 驱动可能调整分辨率，以实际协商结果为准
+        w = fmt.fmt.pix.width;
+        h = fmt.fmt.pix.height;
+        pixel_format = fourcc;
+        bytes_per_line = fmt.fmt.pix.bytesperline;
+        if (bytes_per_line == 0) bytes_per_line = fourcc == V4L2_PIX_FMT_YUYV ? w * 2 : w;
+        return true;
+    }
+    std::cerr << "[ERROR] " << device << " supports neither YUYV nor NV12.\n";
+    return false;
+}
+
+bool V4l2Source::mapBuffers() {
+    v4l2_requestbuffers req{};
+    req.count = buffer_count;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(fd, VIDIOC_REQBUFS, &req) < 0 || req.count < 2) {
+        std::cerr << "[ERROR] VIDIOC_REQBUFS failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    buffers.resize(req.count);
+    for (uint32_t i = 0; i < req.count; ++i) {
+        v4l2_buffer buf{};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        if (xioctl(fd, VIDIOC_QUERYBUF, &buf) < 0) return false;
+
+        void* start = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, buf.m.offset);
+        if (start == MAP_FAILED) {
+            std::cerr << "[ERROR] Camera buffer mmap failed: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        buffers[i].start = start;
+        buffers[i].length = buf.length;
+        if (xioctl(fd, VIDIOC_QBUF, &buf) < 0) return false;
+    }
+    return true;
+}
+
+void V4l2Source::close() {
+    if (fd < 0) return;
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    xioctl(fd, VIDIOC_STREAMOFF, &type);
+    for (auto& b : buffers) {
+        if (b.start) munmap(b.start, b.length);
+    }
+    buffers.clear();
+    v4l2_requestbuffers req{};
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    xioctl(fd, VIDIOC_REQBUFS, &req);
+    ::close(fd);
+    fd = -1;
+}
+
+bool V4l2Source::grab(cv::Mat& gray, int timeout_ms) {
+    if (fd < 0) return false;
+    pollfd pfd{fd, POLLIN, 0};
+    int r = poll(&pfd, 1, timeout_ms);
+    if (r == 0) return false;
+    if (r < 0 || !(pfd.revents & POLLIN)) {
+        // 设备拔出或出错时 poll 立即返回，稍等再试
+        std::this_thread::sleep_for(std::chrono::milliseconds(GRAB_RETRY_MS));
+        return false;
+    }
+
+    v4l2_buffer buf{};
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(fd, VIDIOC_DQBUF, &buf) < 0) return false;
+
+    // 最后一行只需要实际像素宽度：YUYV 每像素 2 字节，NV12 的亮度平面每像素 1 字节
+    const uint32_t row_bytes = pixel_format == V4L2_PIX_FMT_YUYV ? 2u * w : static_cast<uint32_t>(w);
+    bool ok = !(buf.flags & V4L2_BUF_FLAG_ERROR) && buf.bytesused >= bytes_per_line * static_cast<uint32_t>(h - 1) + row_bytes;
+    if (ok) {
+        gray.create(h, w, CV_8UC1);   // 尺寸不变时不会重新分配
+        const uint8_t* base = static_cast<const uint8_t*>(buffers[buf.index].start);
+        for (int y = 0; y < h; ++y) {
+            const uint8_t* src = base + static_cast<size_t>(y) * bytes_per_line;
+            uint8_t* dst = gray.ptr<uint8_t>(y);
+            if (pixel_format == V4L2_PIX_FMT_NV12) {
+                std::memcpy(dst, src, w);
+            } else {
+                // YUYV：Y0 U Y1 V，每隔一个字节取亮度
+                for (int x = 0; x < w; ++x) dst[x] = src[2 * x];
+            }
+        }
+    }
+    // 拷完立即还给驱动，驱动始终有缓冲可填
+    xioctl(fd, VIDIOC_QBUF, &buf);
+    return ok;
+}
+
+// ---------------- FileSequenceSource ----------------
+
+FileSequenceSource::FileSequenceSource(const std::string& path, double fps, bool loop)
+    : path(path), period_ns(static_cast<uint64_t>(1e9 / (fps > 0 ? fps : 15.0))), loop(loop) {}
+
+bool FileSequenceSource::open() {
+    namespace fs = std::filesystem;
+    files.clear();
+    if (fs::is_directory(path)) {
+        for (const auto& entry : fs::directory_iterator(path)) {
+            if (!entry.is_regular_file()) continue;
+            std::string ext = entry.path().extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            if (ext == ".jpg" || ext == ".jpeg" || ext == ".png" || ext == ".bmp" || ext == ".pgm") {
+                files.push_back(entry.path().string());
+            }
+        }
+        std::sort(files.begin(), files.end());
+    } else if (fs::is_regular_file(path)) {
+        files.push_back(path);
+    }
+    if (files.empty()) {
+        std::cerr << "[ERROR] No images for camera file source: " << path << std::endl;
+        return false;
+    }
+
+    // 以第一张图的尺寸作为帧尺寸，其余图片缩放到这个尺寸
+    cv::Mat first = cv::imread(files.front(), cv::IMREAD_GRAYSCALE);
+    if (first.empty()) {
+        std::cerr << "[ERROR] Cannot read " << files.front() << std::endl;
+        return false;
+    }
+    w = first.cols;
+    h = first.rows;
+    next = 0;
+    next_due_ns = Clock::nowNs();
+    std::cout << "[INFO] Camera replaying " << files.size() << " images from " << path << std::endl;
+    return true;
+}
+
+bool FileSequenceSource::grab(cv::Mat& gray, int timeout_ms) {
+    if (next >= files.size()) {
+        if (!loop || files.empty()) {
+            Clock::sleepFor(std::chrono::milliseconds(timeout_ms));
+            return false;
+        }
+        next = 0;
+    }
+
+    uint64_t now = Clock::nowNs();
+    if (next_due_ns > now) {
+        uint64_t wait = next_due_ns - now;
+        if (wait > static_cast<uint64_t>(timeout_ms) * 1000000ull) {
+            Clock::sleepFor(std::chrono::milliseconds(timeout_ms));
+            return false;
+        }
+        Clock::sleepNs(wait);
+    }
+    next_due_ns = std::max(next_due_ns + period_ns, Clock::nowNs());
+
+    // 文件解码本身要分配，这条路径只用于测试
+    cv::Mat img = cv::imread(files[next++], cv::IMREAD_GRAYSCALE);
+    if (img.empty()) return false;
+    gray.create(h, w, CV_8UC1);
+    if (img.rows == h && img.cols == w) {
+        img.copyTo(gray);
+    } else {
+        cv::resize(img, gray, cv::Size(w, h));
+    }
+    return true;
+}
+
+// ---------------- FramePool ----------------
+
+FramePool::FramePool(int width, int height, size_t depth) : depth(std::max<size_t>(depth, 1)) {
+    // 待取 depth 帧 + 采集端正在写的一帧 + 消费端正在用的一帧
+    frames.resize(this->depth + 2);
+    free_list.reserve(frames.size());
+    ready.reserve(frames.size());
+    for (auto& f : frames) {
+        f.gray.create(height, width, CV_8UC1);
+        free_list.push_back(&f);
+    }
+}
+
+CameraFrame* FramePool::acquire() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!free_list.empty()) {
+        CameraFrame* f = free_list.back();
+        free_list.pop_back();
+        return f;
+    }
+    // 消费者来不及取：覆盖最旧的待取帧
+    if (!ready.empty()) {
+        CameraFrame* f = ready.front();
+        ready.erase(ready.begin());
+        dropped_frames.fetch_add(1);
+        return f;
+    }
+    return nullptr;
+}
+
+void FramePool::publish(CameraFrame* frame) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        frame->seq = next_seq++;
+        if (ready.size() >= depth) {
+            free_list.push_back(ready.front());
+            ready.erase(ready.begin());
+            dropped_frames.fetch_add(1);
+        }
+        ready.push_back(frame);
+    }
+    cv.notify_all();
+}
+
+void FramePool::discard(CameraFrame* frame) {
+    std::lock_guard<std::mutex> lock(mtx);
+    free_list.push_back(frame);
+}
+
+CameraFrame* FramePool::takeLatest(int timeout_ms) {
+    std::unique_lock<std::mutex> lock(mtx);
+    uint64_t gen = wake_gen;
+    if (!cv.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                     [&] { return !ready.empty() || wake_gen != gen; }) || ready.empty()) {
+        return nullptr;
+    }
+    CameraFrame* f = ready.back();
+    ready.pop_back();
+    // 比它旧的帧已经过时，不再交给任何人
+    dropped_frames.fetch_add(ready.size());
+    for (CameraFrame* stale : ready) free_list.push_back(stale);
+    ready.clear();
+    return f;
+}
+
+void FramePool::release(CameraFrame* frame) {
+    std::lock_guard<std::mutex> lock(mtx);
+    free_list.push_back(frame);
+}
+
+void FramePool::wake() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        ++wake_gen;
+    }
+    cv.notify_all();
+}
+
+// ---------------- Camera ----------------
+
+Camera::Frame& Camera::Frame::operator=(Frame&& other) noexcept {
+    if (this != &other) {
+        reset();
+        pool = std::move(other.pool);
+        frame = other.frame;
+        other.frame = nullptr;
+    }
+    return *this;
+}
+
+void Camera::Frame::reset() {
+    if (frame) pool->release(frame);
+    frame = nullptr;
+    pool.reset();
+}
+
+Camera::Camera(std::unique_ptr<FrameSource> source, size_t depth) : source(std::move(source)), depth(depth) {}
+
+Camera::~Camera() {
+    stop();
+}
+
+std::unique_ptr<Camera> Camera::open(const std::string& spec) {
+    if (spec.empty()) return nullptr;
+    std::unique_ptr<FrameSource> source;
+    if (spec.rfind("/dev/", 0) == 0) {
+        source = std::make_unique<V4l2Source>(spec);
+    } else {
+        source = std::make_unique<FileSequenceSource>(spec);
+    }
+    auto camera = std::make_unique<Camera>(std::move(source));
+    if (!camera->start()) return nullptr;
+    return camera;
+}
+
+bool Camera::start() {
+    if (running.load()) return true;
+    if (!source->open()) return false;
+    // 帧池按协商出的尺寸分配一次，重新 start 时尺寸不变就沿用；
+    // 尺寸变了换新池，外面还拿着的旧帧各自持有旧池，还回后旧池才释放
+    if (!pool || pool->width() != source->width() || pool->height() != source->height()) {
+        pool = std::make_shared<FramePool>(source->width(), source->height(), depth);
+    }
+    running.store(true);
+    capture_thread = std::thread(&Camera::captureLoop, this);
+    return true;
+}
+
+void Camera::stop() {
+    if (!running.exchange(false)) return;
+    if (pool) pool->wake();
+    if (capture_thread.joinable()) capture_thread.join();
+    source->close();
+}
+
+Camera::Frame Camera::latest(int timeout_ms) {
+    if (!pool) return Frame();
+    CameraFrame* f = pool->takeLatest(timeout_ms);
+    return f ? Frame(pool, f) : Frame();
+}
+
+void Camera::captureLoop() {
+    ThreadProfile::apply(ThreadProfile::Role::Vision);
+    static Metrics::Counter& captured = Metrics::counter("camera_frames_total", "Frames captured from the camera");
+    while (running.load()) {
+        CameraFrame* f = pool->acquire();
+        if (!f) {
+            // 所有帧都在消费者手里，这一帧让驱动丢掉
+            std::this_thread::sleep_for(std::chrono::milliseconds(GRAB_RETRY_MS));
+            continue;
+        }
+        if (!source->grab(f->gray, GRAB_TIMEOUT_MS)) {
+            pool->discard(f);
+            continue;
+        }
+        f->t_ns = Clock::nowNs();
+        pool->publish(f);
+        captured.inc();
+    }
+}
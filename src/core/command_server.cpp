@@ -0,0 +1,244 @@
+#include "command_server.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define MAX_EVENTS 32
+#define MAX_LINE_BYTES (64 * 1024)        // 超长的行视为协议错误，断开
+#define MAX_PENDING_OUT (1024 * 1024)     // 不读应答的慢客户端不能无限占内存
+
+CommandServer::CommandServer(Handler handler) : handler(std::move(handler)) {}
+
+CommandServer::~CommandServer() {
+    close();
+}
+
+bool CommandServer::listen(const std::string& socket_path) {
+    close();
+
+    sockaddr_un addr{};
+    if (socket_path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "[ERROR] Command socket path too long: " << socket_path << std::endl;
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+    unlink(socket_path.c_str());
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(fd, 16) < 0) {
+        std::cerr << "[ERROR] Command server cannot listen on " << socket_path << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+    // 同组用户（GUI、护士站桥接、测试脚本）可以连接
+    chmod(socket_path.c_str(), 0660);
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_fd < 0 || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        std::cerr << "[ERROR] Command server epoll setup failed: " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        if (epoll_fd >= 0) ::close(epoll_fd);
+        epoll_fd = -1;
+        return false;
+    }
+
+    listen_fd = fd;
+    path = socket_path;
+    std::cout << "[INFO] Command server listening on " << path << std::endl;
+    return true;
+}
+
+void CommandServer::close() {
+    for (auto& [fd, client] : clients) ::close(fd);
+    clients.clear();
+    pending.clear();
+    if (listen_fd >= 0) {
+        ::close(listen_fd);
+        unlink(path.c_str());
+        listen_fd = -1;
+    }
+    if (epoll_fd >= 0) {
+        ::close(epoll_fd);
+        epoll_fd = -1;
+    }
+}
+
+void CommandServer::poll(int timeout_ms) {
+    if (epoll_fd < 0) return;
+    epoll_event events[MAX_EVENTS];
+    int n = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout_ms);
+    for (int i = 0; i < n; ++i) {
+        int fd = events[i].data.fd;
+        if (fd == listen_fd) {
+            accept();
+            continue;
+        }
+        // 挂断前发来的请求先读完再断开
+        if (events[i].events & EPOLLIN) readFrom(fd);
+        if (!clients.count(fd)) continue;
+        if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+            drop(fd);
+            continue;
+        }
+        if (events[i].events & EPOLLOUT) writeTo(fd);
+    }
+}
+
+void CommandServer::accept() {
+    while (true) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;   // EAGAIN：这一批已经接完
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            ::close(fd);
+            continue;
+        }
+        Client client;
+        client.serial = ++next_serial;
+        clients[fd] = std::move(client);
+    }
+}
+
+void CommandServer::readFrom(int fd) {
+    Client& client = clients[fd];
+    char buf[4096];
+    bool eof = false;
+    while (true) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n > 0) {
+            client.in.append(buf, n);
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n < 0) {
+            drop(fd);
+            return;
+        }
+        eof = true;   // 对端关闭了写方向，已收到的请求仍然应答
+        break;
+    }
+
+    size_t start = 0, end;
+    while ((end = client.in.find('\n', start)) != std::string::npos) {
+        std::string line = client.in.substr(start, end - start);
+        start = end + 1;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        current_fd = fd;
+        client.out += handleLine(line);
+        current_fd = -1;
+    }
+    client.in.erase(0, start);
+    if (client.in.size() > MAX_LINE_BYTES || client.out.size() > MAX_PENDING_OUT) {
+        std::cerr << "[DEBUG] Command client exceeded buffer limits, disconnecting.\n";
+        drop(fd);
+        return;
+    }
+    if (!client.out.empty()) writeTo(fd);
+    if (eof && clients.count(fd)) {
+        // 还有延迟应答没写回时先留着连接，complete() 写完最后一个再断开
+        if (client.deferred > 0) {
+            client.closing = true;
+            updateInterest(fd);
+        } else {
+            drop(fd);
+        }
+    }
+}
+
+void CommandServer::writeTo(int fd) {
+    Client& client = clients[fd];
+    while (!client.out.empty()) {
+        ssize_t n = send(fd, client.out.data(), client.out.size(), MSG_NOSIGNAL);
+        if (n > 0) {
+            client.out.erase(0, n);
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        drop(fd);
+        return;
+    }
+    updateInterest(fd);
+}
+
+// 有待发数据时才关心 EPOLLOUT，否则套接字可写会让 epoll 一直醒；
+// 对端已关闭写方向时不再关心可读，否则 EPOLLRDHUP 会一直触发
+void CommandServer::updateInterest(int fd) {
+    const Client& client = clients[fd];
+    epoll_event ev{};
+    ev.events = (client.closing ? 0u : static_cast<uint32_t>(EPOLLIN | EPOLLRDHUP)) |
+                (client.out.empty() ? 0u : static_cast<uint32_t>(EPOLLOUT));
+    ev.data.fd = fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+}
+
+void CommandServer::drop(int fd) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    clients.erase(fd);
+}
+
+std::string CommandServer::handleLine(const std::string& line) {
+    nlohmann::json request, response;
+    try {
+        request = nlohmann::json::parse(line);
+    } catch (const std::exception&) {
+        return nlohmann::json({{"ok", false}, {"error", "invalid json"}}).dump() + "\n";
+    }
+    if (!request.is_object() || !request.contains("cmd") || !request["cmd"].is_string()) {
+        response = {{"ok", false}, {"error", "missing cmd"}};
+    } else {
+        current_request = &request;
+        try {
+            response = handler(request);
+        } catch (const std::exception& e) {
+            response = {{"ok", false}, {"error", e.what()}};
+        }
+        current_request = nullptr;
+        // 已 defer()，应答之后由 complete() 写回
+        if (response.is_null()) return "";
+    }
+    if (request.is_object() && request.contains("id")) response["id"] = request["id"];
+    return response.dump() + "\n";
+}
+
+uint64_t CommandServer::defer() {
+    if (current_fd < 0 || !current_request) return 0;
+    Pending p;
+    p.fd = current_fd;
+    Client& client = clients[current_fd];
+    p.serial = client.serial;
+    client.deferred++;
+    if (current_request->contains("id")) p.id = (*current_request)["id"];
+    uint64_t token = ++next_token;
+    pending[token] = std::move(p);
+    return token;
+}
+
+void CommandServer::complete(uint64_t token, nlohmann::json response) {
+    auto it = pending.find(token);
+    if (it == pending.end()) return;
+    Pending p = std::move(it->second);
+    pending.erase(it);
+
+    auto client = clients.find(p.fd);
+    if (client == clients.end() || client->second.serial != p.serial) return;
+    if (!p.id.is_null()) response["id"] = p.id;
+    client->second.deferred--;
+    client->second.out += response.dump() + "\n";
+    writeTo(p.fd);
+    client = clients.find(p.fd);
+    if (client != clients.end() && client->second.closing && client->second.deferred == 0) drop(p.fd);
+}
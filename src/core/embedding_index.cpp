@@ -0,0 +1,307 @@
+#include "embedding_index.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#define EMBEDDING_ROW_ALIGN 32
+#define EMBEDDING_FILE_MAGIC 0x494D4245u   // "EBMI"
+#define EMBEDDING_FILE_VERSION 2    // 2：每行加来源文件的大小和修改时间
+#define IVF_TRAIN_PER_LIST 64      // k-means 每簇最多取这么多训练样本
+#define IVF_ITERATIONS 10
+
+// 两个 int8 向量的点积，n 是 32 的倍数（行尾补零）
+static int32_t dotI8(const int8_t* a, const int8_t* b, size_t n) {
+#if defined(__ARM_NEON) && defined(__ARM_FEATURE_DOTPROD)
+    int32x4_t acc = vdupq_n_s32(0);
+    for (size_t i = 0; i < n; i += 16) acc = vdotq_s32(acc, vld1q_s8(a + i), vld1q_s8(b + i));
+    return vaddvq_s32(acc);
+#elif defined(__ARM_NEON)
+    int32x4_t acc = vdupq_n_s32(0);
+    for (size_t i = 0; i < n; i += 16) {
+        int8x16_t va = vld1q_s8(a + i), vb = vld1q_s8(b + i);
+        acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(va), vget_low_s8(vb)));
+        acc = vpadalq_s16(acc, vmull_s8(vget_high_s8(va), vget_high_s8(vb)));
+    }
+    return vaddvq_s32(acc);
+#elif defined(__AVX2__)
+    __m256i acc = _mm256_setzero_si256();
+    for (size_t i = 0; i < n; i += 16) {
+        __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+        __m256i vb = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    s = _mm_hadd_epi32(s, s);
+    s = _mm_hadd_epi32(s, s);
+    return _mm_cvtsi128_si32(s);
+#else
+    int32_t sum = 0;
+    for (size_t i = 0; i < n; ++i) sum += static_cast<int32_t>(a[i]) * b[i];
+    return sum;
+#endif
+}
+
+static float dotF(const float* a, const float* b, int n) {
+    float sum = 0.0f;
+    for (int i = 0; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+static void normalize(float* v, int n) {
+    float norm = std::sqrt(dotF(v, v, n));
+    if (norm <= 0.0f) return;
+    for (int i = 0; i < n; ++i) v[i] /= norm;
+}
+
+// 保留相似度最高的 k 个，best 按相似度从高到低
+static void keepBest(std::vector<EmbeddingMatch>& best, size_t k, int row, float sim) {
+    if (best.size() == k && sim <= best.back().similarity) return;
+    auto pos = std::upper_bound(best.begin(), best.end(), sim,
+                                [](float s, const EmbeddingMatch& m) { return s > m.similarity; });
+    best.insert(pos, EmbeddingMatch{row, sim});
+    if (best.size() > k) best.pop_back();
+}
+
+EmbeddingIndex::EmbeddingIndex(int dim)
+    : d(dim), stride((dim + EMBEDDING_ROW_ALIGN - 1) / EMBEDDING_ROW_ALIGN * EMBEDDING_ROW_ALIGN) {}
+
+// 归一化后按最大分量缩放到 [-127, 127]，返回反量化系数
+float EmbeddingIndex::quantize(const float* v, int8_t* out) const {
+    std::vector<float> unit(v, v + d);
+    normalize(unit.data(), d);
+    float max_abs = 0.0f;
+    for (float x : unit) max_abs = std::max(max_abs, std::abs(x));
+    if (max_abs <= 0.0f) {
+        std::memset(out, 0, stride);
+        return 0.0f;
+    }
+    float scale = 127.0f / max_abs;
+    for (int i = 0; i < d; ++i) out[i] = static_cast<int8_t>(std::lround(unit[i] * scale));
+    std::memset(out + d, 0, stride - d);
+    return 1.0f / scale;
+}
+
+int EmbeddingIndex::add(const std::string& name, const float* embedding, const EmbeddingSource& source) {
+    auto it = rows.find(name);
+    int row = it != rows.end() ? it->second : static_cast<int>(names.size());
+    if (it == rows.end()) {
+        names.push_back(name);
+        rows[name] = row;
+        codes.resize(names.size() * stride);
+        scales.push_back(0.0f);
+        sources.emplace_back();
+    }
+    scales[row] = quantize(embedding, codes.data() + row * stride);
+    sources[row] = source;
+    return row;
+}
+
+bool EmbeddingIndex::remove(const std::string& name) {
+    auto it = rows.find(name);
+    if (it == rows.end()) return false;
+    size_t row = static_cast<size_t>(it->second);
+    size_t last = names.size() - 1;
+    rows.erase(it);
+    if (row != last) {
+        names[row] = std::move(names[last]);
+        scales[row] = scales[last];
+        sources[row] = sources[last];
+        std::memcpy(codes.data() + row * stride, codes.data() + last * stride, stride);
+        rows[names[row]] = static_cast<int>(row);
+    }
+    names.pop_back();
+    scales.pop_back();
+    sources.pop_back();
+    codes.resize(names.size() * stride);
+    // 行号变了，簇里的行号不再可信
+    lists.clear();
+    centroids.clear();
+    ivf_rows = 0;
+    return true;
+}
+
+int EmbeddingIndex::find(const std::string& name) const {
+    auto it = rows.find(name);
+    return it != rows.end() ? it->second : -1;
+}
+
+float EmbeddingIndex::similarity(const int8_t* q, float q_scale, int row) const {
+    return dotI8(q, codes.data() + static_cast<size_t>(row) * stride, stride) * q_scale * scales[row];
+}
+
+void EmbeddingIndex::scanRow(const int8_t* q, float q_scale, int row, std::vector<EmbeddingMatch>& best, size_t k) const {
+    keepBest(best, k, row, similarity(q, q_scale, row));
+}
+
+std::vector<EmbeddingMatch> EmbeddingIndex::search(const float* query, size_t k) const {
+    std::vector<EmbeddingMatch> best;
+    if (names.empty() || k == 0) return best;
+    best.reserve(k + 1);
+
+    std::vector<int8_t> q(stride);
+    float q_scale = quantize(query, q.data());
+
+    if (lists.empty()) {
+        for (size_t row = 0; row < names.size(); ++row) scanRow(q.data(), q_scale, static_cast<int>(row), best, k);
+        return best;
+    }
+
+    // 先找最近的 nprobe 个簇，只扫这些簇和建簇后新增的行
+    std::vector<float> unit(query, query + d);
+    normalize(unit.data(), d);
+    std::vector<EmbeddingMatch> probes;
+    size_t want = std::min(static_cast<size_t>(nprobe), lists.size());
+    probes.reserve(want + 1);
+    for (size_t c = 0; c < lists.size(); ++c) {
+        keepBest(probes, want, static_cast<int>(c), dotF(unit.data(), centroids.data() + c * d, d));
+    }
+    for (const auto& p : probes) {
+        for (int row : lists[p.row]) scanRow(q.data(), q_scale, row, best, k);
+    }
+    for (size_t row = ivf_rows; row < names.size(); ++row) scanRow(q.data(), q_scale, static_cast<int>(row), best, k);
+    return best;
+}
+
+void EmbeddingIndex::buildIvf(int nlist, int nprobe) {
+    size_t n = names.size();
+    if (nlist <= 0) nlist = static_cast<int>(std::sqrt(static_cast<double>(n)));
+    nlist = std::min<int>(nlist, static_cast<int>(n));
+    this->nprobe = std::max(1, nprobe);
+    lists.clear();
+    centroids.clear();
+    ivf_rows = 0;
+    if (nlist < 2) return;
+
+    auto dequantize = [&](size_t row, float* out) {
+        const int8_t* c = codes.data() + row * stride;
+        for (int i = 0; i < d; ++i) out[i] = c[i] * scales[row];
+    };
+
+    // 等间隔取训练样本，初始簇心也从样本里等间隔取，结果可复现
+    size_t train_n = std::min(n, static_cast<size_t>(nlist) * IVF_TRAIN_PER_LIST);
+    std::vector<float> train(train_n * d);
+    for (size_t i = 0; i < train_n; ++i) dequantize(i * n / train_n, train.data() + i * d);
+    centroids.resize(static_cast<size_t>(nlist) * d);
+    for (int c = 0; c < nlist; ++c) {
+        std::memcpy(centroids.data() + static_cast<size_t>(c) * d,
+                    train.data() + static_cast<size_t>(c) * train_n / nlist * d, d * sizeof(float));
+    }
+
+    auto nearest = [&](const float* v) {
+        int best = 0;
+        float best_sim = -2.0f;
+        for (int c = 0; c < nlist; ++c) {
+            float s = dotF(v, centroids.data() + static_cast<size_t>(c) * d, d);
+            if (s > best_sim) {
+                best_sim = s;
+                best = c;
+            }
+        }
+        return best;
+    };
+
+    std::vector<float> sums(centroids.size());
+    std::vector<int> counts(nlist);
+    for (int iter = 0; iter < IVF_ITERATIONS; ++iter) {
+        std::fill(sums.begin(), sums.end(), 0.0f);
+        std::fill(counts.begin(), counts.end(), 0);
+        for (size_t i = 0; i < train_n; ++i) {
+            const float* v = train.data() + i * d;
+            int c = nearest(v);
+            for (int j = 0; j < d; ++j) sums[static_cast<size_t>(c) * d + j] += v[j];
+            counts[c]++;
+        }
+        // 球面 k-means：簇心取均值后重新归一化，空簇保留原簇心
+        for (int c = 0; c < nlist; ++c) {
+            if (counts[c] == 0) continue;
+            float* centroid = centroids.data() + static_cast<size_t>(c) * d;
+            std::memcpy(centroid, sums.data() + static_cast<size_t>(c) * d, d * sizeof(float));
+            normalize(centroid, d);
+        }
+    }
+
+    lists.assign(nlist, {});
+    std::vector<float> v(d);
+    for (size_t row = 0; row < n; ++row) {
+        dequantize(row, v.data());
+        lists[nearest(v.data())].push_back(static_cast<int>(row));
+    }
+    ivf_rows = n;
+    std::cout << "[INFO] Embedding index: " << n << " faces in " << nlist << " lists, probing " << this->nprobe << std::endl;
+}
+
+bool EmbeddingIndex::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    uint32_t header[4] = {EMBEDDING_FILE_MAGIC, EMBEDDING_FILE_VERSION, static_cast<uint32_t>(d),
+                          static_cast<uint32_t>(names.size())};
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    for (size_t row = 0; row < names.size(); ++row) {
+        uint32_t len = static_cast<uint32_t>(names[row].size());
+        out.write(reinterpret_cast<const char*>(&len), sizeof(len));
+        out.write(names[row].data(), len);
+        out.write(reinterpret_cast<const char*>(&sources[row].size), sizeof(uint64_t));
+        out.write(reinterpret_cast<const char*>(&sources[row].mtime), sizeof(int64_t));
+        out.write(reinterpret_cast<const char*>(&scales[row]), sizeof(float));
+        out.write(reinterpret_cast<const char*>(codes.data() + row * stride), d);
+    }
+    return static_cast<bool>(out);
+}
+
+bool EmbeddingIndex::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    uint32_t header[4] = {};
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!in || header[0] != EMBEDDING_FILE_MAGIC || header[1] != EMBEDDING_FILE_VERSION ||
+        header[2] != static_cast<uint32_t>(d)) {
+        return false;
+    }
+
+    // 行数来自文件，先和文件大小核对再分配；每行至少有长度、来源、系数和 d 字节向量，
+    // 截断或损坏的缓存不能让启动时去申请几个 GB 内存
+    const size_t min_row = sizeof(uint32_t) + sizeof(uint64_t) + sizeof(int64_t) + sizeof(float) + d;
+    in.seekg(0, std::ios::end);
+    const std::streamoff file_size = in.tellg();
+    in.seekg(sizeof(header), std::ios::beg);
+    if (file_size < static_cast<std::streamoff>(sizeof(header)) ||
+        header[3] > static_cast<uint64_t>(file_size - sizeof(header)) / min_row) {
+        std::cerr << "[ERROR] Embedding cache " << path << " is truncated or corrupt, rebuilding." << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> file_names(header[3]);
+    std::vector<float> file_scales(header[3]);
+    std::vector<EmbeddingSource> file_sources(header[3]);
+    std::vector<int8_t> file_codes(static_cast<size_t>(header[3]) * stride, 0);
+    for (uint32_t row = 0; row < header[3]; ++row) {
+        uint32_t len = 0;
+        in.read(reinterpret_cast<char*>(&len), sizeof(len));
+        if (!in || len > 4096) return false;
+        file_names[row].resize(len);
+        in.read(&file_names[row][0], len);
+        in.read(reinterpret_cast<char*>(&file_sources[row].size), sizeof(uint64_t));
+        in.read(reinterpret_cast<char*>(&file_sources[row].mtime), sizeof(int64_t));
+        in.read(reinterpret_cast<char*>(&file_scales[row]), sizeof(float));
+        in.read(reinterpret_cast<char*>(file_codes.data() + static_cast<size_t>(row) * stride), d);
+        if (!in) return false;
+    }
+
+    names.swap(file_names);
+    scales.swap(file_scales);
+    sources.swap(file_sources);
+    codes.swap(file_codes);
+    rows.clear();
+    for (size_t row = 0; row < names.size(); ++row) rows[names[row]] = static_cast<int>(row);
+    lists.clear();
+    centroids.clear();
+    ivf_rows = 0;
+    return true;
+}
@@ -0,0 +1,120 @@
+#include "face_detector.h"
+#include <algorithm>
+#include <iostream>
+
+#define DNN_DETECTION_FIELDS 7   // image_id, label, score, x1, y1, x2, y2
+
+std::vector<std::vector<cv::Rect>> FaceDetector::detectBatch(const std::vector<cv::Mat>& frames) {
+    std::vector<std::vector<cv::Rect>> faces;
+    faces.reserve(frames.size());
+    for (const auto& frame : frames) faces.push_back(detect(frame));
+    return faces;
+}
+
+// ---------------- Haar ----------------
+
+bool HaarFaceDetector::load(const std::string& cascade_path) {
+    if (!cascade.load(cascade_path)) {
+        std::cerr << "unable to load face classifier" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::vector<cv::Rect> HaarFaceDetector::detect(const cv::Mat& frame) {
+    std::vector<cv::Rect> faces;
+    if (frame.channels() == 1) {
+        cascade.detectMultiScale(frame, faces);
+    } else {
+        cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+        cascade.detectMultiScale(gray, faces);
+    }
+    return faces;
+}
+
+// ---------------- DNN ----------------
+
+bool DnnFaceDetector::load(const DnnDetectorConfig& config) {
+    cfg = config;
+    try {
+        net = cv::dnn::readNet(cfg.model, cfg.config);
+    } catch (const cv::Exception& e) {
+        std::cerr << "[ERROR] Cannot load face detector model " << cfg.model << ": " << e.what() << std::endl;
+        return false;
+    }
+    if (net.empty()) return false;
+    net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+    net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+    // 线程池是全局的，识别只在 vision 核心上跑，线程数不超过那几个核
+    if (cfg.threads > 0) cv::setNumThreads(cfg.threads);
+    std::cout << "[INFO] DNN face detector loaded: " << cfg.model << std::endl;
+    return true;
+}
+
+// 模型按 BGR 三通道训练，灰度帧复制成三通道（缓冲复用）
+const cv::Mat& DnnFaceDetector::toBgr(const cv::Mat& frame, cv::Mat& scratch) {
+    if (frame.channels() == 3) return frame;
+    cv::cvtColor(frame, scratch, cv::COLOR_GRAY2BGR);
+    return scratch;
+}
+
+std::vector<cv::Rect> DnnFaceDetector::detect(const cv::Mat& frame) {
+    if (frame.empty()) return {};
+    if (bgr.empty()) bgr.resize(1);
+    const cv::Mat& input = toBgr(frame, bgr[0]);
+    cv::dnn::blobFromImage(input, blob, 1.0, cfg.input_size, cfg.mean, false, false);
+    net.setInput(blob);
+    net.forward(output);
+
+    std::vector<std::vector<cv::Rect>> faces(1);
+    parse({frame.size()}, faces);
+    return faces[0];
+}
+
+std::vector<std::vector<cv::Rect>> DnnFaceDetector::detectBatch(const std::vector<cv::Mat>& frames) {
+    std::vector<std::vector<cv::Rect>> faces(frames.size());
+    if (frames.empty()) return faces;
+    if (bgr.size() < frames.size()) bgr.resize(frames.size());
+    batch.clear();
+    std::vector<cv::Size> sizes;
+    sizes.reserve(frames.size());
+    for (size_t i = 0; i < frames.size(); ++i) {
+        batch.push_back(toBgr(frames[i], bgr[i]));
+        sizes.push_back(frames[i].size());
+    }
+    // 一次缩放 + 减均值 + 打包成 NCHW，前向一次
+    cv::dnn::blobFromImages(batch, blob, 1.0, cfg.input_size, cfg.mean, false, false);
+    net.setInput(blob);
+    net.forward(output);
+    parse(sizes, faces);
+    return faces;
+}
+
+void DnnFaceDetector::parse(const std::vector<cv::Size>& sizes, std::vector<std::vector<cv::Rect>>& faces) {
+    const float* d = output.ptr<float>();
+    size_t n = output.total() / DNN_DETECTION_FIELDS;
+    for (size_t i = 0; i < n; ++i, d += DNN_DETECTION_FIELDS) {
+        int image = static_cast<int>(d[0]);
+        float score = d[2];
+        if (image < 0 || image >= static_cast<int>(sizes.size()) || score < cfg.score_threshold) continue;
+
+        const cv::Size& size = sizes[image];
+        int x1 = std::clamp(static_cast<int>(d[3] * size.width), 0, size.width - 1);
+        int y1 = std::clamp(static_cast<int>(d[4] * size.height), 0, size.height - 1);
+        int x2 = std::clamp(static_cast<int>(d[5] * size.width), 0, size.width);
+        int y2 = std::clamp(static_cast<int>(d[6] * size.height), 0, size.height);
+        if (x2 - x1 < 2 || y2 - y1 < 2) continue;
+        faces[image].emplace_back(x1, y1, x2 - x1, y2 - y1);
+    }
+}
+
+std::unique_ptr<FaceDetector> makeFaceDetector(const std::string& kind) {
+    if (kind == "dnn") {
+        auto dnn = std::make_unique<DnnFaceDetector>();
+        if (dnn->load()) return dnn;
+        std::cerr << "[DEBUG] DNN face detector unavailable, falling back to Haar.\n";
+    }
+    auto haar = std::make_unique<HaarFaceDetector>();
+    if (haar->load()) return haar;
+    return nullptr;
+}
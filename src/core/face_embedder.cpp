@@ -0,0 +1,37 @@
+#include "face_embedder.h"
+#include <iostream>
+
+bool FaceEmbedder::load(const std::string& model) {
+    try {
+        net = cv::dnn::readNet(model);
+    } catch (const cv::Exception& e) {
+        std::cerr << "[ERROR] Cannot load face embedding model " << model << ": " << e.what() << std::endl;
+        return false;
+    }
+    if (net.empty()) return false;
+    net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+    net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+
+    // 用一张空图跑一次，拿到输出维度，顺便分配好网络内部缓冲
+    std::vector<float> probe;
+    if (!embed(cv::Mat::zeros(input_size.height, input_size.width, CV_8UC3), probe) || probe.empty()) return false;
+    d = static_cast<int>(probe.size());
+    std::cout << "[INFO] Face embedding model loaded: " << model << " (" << d << "-d)" << std::endl;
+    return true;
+}
+
+bool FaceEmbedder::embed(const cv::Mat& face, std::vector<float>& out) {
+    if (net.empty() || face.empty()) return false;
+    const cv::Mat* input = &face;
+    if (face.channels() == 1) {
+        cv::cvtColor(face, bgr, cv::COLOR_GRAY2BGR);
+        input = &bgr;
+    }
+    cv::dnn::blobFromImage(*input, blob, 1.0, input_size, cv::Scalar(), true, false);
+    net.setInput(blob);
+    net.forward(output);
+
+    const float* v = output.ptr<float>();
+    out.assign(v, v + output.total());
+    return true;
+}
@@ -0,0 +1,103 @@
+#include "face_prefetch.h"
+#include "thread_profile.h"
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <unordered_set>
+
+FacePrefetcher::FacePrefetcher(PatientStore& store, FaceRecognizerLib& recognizer, int refresh_hour)
+    : store(store), recognizer(recognizer), refresh_hour(refresh_hour) {}
+
+FacePrefetcher::~FacePrefetcher() {
+    stop();
+}
+
+std::string FacePrefetcher::currentDay() {
+    std::time_t now = std::time(nullptr);
+    std::tm local{};
+    localtime_r(&now, &local);
+    char buf[16];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%d", &local);
+    return buf;
+}
+
+std::string FacePrefetcher::faceFileFor(const PatientRecord& patient) {
+    // 与 RouteIndex 的人脸标签一致：PhotoPath 的文件名
+    size_t slash = patient.photoPath.find_last_of("/\\");
+    return slash == std::string::npos ? patient.photoPath : patient.photoPath.substr(slash + 1);
+}
+
+size_t FacePrefetcher::prefetch(const std::string& day) {
+    std::vector<std::string> files;
+    std::unordered_set<int> seen;
+    // "24:00:00" 字典序大于当天任何时刻、小于次日零点
+    for (const auto& r : store.registrationsBetween(day + " 00:00:00", day + " 24:00:00")) {
+        if (!seen.insert(r.patientId).second) continue;
+
+        auto patient = store.findPatient(r.patientId);
+        if (!patient || patient->photoPath.empty()) continue;
+        files.push_back(faceFileFor(*patient));
+    }
+
+    size_t loaded = recognizer.loadHotFaces(files);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        loaded_day = day;
+    }
+    std::cout << "[INFO] Face prefetch for " << day << ": " << loaded << " of "
+              << seen.size() << " appointments in hot gallery\n";
+    return loaded;
+}
+
+void FacePrefetcher::notifyPatients(const std::vector<int>& patientIds) {
+    std::string day;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        day = loaded_day;
+    }
+    if (day.empty()) return;
+
+    std::vector<std::string> files;
+    for (int id : patientIds) {
+        auto r = store.nextRegistration(id, day + " 00:00:00");
+        if (!r || r->appointmentTime.compare(0, day.size(), day) != 0) continue;
+        auto patient = store.findPatient(id);
+        if (!patient || patient->photoPath.empty()) continue;
+        files.push_back(faceFileFor(*patient));
+    }
+    if (!files.empty()) recognizer.addHotFaces(files);
+}
+
+void FacePrefetcher::start() {
+    if (!running.exchange(true)) {
+        schedule_thread = std::thread(&FacePrefetcher::scheduleLoop, this);
+    }
+}
+
+void FacePrefetcher::stop() {
+    if (running.exchange(false)) {
+        cv.notify_all();
+        if (schedule_thread.joinable()) schedule_thread.join();
+    }
+}
+
+void FacePrefetcher::scheduleLoop() {
+    ThreadProfile::apply(ThreadProfile::Role::Vision);
+    while (running.load()) {
+        prefetch(currentDay());
+
+        // 下一次刷新：今天 refresh_hour 点（若已过则明天）
+        std::time_t now = std::time(nullptr);
+        std::tm next{};
+        localtime_r(&now, &next);
+        if (next.tm_hour >= refresh_hour) next.tm_mday += 1;
+        next.tm_hour = refresh_hour;
+        next.tm_min = 0;
+        next.tm_sec = 0;
+        next.tm_isdst = -1;
+        auto wake = std::chrono::system_clock::from_time_t(std::mktime(&next));
+
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait_until(lock, wake, [this] { return !running.load(); });
+    }
+}
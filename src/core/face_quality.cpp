@@ -0,0 +1,172 @@
+#include "face_quality.h"
+#include <algorithm>
+#include <cmath>
+
+#define DARK_LEVEL 16
+#define BRIGHT_LEVEL 239
+#define EYE_BAND_TOP 0.20        // 眼部条带在归一化裁图里的纵向范围
+#define EYE_BAND_BOTTOM 0.55
+#define TRACK_MIN_IOU 0.3        // 与上一帧框重叠超过这个值视为同一个人
+#define TRACK_MAX_MISSED 5       // 连续这么多帧没出现就丢弃轨迹
+#define TRACK_MAX 8
+
+const char* faceRejectName(FaceQuality::Reject reject) {
+    switch (reject) {
+    case FaceQuality::Reject::Small:    return "small";
+    case FaceQuality::Reject::Blur:     return "blur";
+    case FaceQuality::Reject::Exposure: return "exposure";
+    case FaceQuality::Reject::Pose:     return "pose";
+    default:                            return "none";
+    }
+}
+
+FaceQualityGate::FaceQualityGate(const FaceQualityConfig& config) : cfg(config) {}
+
+FaceQuality FaceQualityGate::assess(const cv::Mat& gray, const cv::Rect& face) {
+    FaceQuality q;
+    cv::Rect r = face & cv::Rect(0, 0, gray.cols, gray.rows);
+    q.size = std::min(r.width, r.height);
+    if (q.size < cfg.min_size) {
+        q.reject = FaceQuality::Reject::Small;
+        return q;
+    }
+
+    cv::resize(gray(r), norm, cv::Size(NORM_SIZE, NORM_SIZE), 0, 0, cv::INTER_AREA);
+
+    // 清晰度：拉普拉斯响应的方差，模糊图像边缘弱、方差小
+    cv::Laplacian(norm, laplacian, CV_16S);
+    cv::Scalar mean, stddev;
+    cv::meanStdDev(laplacian, mean, stddev);
+    q.sharpness = stddev[0] * stddev[0];
+    if (q.sharpness < cfg.min_sharpness) {
+        q.reject = FaceQuality::Reject::Blur;
+        return q;
+    }
+
+    // 曝光：平均亮度和两端截断的像素比例
+    uint64_t sum = 0;
+    int clipped = 0;
+    for (int y = 0; y < NORM_SIZE; ++y) {
+        const uint8_t* row = norm.ptr<uint8_t>(y);
+        for (int x = 0; x < NORM_SIZE; ++x) {
+            sum += row[x];
+            clipped += (row[x] < DARK_LEVEL || row[x] > BRIGHT_LEVEL) ? 1 : 0;
+        }
+    }
+    const double pixels = NORM_SIZE * NORM_SIZE;
+    q.brightness = sum / pixels;
+    q.clipped = clipped / pixels;
+    if (q.brightness < cfg.min_brightness || q.brightness > cfg.max_brightness || q.clipped > cfg.max_clipped) {
+        q.reject = FaceQuality::Reject::Exposure;
+        return q;
+    }
+
+    q.symmetry = symmetry();
+    if (q.symmetry < cfg.min_symmetry) {
+        q.reject = FaceQuality::Reject::Pose;
+        return q;
+    }
+
+    // 各项按门限归一化后相乘，封顶避免单项过高掩盖其他项
+    q.score = std::min(q.sharpness / cfg.min_sharpness, 4.0) *
+              std::min(static_cast<double>(q.size) / cfg.min_size, 2.0) * q.symmetry;
+    return q;
+}
+
+// 眼部条带左半与右半镜像的归一化相关系数：正脸两眼对称接近 1，侧脸一只眼被遮挡时明显下降
+double FaceQualityGate::symmetry() const {
+    const int top = static_cast<int>(NORM_SIZE * EYE_BAND_TOP);
+    const int bottom = static_cast<int>(NORM_SIZE * EYE_BAND_BOTTOM);
+    const int half = NORM_SIZE / 2;
+
+    double sum_l = 0.0, sum_r = 0.0;
+    for (int y = top; y < bottom; ++y) {
+        const uint8_t* row = norm.ptr<uint8_t>(y);
+        for (int x = 0; x < half; ++x) {
+            sum_l += row[x];
+            sum_r += row[NORM_SIZE - 1 - x];
+        }
+    }
+    const double n = static_cast<double>(bottom - top) * half;
+    const double mean_l = sum_l / n, mean_r = sum_r / n;
+
+    double cov = 0.0, var_l = 0.0, var_r = 0.0;
+    for (int y = top; y < bottom; ++y) {
+        const uint8_t* row = norm.ptr<uint8_t>(y);
+        for (int x = 0; x < half; ++x) {
+            double l = row[x] - mean_l;
+            double r = row[NORM_SIZE - 1 - x] - mean_r;
+            cov += l * r;
+            var_l += l * l;
+            var_r += r * r;
+        }
+    }
+    if (var_l <= 0.0 || var_r <= 0.0) return 0.0;
+    return cov / std::sqrt(var_l * var_r);
+}
+
+static double overlap(const cv::Rect& a, const cv::Rect& b) {
+    int x1 = std::max(a.x, b.x), y1 = std::max(a.y, b.y);
+    int x2 = std::min(a.x + a.width, b.x + b.width), y2 = std::min(a.y + a.height, b.y + b.height);
+    if (x2 <= x1 || y2 <= y1) return 0.0;
+    double inter = static_cast<double>(x2 - x1) * (y2 - y1);
+    return inter / (a.area() + b.area() - inter);
+}
+
+void FaceTracker::update(const cv::Mat& gray, const std::vector<cv::Rect>& faces,
+                         const std::vector<FaceQuality>& quality, uint64_t t_ns) {
+    const size_t existing = tracks.size();
+    std::vector<bool> seen(existing, false);
+
+    for (size_t i = 0; i < faces.size() && i < quality.size(); ++i) {
+        // 贪心关联：重叠最大且本帧还没被占用的轨迹
+        int match = -1;
+        double best_iou = TRACK_MIN_IOU;
+        for (size_t t = 0; t < existing; ++t) {
+            double iou = seen[t] ? 0.0 : overlap(tracks[t].rect, faces[i]);
+            if (iou >= best_iou) {
+                best_iou = iou;
+                match = static_cast<int>(t);
+            }
+        }
+        if (match < 0) {
+            if (tracks.size() >= TRACK_MAX) continue;
+            tracks.emplace_back();
+            tracks.back().id = next_id++;
+            match = static_cast<int>(tracks.size()) - 1;
+        } else {
+            seen[match] = true;
+        }
+
+        Track& track = tracks[match];
+        track.rect = faces[i];
+        track.missed = 0;
+        track.frames++;
+        if (quality[i].ok() && (!track.has_crop || quality[i].score > track.best.score)) {
+            // 换成更好的一张；尺寸相同时复用原缓冲
+            gray(faces[i] & cv::Rect(0, 0, gray.cols, gray.rows)).copyTo(track.crop);
+            track.best = quality[i];
+            track.has_crop = true;
+            track.crop_t_ns = t_ns;
+        }
+    }
+
+    for (size_t t = 0; t < existing; ++t) {
+        if (!seen[t]) tracks[t].missed++;
+    }
+    tracks.erase(std::remove_if(tracks.begin(), tracks.end(),
+                                [](const Track& t) { return t.missed > TRACK_MAX_MISSED; }),
+                 tracks.end());
+}
+
+const FaceTracker::Track* FaceTracker::best() const {
+    const Track* best = nullptr;
+    for (const auto& t : tracks) {
+        if (t.has_crop && (!best || t.best.score > best->best.score)) best = &t;
+    }
+    return best;
+}
+
+void FaceTracker::reset() {
+    tracks.clear();
+}
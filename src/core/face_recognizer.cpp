@@ -1,16 +1,137 @@
 #include "face_recognizer.h"
+#include "metrics.h"
+#include "timeline.h"
+#include <algorithm>
+#include <cstdlib>
 #include <filesystem> 
 
+// 向量库缓存放在图库目录旁边（../source/face.embeddings），目录里只放图片；
+// 图库里的图片被替换后删掉缓存即可重建
+#define EMBEDDING_CACHE_SUFFIX ".embeddings"
+// SFace 推荐的同一人余弦阈值；换算成距离时正好落在调用方沿用的 LBPH 阈值 80 上
+#define EMBEDDING_MATCH_COSINE 0.363
+#define EMBEDDING_MATCH_DISTANCE 80.0
+
+static double embeddingDistance(float similarity) {
+    return (1.0 - similarity) / (1.0 - EMBEDDING_MATCH_COSINE) * EMBEDDING_MATCH_DISTANCE;
+}
+
 bool FaceRecognizerLib::init(const std::string& face_folder) {
-    if (!face_cascade.load("/usr/local/share/opencv4/haarcascades/haarcascade_frontalface_default.xml")) {
-        std::cerr << "unable to load face classifier" << std::endl;
-        return false;
+    const char* kind = std::getenv("ROBO_FACE_DETECTOR");
+    detector = makeFaceDetector(kind ? kind : "haar");
+    if (!detector) return false;
+    folder = face_folder;
+
+    const char* backend = std::getenv("ROBO_FACE_RECOGNIZER");
+    if (backend && std::string(backend) == "embedding") {
+        embedder = std::make_unique<FaceEmbedder>();
+        if (embedder->load()) {
+            gallery = std::make_unique<EmbeddingIndex>(embedder->dim());
+            loadEmbeddingsFromFolder(face_folder);
+            return true;
+        }
+        embedder.reset();
+        std::cerr << "[DEBUG] Face embedding model unavailable, falling back to LBPH.\n";
     }
+
     recognizer = cv::face::LBPHFaceRecognizer::create();
     loadFacesFromFolder(face_folder);
     return true;
 }
 
+void FaceRecognizerLib::loadEmbeddingsFromFolder(const std::string& folder) {
+    if (!std::filesystem::is_directory(folder)) {
+        std::cerr << "none valide path" << folder << std::endl;
+        return;
+    }
+    std::string cache = std::filesystem::path(folder).lexically_normal().string();
+    if (!cache.empty() && cache.back() == '/') cache.pop_back();
+    cache += EMBEDDING_CACHE_SUFFIX;
+    if (gallery->load(cache)) {
+        std::cout << "[INFO] Loaded " << gallery->size() << " cached face embeddings from " << cache << std::endl;
+    }
+
+    // 目录里每张图的大小和修改时间，和缓存里记录的不同就是换过图
+    std::map<std::string, EmbeddingSource> files;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(folder)) {
+        if (!entry.is_regular_file()) continue;
+        EmbeddingSource source;
+        source.size = entry.file_size(ec);
+        source.mtime = static_cast<int64_t>(entry.last_write_time(ec).time_since_epoch().count());
+        files[entry.path().filename().string()] = source;
+    }
+
+    // 图片已删除的行从缓存里去掉
+    size_t removed = 0;
+    std::vector<std::string> stale;
+    for (size_t row = 0; row < gallery->size(); ++row) {
+        const std::string& name = gallery->name(static_cast<int>(row));
+        if (files.count(name) == 0) stale.push_back(name);
+    }
+    for (const auto& name : stale) removed += gallery->remove(name) ? 1 : 0;
+
+    // 只为新增或换过的图片跑模型；换过的图提不出特征时丢掉旧行，不再用旧照片匹配
+    size_t added = 0;
+    std::vector<float> embedding;
+    for (const auto& [filename, source] : files) {
+        int row = gallery->find(filename);
+        if (row >= 0 && gallery->source(row) == source) continue;
+        if (!embedFile(filename, embedding)) {
+            if (row >= 0 && gallery->remove(filename)) removed++;
+            continue;
+        }
+        gallery->add(filename, embedding.data(), source);
+        added++;
+    }
+    if (added + removed > 0) {
+        std::cout << "[INFO] Embedding cache: " << added << " faces embedded, " << removed << " removed" << std::endl;
+        if (!gallery->save(cache)) std::cerr << "[DEBUG] Cannot write embedding cache " << cache << std::endl;
+    }
+    if (gallery->size() >= EMBEDDING_IVF_MIN_ROWS) gallery->buildIvf();
+    std::cout << "loaded " << gallery->size() << " face embeddings (" << gallery->bytesPerRow() << " bytes each)\n";
+}
+
+// 读图库里的一张图，取最大的人脸（检测不到就用整张图）提取特征
+bool FaceRecognizerLib::embedFile(const std::string& filename, std::vector<float>& embedding) {
+    std::string fullpath = (std::filesystem::path(folder) / filename).string();
+    cv::Mat img = cv::imread(fullpath, cv::IMREAD_GRAYSCALE);
+    if (img.empty()) {
+        std::cerr << "cant load images" << fullpath << std::endl;
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(model_mtx);
+    std::vector<cv::Rect> faces = detector->detect(img);
+    auto largest = std::max_element(faces.begin(), faces.end(),
+                                    [](const cv::Rect& a, const cv::Rect& b) { return a.area() < b.area(); });
+    return embedder->embed(largest != faces.end() ? img(*largest) : img, embedding);
+}
+
+// 调用时已持有 model_mtx
+std::pair<std::string, double> FaceRecognizerLib::matchEmbeddings(const cv::Mat& gray, const std::vector<cv::Rect>& faces) {
+    Timeline::Span span("embed_match", "vision", std::to_string(faces.size()) + " faces");
+    std::string best_name;
+    float best = -1.0f;
+    std::vector<float> embedding;
+    for (const auto& face : faces) {
+        if (!embedder->embed(gray(face), embedding)) continue;
+        auto match = gallery->search(embedding.data(), 1);
+        if (!match.empty() && match[0].similarity > best) {
+            best = match[0].similarity;
+            best_name = gallery->name(match[0].row);
+        }
+        std::lock_guard<std::mutex> lock(hot_mtx);
+        if (!hot_gallery) continue;
+        match = hot_gallery->search(embedding.data(), 1);
+        if (!match.empty() && match[0].similarity > best) {
+            best = match[0].similarity;
+            best_name = hot_gallery->name(match[0].row);
+        }
+    }
+    if (best_name.empty()) return {"未知", -1.0};
+    return {best_name, embeddingDistance(best)};
+}
+
 void FaceRecognizerLib::loadFacesFromFolder(const std::string& folder) {
     if (!std::filesystem::is_directory(folder)) {
         std::cerr << "none valide path" << folder << std::endl;
@@ -85,21 +206,134 @@ void FaceRecognizerLib::loadFacesFromFolder(const std::string& folder) {
 // }
 
 std::pair<std::string, double> FaceRecognizerLib::recognize(const std::string& capture_image_path) {
-    cv::Mat img_color = cv::imread(capture_image_path);
-    if (img_color.empty()) {
+    cv::Mat img_gray;
+    {
+        Timeline::Span span("load_image", "vision");
+        img_gray = cv::imread(capture_image_path, cv::IMREAD_GRAYSCALE);
+    }
+    if (img_gray.empty()) {
         std::cerr << "无法读取图像：" << capture_image_path << std::endl;
         return {"未知", -1.0};
     }
+    return recognize(img_gray);
+}
 
+std::pair<std::string, double> FaceRecognizerLib::recognize(const cv::Mat& frame) {
+    static Metrics::Histogram& latency = Metrics::histogram("face_recognize_seconds", "recognize() latency, frame to label");
+    Metrics::ScopedTimer timer(latency);
+    if (frame.empty() || !detector) return {"未知", -1.0};
+
+    std::lock_guard<std::mutex> model_lock(model_mtx);
+    cv::Mat img_gray;
+    std::vector<cv::Rect> faces = detectFaces(frame, img_gray);
+    std::vector<cv::Rect> good;
+    {
+        Timeline::Span span("quality_gate", "vision", std::to_string(faces.size()) + " faces");
+        for (const auto& face : faces) {
+            FaceQuality q = gate.assess(img_gray, face);
+            if (q.ok()) {
+                good.push_back(face);
+            } else {
+                countReject(q.reject);
+            }
+        }
+    }
+    // 模糊、侧脸的裁图匹配出来的距离不可信，宁可报未知让调用方再取一帧
+    if (good.empty()) return {"未知", -1.0};
+    return matchFaces(img_gray, good);
+}
+
+void FaceRecognizerLib::track(const cv::Mat& frame, FaceTracker& tracker, uint64_t t_ns) {
+    if (frame.empty() || !detector) return;
+    std::lock_guard<std::mutex> model_lock(model_mtx);
     cv::Mat img_gray;
-    cv::cvtColor(img_color, img_gray, cv::COLOR_BGR2GRAY);
+    std::vector<cv::Rect> faces = detectFaces(frame, img_gray);
+    std::vector<FaceQuality> quality;
+    quality.reserve(faces.size());
+    {
+        Timeline::Span span("quality_gate", "vision", std::to_string(faces.size()) + " faces");
+        for (const auto& face : faces) {
+            quality.push_back(gate.assess(img_gray, face));
+            if (!quality.back().ok()) countReject(quality.back().reject);
+        }
+    }
+    tracker.update(img_gray, faces, quality, t_ns);
+}
+
+std::pair<std::string, double> FaceRecognizerLib::recognizeCrop(const cv::Mat& crop) {
+    static Metrics::Histogram& latency = Metrics::histogram("face_recognize_seconds", "recognize() latency, frame to label");
+    Metrics::ScopedTimer timer(latency);
+    if (crop.empty()) return {"未知", -1.0};
+    std::lock_guard<std::mutex> model_lock(model_mtx);
+    return matchFaces(crop, {cv::Rect(0, 0, crop.cols, crop.rows)});
+}
+
+// 调用时已持有 model_mtx；gray 可能直接引用 frame
+std::vector<cv::Rect> FaceRecognizerLib::detectFaces(const cv::Mat& frame, cv::Mat& gray) {
+    Timeline::Span span("face_detect", "vision", detector->name());
+    // 摄像头帧本来就是灰度，直接用，不拷贝
+    if (frame.channels() == 1) {
+        gray = frame;
+    } else {
+        cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+    }
+    return detector->detect(gray);
+}
 
-    std::vector<cv::Rect> faces;
-    face_cascade.detectMultiScale(img_gray, faces);
+void FaceRecognizerLib::countReject(FaceQuality::Reject reject) {
+    static Metrics::Counter* rejects[] = {
+        nullptr,
+        &Metrics::counter("face_quality_rejects_total{reason=\"small\"}", "Face crops skipped before matching"),
+        &Metrics::counter("face_quality_rejects_total{reason=\"blur\"}", "Face crops skipped before matching"),
+        &Metrics::counter("face_quality_rejects_total{reason=\"exposure\"}", "Face crops skipped before matching"),
+        &Metrics::counter("face_quality_rejects_total{reason=\"pose\"}", "Face crops skipped before matching"),
+    };
+    Metrics::Counter* c = rejects[static_cast<int>(reject)];
+    if (c) c->inc();
+}
+
+// 调用时已持有 model_mtx
+std::pair<std::string, double> FaceRecognizerLib::matchFaces(const cv::Mat& img_gray, const std::vector<cv::Rect>& faces) {
+    if (gallery) return matchEmbeddings(img_gray, faces);
 
     int best_label = -1;
     double best_confidence = 1000.0;
 
+    std::string hot_name;
+    double hot_confidence = 1000.0;
+    {
+        // 热层只有今天的几十到几百人，绝大多数来访者在这里就能命中
+        std::lock_guard<std::mutex> lock(hot_mtx);
+        if (hot && !hot_label_to_name.empty()) {
+            Timeline::Span span("predict_hot", "vision", std::to_string(faces.size()) + " faces");
+            for (const auto& face : faces) {
+                cv::Mat faceROI = img_gray(face);
+                cv::resize(faceROI, faceROI, cv::Size(200, 200));
+
+                int predicted_label = -1;
+                double confidence = 0.0;
+                hot->predict(faceROI, predicted_label, confidence);
+
+                if (predicted_label != -1 && confidence < best_confidence) {
+                    best_confidence = confidence;
+                    best_label = predicted_label;
+                }
+            }
+            if (best_label != -1) {
+                hot_name = hot_label_to_name[best_label];
+                hot_confidence = best_confidence;
+            }
+        }
+    }
+    // 只有明显更近的热层结果才跳过冷层，否则陌生人只要离某个今天的患者不太远就会被认成他
+    if (!hot_name.empty() && hot_confidence <= hot_threshold) {
+        return {hot_name, hot_confidence};
+    }
+
+    // 热层不够确定：查全量冷层，取两层中更近的一个
+    best_label = -1;
+    best_confidence = 1000.0;
+    Timeline::Span span("predict_cold", "vision", std::to_string(faces.size()) + " faces");
     for (const auto& face : faces) {
         cv::Mat faceROI = img_gray(face);
         cv::resize(faceROI, faceROI, cv::Size(200, 200));
@@ -114,6 +348,9 @@ std::pair<std::string, double> FaceRecognizerLib::recognize(const std::string& c
         }
     }
 
+    if (!hot_name.empty() && hot_confidence < best_confidence) {
+        return {hot_name, hot_confidence};
+    }
     if (best_label != -1) {
         std::string filename = getFaceFileNameFromLabel(best_label);
         return {filename, best_confidence};
@@ -122,6 +359,128 @@ std::pair<std::string, double> FaceRecognizerLib::recognize(const std::string& c
     }
 }
 
+bool FaceRecognizerLib::readFace(const std::string& filename, cv::Mat& face) {
+    std::string fullpath = (std::filesystem::path(folder) / filename).string();
+    face = cv::imread(fullpath, cv::IMREAD_GRAYSCALE);
+    if (face.empty()) {
+        std::cerr << "cant load images" << fullpath << std::endl;
+        return false;
+    }
+    cv::resize(face, face, cv::Size(200, 200));
+    return true;
+}
+
+size_t FaceRecognizerLib::loadHotFaces(const std::vector<std::string>& filenames) {
+    if (gallery) {
+        // 全量向量库检索本来就在亚毫秒级，热层只需补上冷层里还没有的人脸
+        std::map<int, std::string> names;
+        std::unique_ptr<EmbeddingIndex> fresh;
+        std::vector<float> embedding;
+        for (const auto& filename : filenames) {
+            if (!gallery->contains(filename)) {
+                if (!embedFile(filename, embedding)) continue;
+                if (!fresh) fresh = std::make_unique<EmbeddingIndex>(gallery->dim());
+                fresh->add(filename, embedding.data());
+            }
+            names[static_cast<int>(names.size())] = filename;
+        }
+        std::lock_guard<std::mutex> lock(hot_mtx);
+        hot_gallery = std::move(fresh);
+        hot_label_to_name.swap(names);
+        return hot_label_to_name.size();
+    }
+
+    // 在锁外读图训练，最后整体替换
+    std::vector<cv::Mat> images;
+    std::vector<int> labels;
+    std::map<int, std::string> names;
+    for (const auto& filename : filenames) {
+        cv::Mat img;
+        if (!readFace(filename, img)) continue;
+        int label = static_cast<int>(images.size());
+        images.push_back(img);
+        labels.push_back(label);
+        names[label] = filename;
+    }
+
+    cv::Ptr<cv::face::LBPHFaceRecognizer> model;
+    if (!images.empty()) {
+        model = cv::face::LBPHFaceRecognizer::create();
+        model->train(images, labels);
+    }
+
+    std::lock_guard<std::mutex> lock(hot_mtx);
+    hot = model;
+    hot_label_to_name.swap(names);
+    return hot_label_to_name.size();
+}
+
+size_t FaceRecognizerLib::addHotFaces(const std::vector<std::string>& filenames) {
+    std::vector<std::string> fresh;
+    {
+        std::lock_guard<std::mutex> lock(hot_mtx);
+        for (const auto& filename : filenames) {
+            bool known = false;
+            for (const auto& kv : hot_label_to_name) {
+                if (kv.second == filename) { known = true; break; }
+            }
+            if (!known) fresh.push_back(filename);
+        }
+    }
+    if (fresh.empty()) return hotSize();
+
+    if (gallery) {
+        std::vector<float> embedding;
+        for (const auto& filename : fresh) {
+            bool known = gallery->contains(filename);
+            if (!known && !embedFile(filename, embedding)) continue;
+            std::lock_guard<std::mutex> lock(hot_mtx);
+            if (!known) {
+                if (!hot_gallery) hot_gallery = std::make_unique<EmbeddingIndex>(gallery->dim());
+                hot_gallery->add(filename, embedding.data());
+            }
+            int next = hot_label_to_name.empty() ? 0 : hot_label_to_name.rbegin()->first + 1;
+            hot_label_to_name[next] = filename;
+        }
+        return hotSize();
+    }
+
+    std::vector<cv::Mat> images;
+    std::vector<std::string> names;
+    for (const auto& filename : fresh) {
+        cv::Mat img;
+        if (!readFace(filename, img)) continue;
+        images.push_back(img);
+        names.push_back(filename);
+    }
+    if (images.empty()) return hotSize();
+
+    std::lock_guard<std::mutex> lock(hot_mtx);
+    int next = hot_label_to_name.empty() ? 0 : hot_label_to_name.rbegin()->first + 1;
+    std::vector<int> labels;
+    for (size_t i = 0; i < names.size(); ++i) {
+        labels.push_back(next + static_cast<int>(i));
+        hot_label_to_name[labels.back()] = names[i];
+    }
+    // LBPH 支持增量 update，不必重训已有的直方图
+    if (!hot) {
+        hot = cv::face::LBPHFaceRecognizer::create();
+        hot->train(images, labels);
+    } else {
+        hot->update(images, labels);
+    }
+    return hot_label_to_name.size();
+}
+
+void FaceRecognizerLib::setDetector(std::unique_ptr<FaceDetector> detector) {
+    this->detector = std::move(detector);
+}
+
+size_t FaceRecognizerLib::hotSize() {
+    std::lock_guard<std::mutex> lock(hot_mtx);
+    return hot_label_to_name.size();
+}
+
 std::string FaceRecognizerLib::getFaceFileNameFromLabel(int label) {
     if (label_to_name.count(label)) {
         return label_to_name[label];
@@ -0,0 +1,239 @@
+#include "keyword_spotter.h"
+#include <sndfile.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+
+// 说话开始前保留的特征帧数（10ms/帧）
+#define HISTORY_FRAMES 20
+// 单句最长 3 秒，超过即强制匹配
+#define MAX_UTTERANCE_FRAMES 300
+// 最优词需比次优词距离小这个比例才认为可信
+#define MATCH_MARGIN 0.9f
+
+static constexpr size_t DIM = MfccExtractor::NUM_COEFFS;
+
+KeywordSpotter::KeywordSpotter(const VadConfig& vadConfig, float threshold)
+    : vad(vadConfig), threshold(threshold) {}
+
+std::vector<std::string> KeywordSpotter::vocabularyFromNav(const nlohmann::json& navJson) {
+    std::vector<std::string> words;
+    for (auto it = navJson.begin(); it != navJson.end(); ++it) {
+        words.push_back(it.key());
+    }
+    return words;
+}
+
+std::string KeywordSpotter::folderNameFor(const std::string& keyword) {
+    std::string name;
+    for (char c : keyword) {
+        bool alnum = std::isalnum(static_cast<unsigned char>(c));
+        if (alnum) {
+            name += c;
+        } else if (!name.empty() && name.back() != '_') {
+            name += '_';
+        }
+    }
+    while (!name.empty() && name.back() == '_') name.pop_back();
+    return name;
+}
+
+size_t KeywordSpotter::loadTemplates(const std::string& folder, const std::vector<std::string>& vocabulary) {
+    namespace fs = std::filesystem;
+    for (const auto& word : vocabulary) {
+        fs::path dir = fs::path(folder) / folderNameFor(word);
+        if (!fs::is_directory(dir)) {
+            std::cerr << "[DEBUG] No voice templates for: " << word << " (" << dir.string() << ")\n";
+            continue;
+        }
+        for (const auto& entry : fs::directory_iterator(dir)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".wav") {
+                enroll(word, entry.path().string());
+            }
+        }
+    }
+    std::cout << "[INFO] Loaded " << templates.size() << " voice templates\n";
+    return templates.size();
+}
+
+bool KeywordSpotter::enroll(const std::string& keyword, const std::string& wavPath) {
+    SF_INFO info{};
+    SNDFILE* file = sf_open(wavPath.c_str(), SFM_READ, &info);
+    if (!file) {
+        std::cerr << "[DEBUG] Failed to open voice template: " << wavPath << "\n";
+        return false;
+    }
+    if (info.samplerate != static_cast<int>(MfccExtractor::SAMPLE_RATE) || info.channels != 1) {
+        std::cerr << "[DEBUG] Voice template must be 16kHz mono: " << wavPath << "\n";
+        sf_close(file);
+        return false;
+    }
+
+    std::vector<short> pcm(static_cast<size_t>(info.frames));
+    sf_count_t frames = sf_readf_short(file, pcm.data(), info.frames);
+    sf_close(file);
+    if (frames <= 0) return false;
+
+    // 与在线流程一致：只取 VAD 判定的语音段
+    MfccExtractor extractor;
+    VoiceActivityDetector detector(vad.config());
+    std::vector<float> feats, frame;
+    bool speaking = false;
+    size_t start = 0, end = 0;
+    for (size_t off = 0; off + VoiceActivityDetector::FRAME_SAMPLES <= static_cast<size_t>(frames);
+         off += VoiceActivityDetector::FRAME_SAMPLES) {
+        extractor.push(pcm.data() + off, VoiceActivityDetector::FRAME_SAMPLES, feats);
+        auto event = detector.processFrame(pcm.data() + off);
+        size_t n = feats.size() / DIM;
+        if (event == VoiceActivityDetector::Event::SpeechStart && !speaking) {
+            speaking = true;
+            start = n > HISTORY_FRAMES ? n - HISTORY_FRAMES : 0;
+        } else if (event == VoiceActivityDetector::Event::SpeechEnd) {
+            end = n;
+            break;
+        }
+    }
+    size_t total = feats.size() / DIM;
+    if (!speaking) {
+        start = 0;
+        end = total;
+    } else if (end == 0) {
+        end = total;
+    } else {
+        end -= std::min<size_t>(vad.config().hangover_frames, (end - start) / 2);
+    }
+    if (end <= start) return false;
+
+    Template t;
+    t.keyword = keyword;
+    t.feats.assign(feats.begin() + start * DIM, feats.begin() + end * DIM);
+    normalize(t.feats);
+    templates.push_back(std::move(t));
+    return true;
+}
+
+void KeywordSpotter::reset() {
+    mfcc.reset();
+    vad.reset();
+    history.clear();
+    utterance.clear();
+    capturing = false;
+    finished = false;
+    last_match.clear();
+}
+
+void KeywordSpotter::normalize(std::vector<float>& feats) {
+    // 倒谱均值归一化，抵消麦克风/环境的信道差异
+    size_t n = feats.size() / DIM;
+    if (n == 0) return;
+    float mean[DIM] = {};
+    for (size_t i = 0; i < n; ++i)
+        for (size_t d = 0; d < DIM; ++d) mean[d] += feats[i * DIM + d];
+    for (size_t d = 0; d < DIM; ++d) mean[d] /= n;
+    for (size_t i = 0; i < n; ++i)
+        for (size_t d = 0; d < DIM; ++d) feats[i * DIM + d] -= mean[d];
+}
+
+float KeywordSpotter::dtw(const std::vector<float>& a, const std::vector<float>& b) {
+    size_t n = a.size() / DIM, m = b.size() / DIM;
+    const float inf = std::numeric_limits<float>::infinity();
+    if (n == 0 || m == 0 || n > 2 * m || m > 2 * n) return inf;
+
+    std::vector<float> prev(m + 1, inf), cur(m + 1, inf);
+    prev[0] = 0.0f;
+    for (size_t i = 1; i <= n; ++i) {
+        cur[0] = inf;
+        const float* x = &a[(i - 1) * DIM];
+        for (size_t j = 1; j <= m; ++j) {
+            const float* y = &b[(j - 1) * DIM];
+            float d = 0.0f;
+            for (size_t k = 0; k < DIM; ++k) {
+                float diff = x[k] - y[k];
+                d += diff * diff;
+            }
+            cur[j] = std::sqrt(d) + std::min({prev[j], cur[j - 1], prev[j - 1]});
+        }
+        std::swap(prev, cur);
+    }
+    return prev[m] / (n + m);
+}
+
+std::string KeywordSpotter::match(std::vector<float>& feats, float& distance) const {
+    normalize(feats);
+
+    std::string best_word;
+    float best = std::numeric_limits<float>::infinity();
+    float second = best;
+    for (const auto& t : templates) {
+        float d = dtw(feats, t.feats);
+        if (d < best) {
+            if (t.keyword != best_word) second = best;
+            best = d;
+            best_word = t.keyword;
+        } else if (d < second && t.keyword != best_word) {
+            second = d;
+        }
+    }
+
+    distance = best;
+    if (best_word.empty() || best > threshold || best > MATCH_MARGIN * second) return "";
+    return best_word;
+}
+
+void KeywordSpotter::feed(const int16_t* samples, size_t count) {
+    const size_t step = VoiceActivityDetector::FRAME_SAMPLES;
+    for (size_t off = 0; off + step <= count; off += step) {
+        scratch.clear();
+        mfcc.push(samples + off, step, scratch);
+        auto event = vad.processFrame(samples + off);
+
+        if (!capturing) {
+            history.insert(history.end(), scratch.begin(), scratch.end());
+            if (history.size() > HISTORY_FRAMES * DIM) {
+                history.erase(history.begin(), history.end() - HISTORY_FRAMES * DIM);
+            }
+            if (event == VoiceActivityDetector::Event::SpeechStart) {
+                capturing = true;
+                utterance.swap(history);
+                history.clear();
+            }
+            continue;
+        }
+
+        utterance.insert(utterance.end(), scratch.begin(), scratch.end());
+        size_t frames = utterance.size() / DIM;
+        if (event != VoiceActivityDetector::Event::SpeechEnd && frames < MAX_UTTERANCE_FRAMES) continue;
+
+        // 去掉结尾的静音拖尾
+        if (event == VoiceActivityDetector::Event::SpeechEnd) {
+            size_t tail = std::min<size_t>(vad.config().hangover_frames, frames / 2);
+            utterance.resize((frames - tail) * DIM);
+        }
+
+        float distance = 0.0f;
+        last_match = match(utterance, distance);
+        finished = true;
+        capturing = false;
+        utterance.clear();
+        if (!last_match.empty()) {
+            std::cout << "[INFO] Keyword detected: " << last_match << " (distance " << distance << ")\n";
+            if (callback) callback(last_match, distance);
+        }
+    }
+}
+
+std::string KeywordSpotter::listenOnce(AudioCapture& capture, int timeout_ms) {
+    reset();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    int16_t frame[AudioCapture::FRAME_SAMPLES];
+
+    while (!finished && std::chrono::steady_clock::now() < deadline) {
+        if (!capture.isRunning() && !capture.start()) return "";
+        if (capture.waitFrame(frame, 100)) feed(frame, AudioCapture::FRAME_SAMPLES);
+    }
+    return last_match;
+}
@@ -0,0 +1,147 @@
+#include "mfcc.h"
+#include <algorithm>
+#include <cmath>
+
+#define PRE_EMPHASIS 0.97f
+#define MEL_LOW_HZ 20.0f
+#define MEL_HIGH_HZ 7600.0f
+
+static float hzToMel(float hz) { return 2595.0f * std::log10(1.0f + hz / 700.0f); }
+static float melToHz(float mel) { return 700.0f * (std::pow(10.0f, mel / 2595.0f) - 1.0f); }
+
+MfccExtractor::MfccExtractor() : prev_sample(0.0f) {
+    const float pi = static_cast<float>(M_PI);
+
+    window.resize(WINDOW);
+    for (size_t i = 0; i < WINDOW; ++i) {
+        window[i] = 0.54f - 0.46f * std::cos(2.0f * pi * i / (WINDOW - 1));
+    }
+
+    // 每级旋转因子连续存放，蝶形内层循环按 j 顺序访问，编译器可直接向量化
+    twiddle_re.resize(FFT_SIZE - 1);
+    twiddle_im.resize(FFT_SIZE - 1);
+    for (size_t h = 1; h < FFT_SIZE; h *= 2) {
+        for (size_t j = 0; j < h; ++j) {
+            float angle = -pi * j / h;
+            twiddle_re[h - 1 + j] = std::cos(angle);
+            twiddle_im[h - 1 + j] = std::sin(angle);
+        }
+    }
+
+    size_t bits = 0;
+    while ((1u << bits) < FFT_SIZE) ++bits;
+    bitrev.resize(FFT_SIZE);
+    for (size_t i = 0; i < FFT_SIZE; ++i) {
+        size_t r = 0;
+        for (size_t b = 0; b < bits; ++b) r |= ((i >> b) & 1) << (bits - 1 - b);
+        bitrev[i] = static_cast<uint16_t>(r);
+    }
+
+    // 三角 Mel 滤波器组
+    const size_t bins = FFT_SIZE / 2 + 1;
+    mel_bank.assign(NUM_FILTERS * bins, 0.0f);
+    float mel_low = hzToMel(MEL_LOW_HZ), mel_high = hzToMel(MEL_HIGH_HZ);
+    std::vector<float> centers(NUM_FILTERS + 2);
+    for (size_t m = 0; m < NUM_FILTERS + 2; ++m) {
+        float hz = melToHz(mel_low + (mel_high - mel_low) * m / (NUM_FILTERS + 1));
+        centers[m] = hz * FFT_SIZE / SAMPLE_RATE;
+    }
+    for (size_t m = 0; m < NUM_FILTERS; ++m) {
+        for (size_t k = 0; k < bins; ++k) {
+            float w = 0.0f;
+            if (k > centers[m] && k <= centers[m + 1]) {
+                w = (k - centers[m]) / (centers[m + 1] - centers[m]);
+            } else if (k > centers[m + 1] && k < centers[m + 2]) {
+                w = (centers[m + 2] - k) / (centers[m + 2] - centers[m + 1]);
+            }
+            mel_bank[m * bins + k] = w;
+        }
+    }
+
+    dct.resize(NUM_COEFFS * NUM_FILTERS);
+    for (size_t c = 0; c < NUM_COEFFS; ++c) {
+        for (size_t m = 0; m < NUM_FILTERS; ++m) {
+            dct[c * NUM_FILTERS + m] = std::cos(pi * c * (m + 0.5f) / NUM_FILTERS);
+        }
+    }
+
+    pending.reserve(WINDOW + HOP);
+}
+
+void MfccExtractor::reset() {
+    pending.clear();
+    prev_sample = 0.0f;
+}
+
+void MfccExtractor::fft(float* r, float* i) const {
+    for (size_t k = 0; k < FFT_SIZE; ++k) {
+        size_t j = bitrev[k];
+        if (j > k) {
+            std::swap(r[k], r[j]);
+            std::swap(i[k], i[j]);
+        }
+    }
+
+    for (size_t h = 1; h < FFT_SIZE; h *= 2) {
+        const float* wr = &twiddle_re[h - 1];
+        const float* wi = &twiddle_im[h - 1];
+        for (size_t base = 0; base < FFT_SIZE; base += 2 * h) {
+            float* __restrict ar = r + base;
+            float* __restrict ai = i + base;
+            float* __restrict br = r + base + h;
+            float* __restrict bi = i + base + h;
+            for (size_t j = 0; j < h; ++j) {
+                float tr = br[j] * wr[j] - bi[j] * wi[j];
+                float ti = br[j] * wi[j] + bi[j] * wr[j];
+                br[j] = ar[j] - tr;
+                bi[j] = ai[j] - ti;
+                ar[j] += tr;
+                ai[j] += ti;
+            }
+        }
+    }
+}
+
+void MfccExtractor::computeFrame(float* coeffs) {
+    for (size_t k = 0; k < WINDOW; ++k) re[k] = pending[k] * window[k];
+    std::fill(re + WINDOW, re + FFT_SIZE, 0.0f);
+    std::fill(im, im + FFT_SIZE, 0.0f);
+    fft(re, im);
+
+    const size_t bins = FFT_SIZE / 2 + 1;
+    float power[bins];
+    for (size_t k = 0; k < bins; ++k) power[k] = re[k] * re[k] + im[k] * im[k];
+
+    float log_mel[NUM_FILTERS];
+    for (size_t m = 0; m < NUM_FILTERS; ++m) {
+        const float* w = &mel_bank[m * bins];
+        float e = 0.0f;
+        for (size_t k = 0; k < bins; ++k) e += w[k] * power[k];
+        log_mel[m] = std::log(e + 1e-6f);
+    }
+
+    for (size_t c = 0; c < NUM_COEFFS; ++c) {
+        const float* d = &dct[c * NUM_FILTERS];
+        float sum = 0.0f;
+        for (size_t m = 0; m < NUM_FILTERS; ++m) sum += d[m] * log_mel[m];
+        coeffs[c] = sum;
+    }
+}
+
+size_t MfccExtractor::push(const int16_t* samples, size_t count, std::vector<float>& out) {
+    size_t frames = 0;
+    for (size_t n = 0; n < count; ++n) {
+        float x = samples[n] / 32768.0f;
+        pending.push_back(x - PRE_EMPHASIS * prev_sample);
+        prev_sample = x;
+
+        if (pending.size() == WINDOW) {
+            size_t off = out.size();
+            out.resize(off + NUM_COEFFS);
+            computeFrame(&out[off]);
+            pending.erase(pending.begin(), pending.begin() + HOP);
+            ++frames;
+        }
+    }
+    return frames;
+}
@@ -0,0 +1,98 @@
+#include "motion_arbiter.h"
+#include "clock.h"
+#include <algorithm>
+
+#define SLOT_ACTIVE 0x80000000u
+#define SLOT_HOLD   0x40000000u
+#define SLOT_DUTY   0x0000FFFFu
+
+static const char* SOURCE_NAMES[] = {"nav", "teleop", "pause", "emergency", "none"};
+
+const char* motionSourceName(MotionSource source) {
+    int i = static_cast<int>(source);
+    if (i < 0 || i > static_cast<int>(MotionSource::Count)) i = static_cast<int>(MotionSource::Count);
+    return SOURCE_NAMES[i];
+}
+
+MotionArbiter::MotionArbiter(SpeedGovernor& governor) : governor(governor) {
+    for (auto& slot : slots) slot.store(0);
+}
+
+uint32_t MotionArbiter::pack(bool hold, int duty) {
+    duty = std::clamp(duty, -100, 100);
+    return SLOT_ACTIVE | (hold ? SLOT_HOLD : 0u) | (static_cast<uint16_t>(static_cast<int16_t>(duty)) & SLOT_DUTY);
+}
+
+void MotionArbiter::drive(MotionSource source, int duty) {
+    slots[static_cast<int>(source)].store(pack(false, duty), std::memory_order_release);
+}
+
+void MotionArbiter::hold(MotionSource source) {
+    slots[static_cast<int>(source)].store(pack(true, 0), std::memory_order_release);
+}
+
+void MotionArbiter::release(MotionSource source) {
+    slots[static_cast<int>(source)].store(0, std::memory_order_release);
+}
+
+bool MotionArbiter::active(MotionSource source) const {
+    return slots[static_cast<int>(source)].load(std::memory_order_acquire) & SLOT_ACTIVE;
+}
+
+bool MotionArbiter::holding(MotionSource source) const {
+    return slots[static_cast<int>(source)].load(std::memory_order_acquire) & SLOT_HOLD;
+}
+
+int MotionArbiter::setpoint(MotionSource source) const {
+    uint32_t v = slots[static_cast<int>(source)].load(std::memory_order_acquire);
+    return static_cast<int16_t>(v & SLOT_DUTY);
+}
+
+int MotionArbiter::tick(Motor& motor) {
+    if (ticking.exchange(true, std::memory_order_acquire)) return last_applied.load(std::memory_order_relaxed);
+
+    int winner = static_cast<int>(MotionSource::Count);
+    uint32_t cmd = 0;
+    for (int i = static_cast<int>(MotionSource::Count) - 1; i >= 0; --i) {
+        uint32_t v = slots[i].load(std::memory_order_acquire);
+        if (v & SLOT_ACTIVE) {
+            winner = i;
+            cmd = v;
+            break;
+        }
+    }
+
+    int duty = static_cast<int16_t>(cmd & SLOT_DUTY);
+    int applied = 0;
+    if (!(cmd & SLOT_ACTIVE) || (cmd & SLOT_HOLD) || duty == 0) {
+        // 停车后从静止重新起步，避免恢复时直接跳到原占空比
+        motor.stop();
+        governor.reset();
+    } else if (duty > 0) {
+        // 超声波朝前，只有前进受障碍物限速
+        applied = governor.update(duty);
+        motor.forward(applied);
+    } else {
+        governor.reset();
+        motor.backward(-duty);
+        applied = duty;
+    }
+
+    last_winner.store(winner, std::memory_order_relaxed);
+    last_applied.store(applied, std::memory_order_relaxed);
+    last_tick_ns.store(Clock::nowNs(), std::memory_order_relaxed);
+    ticking.store(false, std::memory_order_release);
+    return applied;
+}
+
+MotionSource MotionArbiter::winner() const {
+    return static_cast<MotionSource>(last_winner.load(std::memory_order_relaxed));
+}
+
+int MotionArbiter::applied() const {
+    return last_applied.load(std::memory_order_relaxed);
+}
+
+uint64_t MotionArbiter::sinceLastTickNs() const {
+    return Clock::nowNs() - last_tick_ns.load(std::memory_order_relaxed);
+}
@@ -1,85 +1,194 @@
 #include "nav.h"
-#include <iostream>
+#include "audio_engine.h"
+#include "clock.h"
+#include "trace.h"
+#include "log.h"
+#include "metrics.h"
+#include "timeline.h"
+#include "thread_profile.h"
 #include <chrono>
 #include <thread>
 #include <cmath>
 #include <fstream>
+#include <memory>
 #include <json.hpp>
 
 namespace Nav {
 
 std::atomic<bool> startNavigation(false);
-std::atomic<bool> pauseNavigation(false);
-std::mutex navMutex;
-std::condition_variable navCV;
-
-void checkPause(Motor& motor) {
-    std::unique_lock<std::mutex> lock(navMutex);
-    while (pauseNavigation.load()) {
-        motor.stop();
-        std::cout << "⏸️ 电机停止，导航已挂起...\n";
-        navCV.wait(lock);
-        std::cout << "▶️ 导航已恢复，继续执行...\n";
-        motor.forward(30);
+SpeedGovernor speedGovernor;
+MotionArbiter motion(speedGovernor);
+
+static std::mutex progressMutex;
+static Progress current;
+
+Progress progress() {
+    std::lock_guard<std::mutex> lock(progressMutex);
+    return current;
+}
+
+static void setProgress(int step, const std::string& action, int value) {
+    std::lock_guard<std::mutex> lock(progressMutex);
+    current.step = step;
+    current.action = action;
+    current.value = value;
+}
+
+// 导航被更高优先级来源接管（暂停、急停、遥控）期间控制周期照常运行，电机由仲裁器保持，
+// 这里只在接管开始/结束时记录一次
+static bool suspended = false;
+static std::unique_ptr<Timeline::Span> suspendedSpan;
+
+static void trackSuspend() {
+    MotionSource winner = motion.winner();
+    bool now = winner != MotionSource::Nav;
+    if (now == suspended) return;
+    suspended = now;
+    if (now) {
+        Trace::nav(Trace::NavEvent::Pause);
+        LOG_INFO("⏸️ 导航已挂起（{}）...", motionSourceName(winner));
+        suspendedSpan.reset(new Timeline::Span("paused", "nav", motionSourceName(winner)));
+    } else {
+        suspendedSpan.reset();
+        LOG_INFO("▶️ 导航已恢复，继续执行...");
+        Trace::nav(Trace::NavEvent::Resume);
     }
 }
 
+// 导航撤销请求并停车；有遥控等其他来源时交给它们
+static void releaseMotion(Motor& motor) {
+    motion.release(MotionSource::Nav);
+    motion.tick(motor);
+    if (suspended) {
+        suspended = false;
+        suspendedSpan.reset();
+        Trace::nav(Trace::NavEvent::Resume);
+    }
+}
+
+// 控制周期计时
+static const Metrics::Loop& tickLoop() {
+    static const Metrics::Loop& loop = Metrics::loop("nav_tick", NAV_TICK_MS * 1000000ull, "Navigation control tick");
+    return loop;
+}
+
+// 障碍物挡路期间循环播放 "hold" 提示音
+static bool holdPromptOn = false;
+
+static void setHoldPrompt(bool on) {
+    if (on == holdPromptOn) return;
+    holdPromptOn = on;
+    if (on) {
+        AudioEngine::instance().loop("hold");
+    } else {
+        AudioEngine::instance().stop("hold");
+    }
+}
+
+int driveTick(Motor& motor, int targetDuty) {
+    // 设定值留在槽位里，暂停撤销后下一个周期原样生效
+    motion.drive(MotionSource::Nav, targetDuty);
+    int duty = motion.tick(motor);
+    trackSuspend();
+    if (suspended) {
+        setHoldPrompt(false);
+        return 0;
+    }
+    setHoldPrompt(speedGovernor.blocked());
+    return duty;
+}
+
 void moveForward(Motor& motor, int duration_ms) {
-    std::cout << "⬆️  前进 " << duration_ms << " 毫秒...\n";
-    motor.forward(40);
-    int elapsed = 0;
-    while (elapsed < duration_ms) {
-        checkPause(motor);
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        elapsed += 100;
+    const int duty = 40;
+    LOG_INFO("⬆️  前进 {} 毫秒...", duration_ms);
+    // 按实际占空比折算行进进度，减速/停车期间不计入前进时间
+    float progress = 0.0f;
+    Metrics::LoopTimer timer(tickLoop());
+    while (progress < duration_ms && startNavigation.load()) {
+        timer.tick();
+        int applied = driveTick(motor, duty);
+        Clock::sleepFor(std::chrono::milliseconds(NAV_TICK_MS));
+        progress += NAV_TICK_MS * static_cast<float>(applied) / duty;
     }
-    motor.stop();
-    std::cout << "🛑 前进结束\n";
+    releaseMotion(motor);
+    LOG_INFO("🛑 前进结束");
+}
+
+// 两次航向读数之间转过的角度，跨越 0/360 度时取最短的一边
+static float headingStep(float from, float to) {
+    float d = to - from;
+    while (d > 180.0f) d -= 360.0f;
+    while (d < -180.0f) d += 360.0f;
+    return d;
 }
 
 void turnLeft(Motor& motor, Servo& servo, YawTracker& yaw, float angle) {
-    servo.turn('L', 45);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-    yaw.start(50);
-    float startAngle = yaw.getAngle();
+    {
+        Timeline::Span span("servo_settle", "nav");
+        servo.turn('L', 45);
+        Clock::sleepFor(std::chrono::milliseconds(500));
+    }
+    // 逐周期累计转角，航向读数回绕时不会提前结束
+    float lastAngle = yaw.getAngle();
+    float turned = 0.0f;
     
-    std::cout << "↪️ 左转 " << angle << " 度...\n";
-    motor.forward(40);
-    while (true) {
-        checkPause(motor);
-        float currentAngle = yaw.getAngle();
-        if (std::abs(currentAngle - startAngle) >= angle) {
-            break;
+    LOG_INFO("↪️ 左转 {} 度...", angle);
+    Metrics::LoopTimer timer(tickLoop());
+    {
+        Timeline::Span converge("turn_converge", "nav", std::to_string(static_cast<int>(angle)) + " deg");
+        while (true) {
+            if (!startNavigation.load()) break;
+            timer.tick();
+            float currentAngle = yaw.getAngle();
+            // 挂起期间（遥控接管、被推动）的航向变化不算转弯进度，只跟上读数
+            if (!suspended) turned += headingStep(lastAngle, currentAngle);
+            lastAngle = currentAngle;
+            if (std::abs(turned) >= angle) {
+                break;
+            }
+            driveTick(motor, 40);
+            Clock::sleepFor(std::chrono::milliseconds(NAV_TICK_MS));
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
     
-    motor.stop();
-    std::cout << "✅ 左转完成\n";
+    releaseMotion(motor);
+    LOG_INFO("✅ 左转完成");
     servo.center();
 }
 
 
 
 void turnRight(Motor& motor, Servo& servo, YawTracker& yaw, float angle) {
-    servo.turn('R', 45);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-    yaw.start(40);
-    float startAngle = yaw.getAngle();
+    {
+        Timeline::Span span("servo_settle", "nav");
+        servo.turn('R', 45);
+        Clock::sleepFor(std::chrono::milliseconds(500));
+    }
+    // 逐周期累计转角，航向读数回绕时不会提前结束
+    float lastAngle = yaw.getAngle();
+    float turned = 0.0f;
     
-    std::cout << "↩️ 右转 " << angle << " 度...\n";
-    motor.forward(50);
-    while (true) {
-        checkPause(motor);
-        float currentAngle = yaw.getAngle();
-        if (std::abs(currentAngle - startAngle) >= angle) {
-            break;
+    LOG_INFO("↩️ 右转 {} 度...", angle);
+    Metrics::LoopTimer timer(tickLoop());
+    {
+        Timeline::Span converge("turn_converge", "nav", std::to_string(static_cast<int>(angle)) + " deg");
+        while (true) {
+            if (!startNavigation.load()) break;
+            timer.tick();
+            float currentAngle = yaw.getAngle();
+            // 挂起期间（遥控接管、被推动）的航向变化不算转弯进度，只跟上读数
+            if (!suspended) turned += headingStep(lastAngle, currentAngle);
+            lastAngle = currentAngle;
+            if (std::abs(turned) >= angle) {
+                break;
+            }
+            driveTick(motor, 50);
+            Clock::sleepFor(std::chrono::milliseconds(NAV_TICK_MS));
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
     
-    motor.stop();
-    std::cout << "✅ 右转完成\n";
+    releaseMotion(motor);
+    LOG_INFO("✅ 右转完成");
     servo.center();
 }
 
@@ -89,26 +198,53 @@ void navigationThread(Motor* motor, Servo* servo, YawTracker* yaw, const std::st
     Motor& m = *motor;
     Servo& s = *servo;
     YawTracker& y = *yaw;
+    // 返回后调用方还在这个线程上播提示音、写行程记录，不能留在实时优先级和控制核心上
+    ThreadProfile::Scope profile(ThreadProfile::Role::Nav);
 
-    std::cout << "\n🚦 开始导航 → 目标科室: " << target << "\n";
+    LOG_INFO("\n🚦 开始导航 → 目标科室: {}", target);
 
+    // 无效目标也记一次开始和未完成的结束，回放记录里不留下没有结束的行程
     if (!navJson.contains(target)) {
-        std::cerr << "❌ 未找到目标科室 \"" << target << "\" 的导航路径\n";
+        LOG_ERROR("❌ 未找到目标科室 \"{}\" 的导航路径", target);
+        Trace::nav(Trace::NavEvent::Start, 0, target);
+        Trace::nav(Trace::NavEvent::End, 0);
         return;
     }
 
     if (!navJson[target].contains("path") || !navJson[target]["path"].is_array()) {
-        std::cerr << "❌ \"" << target << "\" 的导航数据无效或缺少 path\n";
+        LOG_ERROR("❌ \"{}\" 的导航数据无效或缺少 path", target);
+        Trace::nav(Trace::NavEvent::Start, 0, target);
+        Trace::nav(Trace::NavEvent::End, 0);
         return;
     }
 
+    // 路径随记录一起保存，回放时不依赖当时的 nav.json
+    Trace::nav(Trace::NavEvent::Start, 0, target + "\n" + navJson[target]["path"].dump());
+    {
+        std::lock_guard<std::mutex> lock(progressMutex);
+        current = Progress();
+        current.target = target;
+        current.steps = static_cast<int>(navJson[target]["path"].size());
+    }
+    bool completed = true;
+    int index = 0;
     for (const auto& step : navJson[target]["path"]) {
+        if (!startNavigation.load()) {
+            LOG_INFO("⏹️ 导航已取消");
+            completed = false;
+            break;
+        }
         if (!step.contains("action") || !step.contains("value")) {
-            std::cerr << "❌ 导航步骤格式错误，缺少 action 或 value\n";
+            LOG_ERROR("❌ 导航步骤格式错误，缺少 action 或 value");
             continue;
         }
         std::string action = step["action"];
         int value = step["value"];
+        setProgress(index++, action, value);
+        Trace::nav(Trace::NavEvent::Step, value, action);
+        Timeline::Span stepSpan(action, "nav", std::to_string(value));
+        Metrics::ScopedTimer stepTimer(Metrics::histogram("nav_step_seconds{action=\"" + action + "\"}",
+                                                          "Duration of one navigation step"));
 
         if (action == "moveForward") {
             moveForward(m, value);
@@ -117,11 +253,21 @@ void navigationThread(Motor* motor, Servo* servo, YawTracker* yaw, const std::st
         } else if (action == "turnRight") {
             turnRight(m, s, y, value);
         } else {
-            std::cerr << "❌ 未知导航动作: " << action << "\n";
+            LOG_ERROR("❌ 未知导航动作: {}", action);
         }
     }
 
-    std::cout << "🏁 导航完成！\n";
+    setHoldPrompt(false);
+    releaseMotion(m);
+    setProgress(-1, "", 0);
+    // 最后一步执行中途被取消也算未完成
+    if (!startNavigation.load()) completed = false;
+    Trace::nav(Trace::NavEvent::End, completed ? 1 : 0);
+    if (completed) {
+        LOG_INFO("🏁 导航完成！");
+    } else {
+        LOG_INFO("⏹️ 导航未完成，已停车（{}）", target);
+    }
 }
 
 }  // namespace Nav
\ No newline at end of file
@@ -0,0 +1,218 @@
+#include "patient_search.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+
+std::vector<uint32_t> PatientSearchIndex::normalize(const std::string& name) {
+    std::vector<uint32_t> out;
+    out.reserve(name.size());
+    bool space = true;   // 折叠开头和连续的分隔符
+    for (size_t i = 0; i < name.size();) {
+        unsigned char c = name[i];
+        uint32_t cp;
+        int len;
+        if (c < 0x80)      { cp = c;        len = 1; }
+        else if (c < 0xE0) { cp = c & 0x1F; len = 2; }
+        else if (c < 0xF0) { cp = c & 0x0F; len = 3; }
+        else               { cp = c & 0x07; len = 4; }
+        if (i + len > name.size()) break;
+        for (int j = 1; j < len; ++j) cp = (cp << 6) | (name[i + j] & 0x3F);
+        i += len;
+
+        if (cp < 0x80) {
+            if (cp >= 'A' && cp <= 'Z') cp += 'a' - 'A';
+            bool word = (cp >= 'a' && cp <= 'z') || (cp >= '0' && cp <= '9');
+            if (!word) {
+                if (!space) out.push_back(' ');
+                space = true;
+                continue;
+            }
+        } else if (cp == 0x3000 || cp == 0xB7 || cp == 0x30FB) {
+            // 全角空格、中间点（少数民族/外文译名）
+            if (!space) out.push_back(' ');
+            space = true;
+            continue;
+        }
+        out.push_back(cp);
+        space = false;
+    }
+    if (!out.empty() && out.back() == ' ') out.pop_back();
+    return out;
+}
+
+std::vector<uint64_t> PatientSearchIndex::trigrams(const std::string& name, bool padEnd) {
+    std::vector<uint32_t> cps = normalize(name);
+    std::vector<uint64_t> grams;
+    if (cps.empty()) return grams;
+
+    cps.insert(cps.begin(), 2, ' ');
+    if (padEnd) cps.push_back(' ');
+    grams.reserve(cps.size());
+    for (size_t i = 0; i + 2 < cps.size(); ++i) {
+        grams.push_back((uint64_t(cps[i]) << 42) | (uint64_t(cps[i + 1]) << 21) | cps[i + 2]);
+    }
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+int PatientSearchIndex::genderCode(const std::string& gender) {
+    if (gender == "Male") return 0;
+    if (gender == "Female") return 1;
+    return 2;
+}
+
+void PatientSearchIndex::setBit(std::vector<uint64_t>& bitmap, uint32_t doc) {
+    if (bitmap.size() <= doc / 64) bitmap.resize(doc / 64 + 1, 0);
+    bitmap[doc / 64] |= uint64_t(1) << (doc % 64);
+}
+
+bool PatientSearchIndex::testBit(const std::vector<uint64_t>& bitmap, uint32_t doc) {
+    return doc / 64 < bitmap.size() && (bitmap[doc / 64] >> (doc % 64) & 1);
+}
+
+void PatientSearchIndex::addLocked(const PatientRecord& patient) {
+    auto old = by_patient.find(patient.id);
+    if (old != by_patient.end()) setBit(deleted, old->second);
+
+    std::vector<uint64_t> grams = trigrams(patient.name, true);
+    uint32_t doc = static_cast<uint32_t>(docs.size());
+    docs.push_back({patient.id, patient.name, patient.birthDate, patient.gender});
+    doc_grams.push_back(static_cast<uint16_t>(std::min<size_t>(grams.size(), UINT16_MAX)));
+    by_patient[patient.id] = doc;
+
+    for (uint64_t g : grams) postings[g].push_back(doc);
+    setBit(gender_bitmaps[genderCode(patient.gender)], doc);
+    if (patient.birthDate.size() >= 4) {
+        setBit(year_bitmaps[std::atoi(patient.birthDate.substr(0, 4).c_str())], doc);
+    }
+}
+
+void PatientSearchIndex::build(PatientStore& store) {
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    docs.clear();
+    doc_grams.clear();
+    deleted.clear();
+    postings.clear();
+    by_patient.clear();
+    for (auto& b : gender_bitmaps) b.clear();
+    year_bitmaps.clear();
+
+    store.forEachPatient([this](const PatientRecord& p) { addLocked(p); });
+    ++generation;
+    std::cout << "[INFO] Patient search index built: " << docs.size() << " patients, "
+              << postings.size() << " trigrams\n";
+}
+
+void PatientSearchIndex::upsert(const PatientRecord& patient) {
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    // 同步回调里多数只是挂号变化，姓名/生日/性别没变就不动索引
+    auto old = by_patient.find(patient.id);
+    if (old != by_patient.end()) {
+        const Doc& d = docs[old->second];
+        if (d.name == patient.name && d.birthDate == patient.birthDate && d.gender == patient.gender) return;
+    }
+    addLocked(patient);
+    ++generation;
+}
+
+size_t PatientSearchIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    return by_patient.size();
+}
+
+void PatientSearchIndex::Session::reset() {
+    active.clear();
+    counts.clear();
+    touched.clear();
+    generation = 0;
+}
+
+void PatientSearchIndex::Session::apply(uint64_t gram, int delta) {
+    auto it = index.postings.find(gram);
+    if (it == index.postings.end()) return;
+    for (uint32_t doc : it->second) {
+        if (delta > 0 && counts[doc]++ == 0) touched.push_back(doc);
+        else if (delta < 0) --counts[doc];
+    }
+}
+
+void PatientSearchIndex::Session::compact() {
+    touched.erase(std::remove_if(touched.begin(), touched.end(),
+                                 [this](uint32_t doc) { return counts[doc] == 0; }),
+                  touched.end());
+}
+
+std::vector<PatientMatch> PatientSearchIndex::Session::search(const std::string& text,
+                                                              const PatientSearchFilter& filter,
+                                                              size_t k) {
+    std::shared_lock<std::shared_mutex> lock(index.mtx);
+
+    // 索引有变化时从零开始累计
+    if (generation != index.generation || counts.size() != index.docs.size()) {
+        active.clear();
+        touched.clear();
+        counts.assign(index.docs.size(), 0);
+        generation = index.generation;
+    }
+
+    // 与上一次查询比较，只合并增减的三元组：先减后加，保证 touched 不重复
+    std::vector<uint64_t> grams = trigrams(text, false);
+    std::vector<uint64_t> removed, added;
+    std::set_difference(active.begin(), active.end(), grams.begin(), grams.end(), std::back_inserter(removed));
+    std::set_difference(grams.begin(), grams.end(), active.begin(), active.end(), std::back_inserter(added));
+    for (uint64_t g : removed) apply(g, -1);
+    if (!removed.empty()) compact();
+    for (uint64_t g : added) apply(g, +1);
+    active.swap(grams);
+
+    std::vector<PatientMatch> results;
+    if (active.empty() || k == 0) return results;
+
+    const std::vector<uint64_t>* gender = nullptr;
+    if (!filter.gender.empty()) gender = &index.gender_bitmaps[genderCode(filter.gender)];
+    const std::vector<uint64_t>* year = nullptr;
+    static const std::vector<uint64_t> none;
+    if (filter.birthDate.size() >= 4) {
+        auto it = index.year_bitmaps.find(std::atoi(filter.birthDate.substr(0, 4).c_str()));
+        year = it == index.year_bitmaps.end() ? &none : &it->second;
+    }
+
+    // 小顶堆维护 top-k
+    using Scored = std::pair<float, uint32_t>;
+    auto worse = [](const Scored& a, const Scored& b) { return a.first > b.first; };
+    std::vector<Scored> heap;
+    heap.reserve(k + 1);
+    const float query = static_cast<float>(active.size());
+    float floor = 0.0f;     // 堆满后第 k 名的分数
+    for (uint32_t doc : touched) {
+        uint16_t hits = counts[doc];
+        // hits / (query + grams - hits) <= hits / query，先用上界剪掉大部分条目
+        if (hits <= floor * query) continue;
+        float score = hits / (query + index.doc_grams[doc] - hits);
+        if (score <= floor) continue;
+        if (testBit(index.deleted, doc)) continue;
+        if (gender && !testBit(*gender, doc)) continue;
+        if (year && !testBit(*year, doc)) continue;
+        if (filter.birthDate.size() > 4 &&
+            index.docs[doc].birthDate.compare(0, filter.birthDate.size(), filter.birthDate) != 0) continue;
+
+        heap.emplace_back(score, doc);
+        std::push_heap(heap.begin(), heap.end(), worse);
+        if (heap.size() > k) {
+            std::pop_heap(heap.begin(), heap.end(), worse);
+            heap.pop_back();
+        }
+        if (heap.size() == k) floor = heap.front().first;
+    }
+
+    std::sort_heap(heap.begin(), heap.end(), worse);
+    results.reserve(heap.size());
+    for (const auto& s : heap) {
+        const Doc& d = index.docs[s.second];
+        results.push_back({d.patientId, d.name, d.birthDate, d.gender, s.first});
+    }
+    return results;
+}
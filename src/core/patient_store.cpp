@@ -0,0 +1,332 @@
+#include "patient_store.h"
+#include <iostream>
+
+#define STORE_BUSY_TIMEOUT_MS 2000
+
+static const char* SCHEMA_SQL = R"SQL(
+PRAGMA journal_mode = WAL;
+PRAGMA synchronous = NORMAL;
+
+CREATE TABLE IF NOT EXISTS Patients (
+    PatientID INTEGER PRIMARY KEY,
+    Name TEXT NOT NULL,
+    BirthDate TEXT NOT NULL,
+    Gender TEXT NOT NULL,
+    VisitType TEXT NOT NULL,
+    PhotoPath TEXT
+);
+
+CREATE TABLE IF NOT EXISTS Departments (
+    DepartmentID INTEGER PRIMARY KEY,
+    Name TEXT NOT NULL,
+    X1 INTEGER, Y1 INTEGER, X2 INTEGER, Y2 INTEGER
+);
+
+CREATE TABLE IF NOT EXISTS Registrations (
+    RegistrationID INTEGER PRIMARY KEY,
+    PatientID INTEGER NOT NULL,
+    DepartmentID INTEGER NOT NULL,
+    AppointmentTime TEXT NOT NULL,
+    AdditionalNotes TEXT
+);
+
+CREATE TABLE IF NOT EXISTS SyncState (
+    Key TEXT PRIMARY KEY,
+    Value INTEGER NOT NULL
+);
+
+CREATE INDEX IF NOT EXISTS idx_patients_name_birth ON Patients (Name, BirthDate);
+CREATE INDEX IF NOT EXISTS idx_registrations_patient ON Registrations (PatientID, AppointmentTime);
+CREATE INDEX IF NOT EXISTS idx_registrations_time ON Registrations (AppointmentTime);
+)SQL";
+
+PatientStore::~PatientStore() {
+    close();
+}
+
+bool PatientStore::exec(const char* sql) {
+    char* err = nullptr;
+    if (sqlite3_exec(db, sql, nullptr, nullptr, &err) != SQLITE_OK) {
+        std::cerr << "[ERROR] SQLite: " << (err ? err : "unknown error") << std::endl;
+        sqlite3_free(err);
+        return false;
+    }
+    return true;
+}
+
+sqlite3_stmt* PatientStore::prepare(const char* sql) {
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v3(db, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK) {
+        std::cerr << "[ERROR] SQLite prepare failed: " << sqlite3_errmsg(db) << std::endl;
+        return nullptr;
+    }
+    statements.push_back(stmt);
+    return stmt;
+}
+
+bool PatientStore::open(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (db) return true;
+
+    if (sqlite3_open(path.c_str(), &db) != SQLITE_OK) {
+        std::cerr << "[ERROR] Failed to open patient store " << path << ": " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        db = nullptr;
+        return false;
+    }
+    // 同步线程用另一条连接写入，检查点等短暂加锁时等待而不是直接失败
+    sqlite3_busy_timeout(db, STORE_BUSY_TIMEOUT_MS);
+    if (!exec(SCHEMA_SQL)) {
+        closeLocked();
+        return false;
+    }
+
+    stmt_upsert_patient = prepare(
+        "INSERT OR REPLACE INTO Patients (PatientID, Name, BirthDate, Gender, VisitType, PhotoPath) "
+        "VALUES (?, ?, ?, ?, ?, ?)");
+    stmt_upsert_department = prepare(
+        "INSERT OR REPLACE INTO Departments (DepartmentID, Name, X1, Y1, X2, Y2) VALUES (?, ?, ?, ?, ?, ?)");
+    stmt_upsert_registration = prepare(
+        "INSERT OR REPLACE INTO Registrations (RegistrationID, PatientID, DepartmentID, AppointmentTime, AdditionalNotes) "
+        "VALUES (?, ?, ?, ?, ?)");
+    stmt_remove_registration = prepare("DELETE FROM Registrations WHERE RegistrationID = ?");
+    stmt_find_patient = prepare(
+        "SELECT PatientID, Name, BirthDate, Gender, VisitType, PhotoPath FROM Patients WHERE PatientID = ?");
+    stmt_find_patients = prepare(
+        "SELECT PatientID, Name, BirthDate, Gender, VisitType, PhotoPath FROM Patients WHERE Name = ? AND BirthDate = ?");
+    stmt_all_patients = prepare(
+        "SELECT PatientID, Name, BirthDate, Gender, VisitType, PhotoPath FROM Patients ORDER BY PatientID");
+    stmt_find_department = prepare(
+        "SELECT DepartmentID, Name, X1, Y1, X2, Y2 FROM Departments WHERE DepartmentID = ?");
+    stmt_all_departments = prepare(
+        "SELECT DepartmentID, Name, X1, Y1, X2, Y2 FROM Departments ORDER BY DepartmentID");
+    stmt_next_registration = prepare(
+        "SELECT RegistrationID, PatientID, DepartmentID, AppointmentTime, AdditionalNotes FROM Registrations "
+        "WHERE PatientID = ? AND AppointmentTime >= ? ORDER BY AppointmentTime LIMIT 1");
+    stmt_registrations_between = prepare(
+        "SELECT RegistrationID, PatientID, DepartmentID, AppointmentTime, AdditionalNotes FROM Registrations "
+        "WHERE AppointmentTime >= ? AND AppointmentTime < ? ORDER BY AppointmentTime");
+    stmt_get_mark = prepare("SELECT Value FROM SyncState WHERE Key = ?");
+    stmt_set_mark = prepare("INSERT OR REPLACE INTO SyncState (Key, Value) VALUES (?, ?)");
+
+    // prepare 失败的语句不会进入 statements；有一条失败就整体关闭，不留下半初始化的连接
+    if (statements.size() != 13) {
+        closeLocked();
+        return false;
+    }
+    db_path = path;
+    return true;
+}
+
+void PatientStore::close() {
+    std::lock_guard<std::mutex> lock(mtx);
+    closeLocked();
+}
+
+void PatientStore::closeLocked() {
+    for (auto* stmt : statements) sqlite3_finalize(stmt);
+    statements.clear();
+    if (db) {
+        sqlite3_close(db);
+        db = nullptr;
+    }
+}
+
+bool PatientStore::beginBatch() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return db && exec("BEGIN");
+}
+
+bool PatientStore::commitBatch() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return db && exec("COMMIT");
+}
+
+bool PatientStore::rollbackBatch() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return db && exec("ROLLBACK");
+}
+
+// 执行写语句并复位，成功返回 true
+bool PatientStore::step(sqlite3_stmt* stmt) {
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    if (rc != SQLITE_DONE) {
+        std::cerr << "[ERROR] SQLite step failed: " << sqlite3_errmsg(db) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static void bindText(sqlite3_stmt* stmt, int idx, const std::string& s) {
+    sqlite3_bind_text(stmt, idx, s.c_str(), static_cast<int>(s.size()), SQLITE_TRANSIENT);
+}
+
+static std::string columnText(sqlite3_stmt* stmt, int col) {
+    const unsigned char* t = sqlite3_column_text(stmt, col);
+    return t ? reinterpret_cast<const char*>(t) : "";
+}
+
+static PatientRecord readPatient(sqlite3_stmt* stmt) {
+    PatientRecord p;
+    p.id = sqlite3_column_int(stmt, 0);
+    p.name = columnText(stmt, 1);
+    p.birthDate = columnText(stmt, 2);
+    p.gender = columnText(stmt, 3);
+    p.visitType = columnText(stmt, 4);
+    p.photoPath = columnText(stmt, 5);
+    return p;
+}
+
+static DepartmentRecord readDepartment(sqlite3_stmt* stmt) {
+    DepartmentRecord d;
+    d.id = sqlite3_column_int(stmt, 0);
+    d.name = columnText(stmt, 1);
+    d.x1 = sqlite3_column_int(stmt, 2);
+    d.y1 = sqlite3_column_int(stmt, 3);
+    d.x2 = sqlite3_column_int(stmt, 4);
+    d.y2 = sqlite3_column_int(stmt, 5);
+    return d;
+}
+
+static RegistrationRecord readRegistration(sqlite3_stmt* stmt) {
+    RegistrationRecord r;
+    r.id = sqlite3_column_int(stmt, 0);
+    r.patientId = sqlite3_column_int(stmt, 1);
+    r.departmentId = sqlite3_column_int(stmt, 2);
+    r.appointmentTime = columnText(stmt, 3);
+    r.notes = columnText(stmt, 4);
+    return r;
+}
+
+bool PatientStore::upsertPatient(const PatientRecord& p) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!db) return false;
+    sqlite3_bind_int(stmt_upsert_patient, 1, p.id);
+    bindText(stmt_upsert_patient, 2, p.name);
+    bindText(stmt_upsert_patient, 3, p.birthDate);
+    bindText(stmt_upsert_patient, 4, p.gender);
+    bindText(stmt_upsert_patient, 5, p.visitType);
+    bindText(stmt_upsert_patient, 6, p.photoPath);
+    return step(stmt_upsert_patient);
+}
+
+bool PatientStore::upsertDepartment(const DepartmentRecord& d) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!db) return false;
+    sqlite3_bind_int(stmt_upsert_department, 1, d.id);
+    bindText(stmt_upsert_department, 2, d.name);
+    sqlite3_bind_int(stmt_upsert_department, 3, d.x1);
+    sqlite3_bind_int(stmt_upsert_department, 4, d.y1);
+    sqlite3_bind_int(stmt_upsert_department, 5, d.x2);
+    sqlite3_bind_int(stmt_upsert_department, 6, d.y2);
+    return step(stmt_upsert_department);
+}
+
+bool PatientStore::upsertRegistration(const RegistrationRecord& r) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!db) return false;
+    sqlite3_bind_int(stmt_upsert_registration, 1, r.id);
+    sqlite3_bind_int(stmt_upsert_registration, 2, r.patientId);
+    sqlite3_bind_int(stmt_upsert_registration, 3, r.departmentId);
+    bindText(stmt_upsert_registration, 4, r.appointmentTime);
+    bindText(stmt_upsert_registration, 5, r.notes);
+    return step(stmt_upsert_registration);
+}
+
+bool PatientStore::removeRegistration(int registrationId) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!db) return false;
+    sqlite3_bind_int(stmt_remove_registration, 1, registrationId);
+    return step(stmt_remove_registration);
+}
+
+std::optional<PatientRecord> PatientStore::findPatient(int patientId) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!db) return std::nullopt;
+    sqlite3_bind_int(stmt_find_patient, 1, patientId);
+    std::optional<PatientRecord> result;
+    if (sqlite3_step(stmt_find_patient) == SQLITE_ROW) result = readPatient(stmt_find_patient);
+    sqlite3_reset(stmt_find_patient);
+    return result;
+}
+
+std::vector<PatientRecord> PatientStore::findPatients(const std::string& name, const std::string& birthDate) {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::vector<PatientRecord> result;
+    if (!db) return result;
+    bindText(stmt_find_patients, 1, name);
+    bindText(stmt_find_patients, 2, birthDate);
+    while (sqlite3_step(stmt_find_patients) == SQLITE_ROW) result.push_back(readPatient(stmt_find_patients));
+    sqlite3_reset(stmt_find_patients);
+    return result;
+}
+
+void PatientStore::forEachPatient(const std::function<void(const PatientRecord&)>& fn) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!db) return;
+    while (sqlite3_step(stmt_all_patients) == SQLITE_ROW) fn(readPatient(stmt_all_patients));
+    sqlite3_reset(stmt_all_patients);
+}
+
+std::optional<DepartmentRecord> PatientStore::findDepartment(int departmentId) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!db) return std::nullopt;
+    sqlite3_bind_int(stmt_find_department, 1, departmentId);
+    std::optional<DepartmentRecord> result;
+    if (sqlite3_step(stmt_find_department) == SQLITE_ROW) result = readDepartment(stmt_find_department);
+    sqlite3_reset(stmt_find_department);
+    return result;
+}
+
+std::vector<DepartmentRecord> PatientStore::allDepartments() {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::vector<DepartmentRecord> result;
+    if (!db) return result;
+    while (sqlite3_step(stmt_all_departments) == SQLITE_ROW) result.push_back(readDepartment(stmt_all_departments));
+    sqlite3_reset(stmt_all_departments);
+    return result;
+}
+
+std::optional<RegistrationRecord> PatientStore::nextRegistration(int patientId, const std::string& after) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!db) return std::nullopt;
+    sqlite3_bind_int(stmt_next_registration, 1, patientId);
+    bindText(stmt_next_registration, 2, after);
+    std::optional<RegistrationRecord> result;
+    if (sqlite3_step(stmt_next_registration) == SQLITE_ROW) result = readRegistration(stmt_next_registration);
+    sqlite3_reset(stmt_next_registration);
+    return result;
+}
+
+std::vector<RegistrationRecord> PatientStore::registrationsBetween(const std::string& from, const std::string& to) {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::vector<RegistrationRecord> result;
+    if (!db) return result;
+    bindText(stmt_registrations_between, 1, from);
+    bindText(stmt_registrations_between, 2, to);
+    while (sqlite3_step(stmt_registrations_between) == SQLITE_ROW) {
+        result.push_back(readRegistration(stmt_registrations_between));
+    }
+    sqlite3_reset(stmt_registrations_between);
+    return result;
+}
+
+long long PatientStore::syncMark(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!db) return 0;
+    bindText(stmt_get_mark, 1, key);
+    long long value = 0;
+    if (sqlite3_step(stmt_get_mark) == SQLITE_ROW) value = sqlite3_column_int64(stmt_get_mark, 0);
+    sqlite3_reset(stmt_get_mark);
+    return value;
+}
+
+bool PatientStore::setSyncMark(const std::string& key, long long value) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!db) return false;
+    bindText(stmt_set_mark, 1, key);
+    sqlite3_bind_int64(stmt_set_mark, 2, value);
+    return step(stmt_set_mark);
+}
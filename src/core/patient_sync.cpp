@@ -0,0 +1,192 @@
+#include "patient_sync.h"
+#include <QDate>
+#include <QDateTime>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <set>
+
+// 秒级 UNIX 时间；同一秒内可能还有后续修改，所以按 >= 重拉这一秒，再和本地比对去重
+#define MARK_PATIENTS "Patients.UpdatedAt"
+#define MARK_REGISTRATIONS "Registrations.RegistrationID"
+
+PatientSync::PatientSync(PatientStore& store, const HospitalDbConfig& config, int interval_sec)
+    : store(store), config(config), interval_sec(interval_sec) {}
+
+PatientSync::~PatientSync() {
+    stop();
+}
+
+void PatientSync::setChangeCallback(ChangeCallback cb) {
+    std::lock_guard<std::mutex> lock(mtx);
+    on_change = std::move(cb);
+}
+
+void PatientSync::start() {
+    if (!running.exchange(true)) {
+        sync_thread = std::thread(&PatientSync::syncLoop, this);
+    }
+}
+
+void PatientSync::stop() {
+    if (running.exchange(false)) {
+        cv.notify_all();
+        if (sync_thread.joinable()) sync_thread.join();
+    }
+}
+
+void PatientSync::syncLoop() {
+    // QSqlDatabase 连接只能在创建它的线程里使用
+    const QString connection = "patient_sync";
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QMYSQL", connection);
+        db.setHostName(QString::fromStdString(config.host));
+        db.setPort(config.port);
+        db.setUserName(QString::fromStdString(config.user));
+        db.setPassword(QString::fromStdString(config.password));
+        db.setDatabaseName(QString::fromStdString(config.database));
+    }
+
+    // 写入走同步线程自己的 SQLite 连接：事务只包住本线程的写入，
+    // 其他线程在主连接上的查询照常进行，读到的是上一次提交的数据（WAL）
+    PatientStore mirror;
+    bool mirrorOpen = mirror.open(store.path());
+    if (!mirrorOpen) {
+        std::cerr << "[ERROR] Patient sync cannot open " << store.path() << ", sync disabled.\n";
+    }
+
+    while (running.load()) {
+        if (mirrorOpen) syncOnce(connection.toStdString(), mirror);
+
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait_for(lock, std::chrono::seconds(interval_sec), [this] { return !running.load(); });
+    }
+
+    QSqlDatabase::database(connection, false).close();
+    QSqlDatabase::removeDatabase(connection);
+}
+
+bool PatientSync::syncOnce(const std::string& connection, PatientStore& mirror) {
+    QSqlDatabase db = QSqlDatabase::database(QString::fromStdString(connection), false);
+    if (!db.isOpen() && !db.open()) {
+        std::cerr << "[DEBUG] Patient sync skipped, database unreachable: "
+                  << db.lastError().text().toStdString() << "\n";
+        return false;
+    }
+
+    QSqlQuery q(db);
+    size_t patients = 0, registrations = 0, removed = 0;
+    std::set<int> changed;   // 路由可能变化的患者
+
+    // 任何一条写入失败都回滚整批，水位也不前移，下一轮重新拉取；BEGIN 失败时没有事务可回滚
+    bool begun = mirror.beginBatch();
+    bool written = begun;
+
+    if (q.exec("SELECT DepartmentID, Name, X1, Y1, X2, Y2 FROM Departments")) {
+        while (q.next()) {
+            DepartmentRecord d;
+            d.id = q.value(0).toInt();
+            d.name = q.value(1).toString().toStdString();
+            d.x1 = q.value(2).toInt();
+            d.y1 = q.value(3).toInt();
+            d.x2 = q.value(4).toInt();
+            d.y2 = q.value(5).toInt();
+            written = written && mirror.upsertDepartment(d);
+        }
+    }
+
+    long long patientMark = mirror.syncMark(MARK_PATIENTS);
+    q.prepare("SELECT PatientID, Name, BirthDate, Gender, VisitType, PhotoPath, UNIX_TIMESTAMP(UpdatedAt) "
+              "FROM Patients WHERE UpdatedAt >= FROM_UNIXTIME(?) ORDER BY UpdatedAt");
+    q.addBindValue(patientMark);
+    if (written && q.exec()) {
+        while (q.next()) {
+            PatientRecord p;
+            p.id = q.value(0).toInt();
+            p.name = q.value(1).toString().toStdString();
+            p.birthDate = q.value(2).toDate().toString("yyyy-MM-dd").toStdString();
+            p.gender = q.value(3).toString().toStdString();
+            p.visitType = q.value(4).toString().toStdString();
+            p.photoPath = q.value(5).toString().toStdString();
+            patientMark = std::max<long long>(patientMark, q.value(6).toLongLong());
+
+            auto local = mirror.findPatient(p.id);
+            if (local && local->name == p.name && local->birthDate == p.birthDate && local->gender == p.gender &&
+                local->visitType == p.visitType && local->photoPath == p.photoPath) {
+                continue;
+            }
+            written = written && mirror.upsertPatient(p);
+            changed.insert(p.id);
+            ++patients;
+        }
+        written = written && mirror.setSyncMark(MARK_PATIENTS, patientMark);
+    }
+
+    long long registrationMark = mirror.syncMark(MARK_REGISTRATIONS);
+    QString today = QDate::currentDate().toString("yyyy-MM-dd") + " 00:00:00";
+    q.prepare("SELECT RegistrationID, PatientID, DepartmentID, AppointmentTime, AdditionalNotes FROM Registrations "
+              "WHERE RegistrationID > ? OR AppointmentTime >= ?");
+    q.addBindValue(registrationMark);
+    q.addBindValue(today);
+    std::set<int> upcoming;
+    bool registrationsOk = written && q.exec();
+    if (registrationsOk) {
+        // 本地已有的未来挂号，用来判断远端是否真的有改动
+        std::map<int, RegistrationRecord> local;
+        for (auto& r : mirror.registrationsBetween(today.toStdString(), "9999-12-31")) local[r.id] = r;
+
+        while (q.next()) {
+            RegistrationRecord r;
+            r.id = q.value(0).toInt();
+            r.patientId = q.value(1).toInt();
+            r.departmentId = q.value(2).toInt();
+            r.appointmentTime = q.value(3).toDateTime().toString("yyyy-MM-dd HH:mm:ss").toStdString();
+            r.notes = q.value(4).toString().toStdString();
+            registrationMark = std::max<long long>(registrationMark, r.id);
+            upcoming.insert(r.id);
+
+            auto it = local.find(r.id);
+            if (it != local.end() && it->second.patientId == r.patientId &&
+                it->second.departmentId == r.departmentId && it->second.appointmentTime == r.appointmentTime &&
+                it->second.notes == r.notes) {
+                continue;
+            }
+            if (it != local.end()) changed.insert(it->second.patientId);
+            written = written && mirror.upsertRegistration(r);
+            changed.insert(r.patientId);
+            ++registrations;
+        }
+        written = written && mirror.setSyncMark(MARK_REGISTRATIONS, registrationMark);
+
+        // 本地有、远端已不存在的未来挂号视为取消
+        for (const auto& kv : local) {
+            if (!upcoming.count(kv.first)) {
+                written = written && mirror.removeRegistration(kv.first);
+                changed.insert(kv.second.patientId);
+                ++removed;
+            }
+        }
+    }
+
+    if (!written || !mirror.commitBatch()) {
+        if (begun) mirror.rollbackBatch();
+        std::cerr << "[ERROR] Patient sync write failed, batch rolled back.\n";
+        return false;
+    }
+
+    if (!changed.empty()) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (on_change) on_change(std::vector<int>(changed.begin(), changed.end()));
+    }
+
+    if (patients || registrations || removed) {
+        std::cout << "[INFO] Patient sync: " << patients << " patients, " << registrations
+                  << " registrations, " << removed << " removed\n";
+    }
+    return registrationsOk;
+}
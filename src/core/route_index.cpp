@@ -0,0 +1,125 @@
+#include "route_index.h"
+#include <iostream>
+#include <mutex>
+
+RouteIndex::RouteIndex(PatientStore& store) : store(store) {}
+
+std::string RouteIndex::labelFromPhotoPath(const std::string& photoPath) {
+    size_t slash = photoPath.find_last_of("/\\");
+    return slash == std::string::npos ? photoPath : photoPath.substr(slash + 1);
+}
+
+void RouteIndex::rebuild(const std::string& day) {
+    std::unordered_map<int, std::string> departments;
+    for (const auto& d : store.allDepartments()) departments[d.id] = d.name;
+
+    std::unordered_map<int, PatientRecord> patients;
+    std::unordered_map<std::string, int> labels;
+    std::unordered_map<int, std::string> reverse;
+    store.forEachPatient([&](const PatientRecord& p) {
+        if (p.photoPath.empty()) return;
+        std::string label = labelFromPhotoPath(p.photoPath);
+        labels[label] = p.id;
+        reverse[p.id] = label;
+        patients[p.id] = p;
+    });
+
+    // 一次扫描今天及以后的挂号，每个患者取最早的一条
+    std::unordered_map<int, PatientRoute> fresh;
+    for (const auto& r : store.registrationsBetween(day + " 00:00:00", "9999-12-31")) {
+        auto p = patients.find(r.patientId);
+        if (p == patients.end() || fresh.count(r.patientId)) continue;
+        auto d = departments.find(r.departmentId);
+        if (d == departments.end()) continue;
+        fresh[r.patientId] = {r.patientId, p->second.name, r.id, r.appointmentTime, r.departmentId, d->second};
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    today = day;
+    department_names.swap(departments);
+    label_to_patient.swap(labels);
+    patient_to_label.swap(reverse);
+    routes.swap(fresh);
+    std::cout << "[INFO] Route index built: " << label_to_patient.size() << " faces, "
+              << routes.size() << " upcoming appointments\n";
+}
+
+std::optional<PatientRoute> RouteIndex::computeRoute(const PatientRecord& patient) {
+    std::string day = builtFor();
+    auto r = store.nextRegistration(patient.id, day + " 00:00:00");
+    if (!r) return std::nullopt;
+
+    std::string name;
+    {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        auto d = department_names.find(r->departmentId);
+        if (d != department_names.end()) name = d->second;
+    }
+    if (name.empty()) {
+        auto dept = store.findDepartment(r->departmentId);
+        if (!dept) return std::nullopt;
+        name = dept->name;
+    }
+    return PatientRoute{patient.id, patient.name, r->id, r->appointmentTime, r->departmentId, name};
+}
+
+void RouteIndex::update(const std::vector<int>& patientIds) {
+    // 先在锁外查库，最后一次性写入
+    struct Change {
+        int id;
+        std::optional<PatientRecord> patient;
+        std::optional<PatientRoute> route;
+    };
+    std::vector<Change> changes;
+    changes.reserve(patientIds.size());
+    for (int id : patientIds) {
+        Change c{id, store.findPatient(id), std::nullopt};
+        if (c.patient) c.route = computeRoute(*c.patient);
+        changes.push_back(std::move(c));
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    for (auto& c : changes) {
+        auto old = patient_to_label.find(c.id);
+        if (old != patient_to_label.end()) {
+            label_to_patient.erase(old->second);
+            patient_to_label.erase(old);
+        }
+        if (c.patient && !c.patient->photoPath.empty()) {
+            std::string label = labelFromPhotoPath(c.patient->photoPath);
+            label_to_patient[label] = c.id;
+            patient_to_label[c.id] = label;
+        }
+        if (c.route) {
+            routes[c.id] = std::move(*c.route);
+        } else {
+            routes.erase(c.id);
+        }
+    }
+}
+
+std::optional<PatientRoute> RouteIndex::lookup(const std::string& faceLabel) const {
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    auto p = label_to_patient.find(faceLabel);
+    if (p == label_to_patient.end()) return std::nullopt;
+    auto r = routes.find(p->second);
+    if (r == routes.end()) return std::nullopt;
+    return r->second;
+}
+
+std::optional<PatientRoute> RouteIndex::lookupPatient(int patientId) const {
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    auto r = routes.find(patientId);
+    if (r == routes.end()) return std::nullopt;
+    return r->second;
+}
+
+std::string RouteIndex::builtFor() const {
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    return today;
+}
+
+size_t RouteIndex::size() const {
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    return routes.size();
+}
@@ -0,0 +1,89 @@
+#include "speed_governor.h"
+#include "trace.h"
+#include "log.h"
+#include <algorithm>
+
+// 解除停车需要的额外距离，防止在阈值附近反复启停
+#define RESUME_HYSTERESIS_CM 5.0f
+
+SpeedGovernor::SpeedGovernor(float stop_cm, float clear_cm, int min_duty, int ramp_step)
+    : sensor(nullptr),
+      stop_cm(stop_cm),
+      clear_cm(clear_cm),
+      min_duty(min_duty),
+      ramp_step(ramp_step),
+      current_duty(0),
+      error_ticks(0),
+      is_blocked(false),
+      is_faulted(false) {}
+
+void SpeedGovernor::attach(const RangeSource* s) {
+    sensor.store(s);
+}
+
+void SpeedGovernor::reset() {
+    current_duty = 0;
+}
+
+bool SpeedGovernor::blocked() const {
+    return is_blocked.load(std::memory_order_relaxed);
+}
+
+bool SpeedGovernor::sensorFault() const {
+    return is_faulted.load(std::memory_order_relaxed);
+}
+
+int SpeedGovernor::limitFor(int target_duty, float distance) {
+    // 传感器失效时看不到障碍物，不能当作空旷全速前进，只允许慢速区的速度
+    if (distance == RANGE_ERROR) {
+        if (error_ticks < GOVERNOR_FAULT_TICKS) error_ticks++;
+        if (error_ticks >= GOVERNOR_FAULT_TICKS && !is_faulted.exchange(true, std::memory_order_relaxed)) {
+            LOG_ERROR("Range sensor not responding, speed capped at duty {}", min_duty);
+        }
+        if (is_faulted.load(std::memory_order_relaxed)) return std::min(min_duty, target_duty);
+        // 还没到判定次数时沿用上一周期的限速
+        return std::min(current_duty, target_duty);
+    }
+    error_ticks = 0;
+    if (is_faulted.exchange(false, std::memory_order_relaxed)) {
+        LOG_INFO("Range sensor recovered.");
+    }
+
+    // 无回波视为前方空旷
+    if (distance < 0.0f || distance >= clear_cm) {
+        is_blocked.store(false, std::memory_order_relaxed);
+        return target_duty;
+    }
+
+    float stop_at = is_blocked.load(std::memory_order_relaxed) ? stop_cm + RESUME_HYSTERESIS_CM : stop_cm;
+    if (distance <= stop_at) {
+        is_blocked.store(true, std::memory_order_relaxed);
+        return 0;
+    }
+    is_blocked.store(false, std::memory_order_relaxed);
+
+    // 低于 min_duty 电机会堵转，降速区间映射到 [min_duty, target_duty]
+    float ratio = (distance - stop_cm) / (clear_cm - stop_cm);
+    int low = std::min(min_duty, target_duty);
+    return low + static_cast<int>((target_duty - low) * ratio + 0.5f);
+}
+
+int SpeedGovernor::update(int target_duty) {
+    const RangeSource* s = sensor.load();
+    int desired = target_duty;
+    if (s) {
+        float distance = s->getDistance();
+        Trace::range(distance);
+        desired = limitFor(target_duty, distance);
+    }
+
+    // 加速按 ramp_step 爬升，减速允许两倍步长，保证能及时停住
+    if (desired > current_duty) {
+        current_duty = std::min(desired, current_duty + ramp_step);
+    } else if (desired < current_duty) {
+        current_duty = std::max(desired, current_duty - 2 * ramp_step);
+        // 已低于可驱动占空比时直接归零，不在堵转区间停留
+        if (desired == 0 && current_duty < min_duty) current_duty = 0;
+    }
+    return current_duty;
+}
@@ -0,0 +1,172 @@
+#include "state_bus.h"
+#include <chrono>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define STATE_BUS_MAGIC 0x52484753   // "RHGS"
+#define STATE_BUS_VERSION 3
+#define STATE_BUS_READ_TRIES 1000     // 发布者写一次只要几百纳秒，这么多次还读不到一致快照说明它死在写入中途
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared-memory atomics must be lock-free");
+static_assert((COMMAND_RING_SLOTS & (COMMAND_RING_SLOTS - 1)) == 0, "COMMAND_RING_SLOTS must be a power of two");
+
+struct StateBus::Layout {
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    std::atomic<uint32_t> next_id;
+
+    // seqlock：奇数表示写者正在写
+    alignas(64) std::atomic<uint32_t> seq;
+    RobotState state;
+
+    // 命令环：每个槽的序号等于位置时可写，等于位置 + 1 时可读
+    struct Slot {
+        std::atomic<uint32_t> seq;
+        BusCommand cmd;
+    };
+    alignas(64) std::atomic<uint32_t> head;   // 消费位置
+    alignas(64) std::atomic<uint32_t> tail;   // 投递位置
+    alignas(64) Slot slots[COMMAND_RING_SLOTS];
+};
+
+uint64_t StateBus::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void* mapShared(int fd, size_t size) {
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return p == MAP_FAILED ? nullptr : p;
+}
+
+std::unique_ptr<StateBus> StateBus::create(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0660);
+    if (fd < 0 || ftruncate(fd, sizeof(Layout)) != 0) {
+        std::cerr << "[ERROR] Cannot create state bus " << name << std::endl;
+        if (fd >= 0) close(fd);
+        return nullptr;
+    }
+    void* p = mapShared(fd, sizeof(Layout));
+    if (!p) {
+        std::cerr << "[ERROR] Cannot map state bus " << name << std::endl;
+        return nullptr;
+    }
+
+    // 上一次核心进程留下的内容一律重置，magic 最后写，attach 方看到它时其余字段已就绪
+    Layout* layout = new (p) Layout();
+    layout->version = STATE_BUS_VERSION;
+    layout->next_id.store(1);
+    layout->seq.store(0);
+    layout->head.store(0);
+    layout->tail.store(0);
+    for (uint32_t i = 0; i < COMMAND_RING_SLOTS; ++i) layout->slots[i].seq.store(i);
+    layout->magic.store(STATE_BUS_MAGIC, std::memory_order_release);
+
+    return std::unique_ptr<StateBus>(new StateBus(layout, name, true));
+}
+
+std::unique_ptr<StateBus> StateBus::attach(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        std::cerr << "[ERROR] State bus " << name << " not found, is robo_core running?" << std::endl;
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Layout)) {
+        std::cerr << "[ERROR] State bus " << name << " has unexpected size" << std::endl;
+        close(fd);
+        return nullptr;
+    }
+    void* p = mapShared(fd, sizeof(Layout));
+    if (!p) {
+        std::cerr << "[ERROR] Cannot map state bus " << name << std::endl;
+        return nullptr;
+    }
+
+    Layout* layout = static_cast<Layout*>(p);
+    if (layout->magic.load(std::memory_order_acquire) != STATE_BUS_MAGIC || layout->version != STATE_BUS_VERSION) {
+        std::cerr << "[ERROR] State bus " << name << " has an incompatible layout" << std::endl;
+        munmap(p, sizeof(Layout));
+        return nullptr;
+    }
+    return std::unique_ptr<StateBus>(new StateBus(layout, name, false));
+}
+
+StateBus::StateBus(Layout* layout, std::string name, bool owner)
+    : layout(layout), name(std::move(name)), owner(owner) {}
+
+StateBus::~StateBus() {
+    munmap(layout, sizeof(Layout));
+    if (owner) shm_unlink(name.c_str());
+}
+
+void StateBus::publish(const RobotState& state) {
+    uint32_t s = layout->seq.load(std::memory_order_relaxed);
+    layout->seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(static_cast<void*>(&layout->state), &state, sizeof(RobotState));
+    layout->seq.store(s + 2, std::memory_order_release);
+}
+
+bool StateBus::read(RobotState& out) const {
+    for (int i = 0; i < STATE_BUS_READ_TRIES; ++i) {
+        uint32_t s1 = layout->seq.load(std::memory_order_acquire);
+        if (s1 & 1) {
+            // 发布者正在写，让出 CPU 给它
+            std::this_thread::yield();
+            continue;
+        }
+        std::memcpy(static_cast<void*>(&out), &layout->state, sizeof(RobotState));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint32_t s2 = layout->seq.load(std::memory_order_relaxed);
+        if (s1 == s2) return s1 != 0;
+    }
+    return false;
+}
+
+bool StateBus::alive(uint64_t max_age_ns) const {
+    RobotState s;
+    return read(s) && nowNs() - s.t_ns <= max_age_ns;
+}
+
+bool StateBus::send(const BusCommand& cmd) {
+    uint32_t pos = layout->tail.load(std::memory_order_relaxed);
+    while (true) {
+        auto& slot = layout->slots[pos & (COMMAND_RING_SLOTS - 1)];
+        uint32_t seq = slot.seq.load(std::memory_order_acquire);
+        int32_t diff = static_cast<int32_t>(seq - pos);
+        if (diff == 0) {
+            if (layout->tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.cmd = cmd;
+                slot.seq.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;   // 满
+        } else {
+            pos = layout->tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool StateBus::receive(BusCommand& cmd) {
+    uint32_t pos = layout->head.load(std::memory_order_relaxed);
+    auto& slot = layout->slots[pos & (COMMAND_RING_SLOTS - 1)];
+    uint32_t seq = slot.seq.load(std::memory_order_acquire);
+    if (static_cast<int32_t>(seq - (pos + 1)) < 0) return false;   // 空，或投递者还没写完
+
+    cmd = slot.cmd;
+    layout->head.store(pos + 1, std::memory_order_relaxed);
+    slot.seq.store(pos + COMMAND_RING_SLOTS, std::memory_order_release);
+    return true;
+}
+
+uint32_t StateBus::nextCommandId() {
+    return layout->next_id.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,108 @@
+#include "vad.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// 满量程平方，用于换算 dBFS
+#define FULL_SCALE_SQ (32768.0 * 32768.0)
+// 噪声底初始值与自适应速率
+#define INITIAL_NOISE_DB -60.0f
+#define NOISE_ADAPT 0.05f
+
+VoiceActivityDetector::VoiceActivityDetector(const VadConfig& config) : cfg(config) {
+    reset();
+}
+
+void VoiceActivityDetector::reset() {
+    in_speech = false;
+    voiced_run = 0;
+    silent_run = 0;
+    noise_floor_db = INITIAL_NOISE_DB;
+}
+
+uint64_t VoiceActivityDetector::frameEnergy(const int16_t* samples, size_t count) {
+    size_t i = 0;
+    uint64_t sum = 0;
+
+#if defined(__ARM_NEON)
+    int64x2_t acc = vdupq_n_s64(0);
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t v = vld1q_s16(samples + i);
+        int16x4_t lo = vget_low_s16(v);
+        int16x4_t hi = vget_high_s16(v);
+        acc = vpadalq_s32(acc, vmull_s16(lo, lo));
+        acc = vpadalq_s32(acc, vmull_s16(hi, hi));
+    }
+    sum = static_cast<uint64_t>(vgetq_lane_s64(acc, 0) + vgetq_lane_s64(acc, 1));
+#elif defined(__SSE2__)
+    // madd 每个 32 位通道为两个平方和，最大 2^31，按无符号扩展到 64 位累加
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+        __m128i sq = _mm_madd_epi16(v, v);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(sq, zero));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(sq, zero));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    sum = lanes[0] + lanes[1];
+#endif
+
+    for (; i < count; ++i) {
+        int32_t s = samples[i];
+        sum += static_cast<uint64_t>(s * s);
+    }
+    return sum;
+}
+
+VoiceActivityDetector::Event VoiceActivityDetector::processFrame(const int16_t* frame) {
+    uint64_t energy = frameEnergy(frame, FRAME_SAMPLES);
+    float db = 10.0f * std::log10(std::max(energy / (FRAME_SAMPLES * FULL_SCALE_SQ), 1e-10));
+
+    int crossings = 0;
+    for (size_t i = 1; i < FRAME_SAMPLES; ++i) {
+        crossings += (frame[i - 1] >= 0) != (frame[i] >= 0);
+    }
+    float zcr = static_cast<float>(crossings) / (FRAME_SAMPLES - 1);
+
+    float gate = std::max(cfg.threshold_db, noise_floor_db + cfg.noise_margin_db);
+    bool voiced = db > gate && zcr < cfg.max_zcr;
+
+    // 仅在静音段跟踪噪声底，避免被语音拉高
+    if (!in_speech && !voiced) {
+        noise_floor_db += NOISE_ADAPT * (db - noise_floor_db);
+    }
+
+    if (voiced) {
+        ++voiced_run;
+        silent_run = 0;
+    } else {
+        voiced_run = 0;
+        ++silent_run;
+    }
+
+    if (!in_speech && voiced_run >= cfg.onset_frames) {
+        in_speech = true;
+        return Event::SpeechStart;
+    }
+    if (in_speech && silent_run >= cfg.hangover_frames) {
+        in_speech = false;
+        return Event::SpeechEnd;
+    }
+    return Event::None;
+}
+
+VoiceActivityDetector::Event VoiceActivityDetector::process(const int16_t* samples, size_t count) {
+    Event last = Event::None;
+    for (size_t off = 0; off + FRAME_SAMPLES <= count; off += FRAME_SAMPLES) {
+        Event e = processFrame(samples + off);
+        if (e != Event::None) last = e;
+    }
+    return last;
+}
@@ -0,0 +1,177 @@
+// robo_core：机器人核心守护进程。持有硬件、人脸识别和导航，
+// 通过共享内存状态总线（state_bus.h）接收 GUI 进程的命令并定时发布状态，
+// GUI 以 ROBO_CORE=remote 启动后 MainController 只转发命令，Qt 事件循环不再在控制路径上。
+// 护士站桥接、测试脚本等其他客户端走 Unix 域套接字上的 JSON-lines 命令接口（command_server.h）。
+#include "maincontroller.h"
+#include "command_server.h"
+#include "motion_arbiter.h"
+#include "hardware_context.h"
+#include "state_bus.h"
+#include "thread_profile.h"
+#include <QCoreApplication>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define PUBLISH_INTERVAL_MS 50    // 状态发布周期
+#define POLL_INTERVAL_MS 5        // 命令环轮询周期
+
+static std::atomic<bool> running(true);
+
+// 识别在控制器的工作线程里完成，应答交回主循环写给套接字客户端
+static std::mutex completedMtx;
+static std::vector<std::pair<uint64_t, nlohmann::json>> completed;
+
+static void onSignal(int) {
+    running.store(false);
+}
+
+static const char* navStateName(NavState s) {
+    switch (s) {
+    case NavState::Running: return "running";
+    case NavState::Paused:  return "paused";
+    case NavState::Stopped: return "stopped";
+    default:                return "idle";
+    }
+}
+
+static nlohmann::json stateJson(const RobotState& s) {
+    nlohmann::json j = {
+        {"nav", navStateName(s.nav)},
+        {"target", s.target},
+        {"step", s.step},
+        {"steps", s.steps},
+        {"action", s.action},
+        {"value", s.value},
+        {"heading_deg", s.heading_deg},
+        {"obstacle_cm", s.obstacle_cm},
+        {"range_fault", s.range_fault},
+        {"left_duty", s.left_duty},
+        {"right_duty", s.right_duty},
+        {"servo_us", s.servo_us},
+        {"motion_source", motionSourceName(static_cast<MotionSource>(s.motion_source))},
+        {"hardware_ready", s.hardware_ready}
+    };
+    // JSON 没有 NaN，没有电池读数时给 null
+    j["battery_v"] = std::isnan(s.battery_v) ? nlohmann::json() : nlohmann::json(s.battery_v);
+    return j;
+}
+
+// navigate / pause / resume / cancel / teleop / estop / status / recognize
+static nlohmann::json handleRequest(MainController& controller, CommandServer& server, const nlohmann::json& req) {
+    const std::string cmd = req["cmd"];
+    if (cmd == "navigate") {
+        std::string target = req.value("target", std::string());
+        if (target.empty()) return {{"ok", false}, {"error", "missing target"}};
+        bool started = controller.startNavigationTo(QString::fromStdString(target));
+        if (!started) return {{"ok", false}, {"error", "cannot start navigation"}};
+        return {{"ok", true}};
+    }
+    if (cmd == "pause") {
+        controller.pauseNavigation();
+        return {{"ok", true}};
+    }
+    if (cmd == "resume") {
+        controller.resumeNavigation();
+        return {{"ok", true}};
+    }
+    if (cmd == "cancel") {
+        controller.cancelNavigation();
+        return {{"ok", true}};
+    }
+    if (cmd == "teleop") {
+        // {"cmd": "teleop", "duty": 30}，{"cmd": "teleop", "release": true} 交还给导航
+        if (req.value("release", false)) {
+            controller.releaseTeleop();
+            return {{"ok", true}};
+        }
+        if (!req.contains("duty") || !req["duty"].is_number_integer()) return {{"ok", false}, {"error", "missing duty"}};
+        controller.teleop(req["duty"].get<int>());
+        return {{"ok", true}};
+    }
+    if (cmd == "estop") {
+        controller.emergencyStop(!req.value("clear", false));
+        return {{"ok", true}};
+    }
+    if (cmd == "status") {
+        return {{"ok", true}, {"state", stateJson(controller.collectState())}};
+    }
+    if (cmd == "recognize") {
+        // 识别最长要一两秒，放到工作线程里，期间急停、暂停等请求照常处理；应答稍后写回
+        bool guide = req.value("guide", false);
+        uint64_t token = server.defer();
+        controller.recognizeAsync(guide, [token](const QString& department) {
+            std::lock_guard<std::mutex> lock(completedMtx);
+            completed.emplace_back(token, nlohmann::json{{"ok", !department.isEmpty()},
+                                                         {"department", department.toStdString()}});
+        });
+        return nullptr;
+    }
+    return {{"ok", false}, {"error", "unknown command: " + cmd}};
+}
+
+int main(int argc, char* argv[]) {
+    // 先定好线程角色，Qt 和 OpenCV 的线程才会继承非控制核心
+    ThreadProfile::configure();
+
+    // Qt SQL 驱动插件要有应用对象才能加载，这里不进入事件循环
+    QCoreApplication app(argc, argv);
+
+    std::unique_ptr<StateBus> bus = StateBus::create();
+    if (!bus) return 1;
+
+    MainController controller;
+    if (!controller.initLocal()) {
+        std::cerr << "[ERROR] robo_core failed to initialize.\n";
+        return 1;
+    }
+
+    CommandServer server([&](const nlohmann::json& req) { return handleRequest(controller, server, req); });
+    const char* socket_path = std::getenv("ROBO_CORE_SOCKET");
+    server.listen(socket_path && *socket_path ? socket_path : COMMAND_SOCKET_PATH);
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    std::cout << "[INFO] robo_core serving on " << STATE_BUS_NAME << std::endl;
+
+    auto next_publish = std::chrono::steady_clock::now();
+    uint32_t heartbeat = 0;
+    while (running.load()) {
+        // 命令在这里只做派发，识别交给控制器的工作线程，急停不会排在识别后面
+        BusCommand cmd;
+        while (bus->receive(cmd)) controller.handleCommand(cmd);
+
+        std::vector<std::pair<uint64_t, nlohmann::json>> answers;
+        {
+            std::lock_guard<std::mutex> lock(completedMtx);
+            answers.swap(completed);
+        }
+        for (auto& [token, response] : answers) server.complete(token, std::move(response));
+
+        auto now = std::chrono::steady_clock::now();
+        if (now >= next_publish) {
+            RobotState state = controller.collectState();
+            state.heartbeat = ++heartbeat;
+            bus->publish(state);
+            next_publish = now + std::chrono::milliseconds(PUBLISH_INTERVAL_MS);
+        }
+        // 套接字客户端在 epoll 上等待，顺便充当轮询间隔
+        if (server.listening()) {
+            server.poll(POLL_INTERVAL_MS);
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+        }
+    }
+
+    std::cout << "[INFO] robo_core shutting down." << std::endl;
+    server.close();
+    controller.exitSystem();
+    HardwareContext::instance().shutdown();
+    return 0;
+}
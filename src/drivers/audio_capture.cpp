@@ -0,0 +1,110 @@
+#include "audio_capture.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+AudioCapture::AudioCapture(const std::string& device) : device(device) {}
+
+AudioCapture::~AudioCapture() {
+    stop();
+}
+
+void AudioCapture::setFrameCallback(FrameCallback cb) {
+    callback = std::move(cb);
+}
+
+bool AudioCapture::start() {
+    if (isRunning()) return true;
+    // 采集线程出错退出后 running 仍为 true，这里回收线程并关闭旧设备
+    stop();
+
+    int err = snd_pcm_open(&pcm_handle, device.c_str(), SND_PCM_STREAM_CAPTURE, 0);
+    if (err < 0) {
+        std::cerr << "[ERROR] Failed to open capture device " << device << ": " << snd_strerror(err) << std::endl;
+        pcm_handle = nullptr;
+        return false;
+    }
+
+    // 缓冲 60ms，一次读取正好一帧
+    err = snd_pcm_set_params(pcm_handle, SND_PCM_FORMAT_S16_LE, SND_PCM_ACCESS_RW_INTERLEAVED,
+                             1, SAMPLE_RATE, 1, 60000);
+    if (err < 0) {
+        std::cerr << "[ERROR] Failed to configure capture device: " << snd_strerror(err) << std::endl;
+        snd_pcm_close(pcm_handle);
+        pcm_handle = nullptr;
+        return false;
+    }
+
+    head.store(0);
+    tail.store(0);
+    dropped.store(0);
+    failed.store(false);
+    running.store(true);
+    capture_thread = std::thread(&AudioCapture::captureLoop, this);
+    return true;
+}
+
+void AudioCapture::stop() {
+    running.store(false);
+    if (capture_thread.joinable()) capture_thread.join();
+    wait_cv.notify_all();
+    if (pcm_handle) {
+        snd_pcm_close(pcm_handle);
+        pcm_handle = nullptr;
+    }
+}
+
+void AudioCapture::captureLoop() {
+    int16_t frame[FRAME_SAMPLES];
+
+    while (running.load() && !failed.load()) {
+        snd_pcm_sframes_t n = snd_pcm_readi(pcm_handle, frame, FRAME_SAMPLES);
+        if (n < 0) {
+            // 溢出（-EPIPE）等可恢复错误直接 recover 后继续
+            if (snd_pcm_recover(pcm_handle, static_cast<int>(n), 1) < 0) {
+                std::cerr << "[ERROR] Capture read failed: " << snd_strerror(static_cast<int>(n)) << std::endl;
+                failed.store(true);
+            }
+            continue;
+        }
+        if (n != static_cast<snd_pcm_sframes_t>(FRAME_SAMPLES)) {
+            std::memset(frame + n, 0, (FRAME_SAMPLES - n) * sizeof(int16_t));
+        }
+
+        // 回调就是消费者，没有人拉取环形缓冲，不必写入也不计丢帧
+        if (callback) {
+            callback(frame, FRAME_SAMPLES);
+            continue;
+        }
+
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= RING_FRAMES) {
+            // 消费者跟不上时丢弃新帧，不阻塞采集线程
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        std::memcpy(ring[h % RING_FRAMES], frame, sizeof(frame));
+        head.store(h + 1, std::memory_order_release);
+        wait_cv.notify_one();
+    }
+    wait_cv.notify_all();
+}
+
+bool AudioCapture::readFrame(int16_t* out) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) return false;
+
+    std::memcpy(out, ring[t % RING_FRAMES], sizeof(ring[0]));
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+bool AudioCapture::waitFrame(int16_t* out, int timeout_ms) {
+    if (readFrame(out)) return true;
+
+    std::unique_lock<std::mutex> lock(wait_mtx);
+    wait_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this] {
+        return tail.load(std::memory_order_relaxed) != head.load(std::memory_order_acquire) || !isRunning();
+    });
+    return readFrame(out);
+}
@@ -0,0 +1,272 @@
+#include "audio_engine.h"
+#include "thread_profile.h"
+#include <sndfile.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+AudioEngine& AudioEngine::instance() {
+    static AudioEngine engine;
+    return engine;
+}
+
+AudioEngine::~AudioEngine() {
+    shutdown();
+    for (auto& kv : clips) {
+        if (kv.second.mapped) munmap(kv.second.mapped, kv.second.mapped_len);
+    }
+}
+
+bool AudioEngine::init(const std::string& device) {
+    if (running.load()) return true;
+
+    int err = snd_pcm_open(&pcm_handle, device.c_str(), SND_PCM_STREAM_PLAYBACK, 0);
+    if (err < 0) {
+        std::cerr << "[ERROR] Failed to open audio device " << device << ": " << snd_strerror(err) << std::endl;
+        pcm_handle = nullptr;
+        return false;
+    }
+
+    // 约 100ms 缓冲，兼顾提示音延迟与欠载风险
+    err = snd_pcm_set_params(pcm_handle, SND_PCM_FORMAT_S16_LE, SND_PCM_ACCESS_RW_INTERLEAVED,
+                             CHANNELS, SAMPLE_RATE, 1, 100000);
+    if (err < 0) {
+        std::cerr << "[ERROR] Failed to configure audio device: " << snd_strerror(err) << std::endl;
+        snd_pcm_close(pcm_handle);
+        pcm_handle = nullptr;
+        return false;
+    }
+
+    running.store(true);
+    mix_thread = std::thread(&AudioEngine::mixLoop, this);
+    std::cout << "[INFO] Audio engine started on " << device << std::endl;
+    return true;
+}
+
+void AudioEngine::shutdown() {
+    if (running.exchange(false)) {
+        cv.notify_all();
+        if (mix_thread.joinable()) mix_thread.join();
+    }
+    if (pcm_handle) {
+        snd_pcm_drain(pcm_handle);
+        snd_pcm_close(pcm_handle);
+        pcm_handle = nullptr;
+    }
+}
+
+bool AudioEngine::mapRaw(const std::string& path, Clip& clip) {
+    std::string raw = path.substr(0, path.find_last_of('.')) + ".pcm";
+    int fd = open(raw.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < static_cast<off_t>(CHANNELS * sizeof(int16_t))) {
+        close(fd);
+        return false;
+    }
+
+    void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) return false;
+
+    clip.mapped = addr;
+    clip.mapped_len = st.st_size;
+    clip.data = static_cast<const int16_t*>(addr);
+    // 只取整帧
+    clip.samples = (st.st_size / sizeof(int16_t)) / CHANNELS * CHANNELS;
+    return true;
+}
+
+bool AudioEngine::decode(const std::string& path, Clip& clip) {
+    SF_INFO info{};
+    SNDFILE* file = sf_open(path.c_str(), SFM_READ, &info);
+    if (!file) {
+        std::cerr << "[ERROR] Failed to decode audio " << path << ": " << sf_strerror(nullptr) << std::endl;
+        return false;
+    }
+
+    std::vector<float> src(static_cast<size_t>(info.frames) * info.channels);
+    sf_count_t frames = sf_readf_float(file, src.data(), info.frames);
+    sf_close(file);
+    if (frames <= 0) return false;
+
+    // 统一转换为 SAMPLE_RATE 立体声（线性插值重采样，提示音足够用）
+    double step = static_cast<double>(info.samplerate) / SAMPLE_RATE;
+    size_t out_frames = static_cast<size_t>(frames / step);
+    std::vector<int16_t>& out = clip.decoded;
+    out.resize(out_frames * CHANNELS);
+
+    for (size_t i = 0; i < out_frames; ++i) {
+        double t = i * step;
+        sf_count_t i0 = static_cast<sf_count_t>(t);
+        sf_count_t i1 = std::min(i0 + 1, frames - 1);
+        float frac = static_cast<float>(t - i0);
+        for (unsigned ch = 0; ch < CHANNELS; ++ch) {
+            int src_ch = std::min<int>(ch, info.channels - 1);
+            float a = src[i0 * info.channels + src_ch];
+            float b = src[i1 * info.channels + src_ch];
+            float v = std::clamp(a + (b - a) * frac, -1.0f, 1.0f);
+            out[i * CHANNELS + ch] = static_cast<int16_t>(std::lrint(v * 32767.0f));
+        }
+    }
+
+    clip.data = out.data();
+    clip.samples = out.size();
+    return !out.empty();
+}
+
+bool AudioEngine::load(const std::string& name, const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (clips.count(name)) return true;
+    }
+
+    Clip clip;
+    if (!mapRaw(path, clip) && !decode(path, clip)) return false;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    auto res = clips.emplace(name, std::move(clip));
+    if (!res.second && clip.mapped) {
+        // 并发重复加载，丢弃这一份映射
+        munmap(clip.mapped, clip.mapped_len);
+    }
+    return true;
+}
+
+const AudioEngine::Clip* AudioEngine::findOrLoad(const std::string& name) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = clips.find(name);
+        if (it != clips.end()) return &it->second;
+    }
+    if (!load(name, name)) return nullptr;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    return &clips.at(name);
+}
+
+void AudioEngine::start(const std::string& name, bool looping) {
+    if (!running.load()) {
+        std::cerr << "[DEBUG] Audio engine not running, skip prompt: " << name << std::endl;
+        return;
+    }
+
+    const Clip* clip = findOrLoad(name);
+    if (!clip) return;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    Voice* slot = nullptr;
+    for (auto& v : voices) {
+        if (looping && v.clip == clip && v.looping) return;
+        if (!v.clip && !slot) slot = &v;
+    }
+    if (!slot) {
+        std::cerr << "[DEBUG] Too many overlapping prompts, skip: " << name << std::endl;
+        return;
+    }
+    slot->clip = clip;
+    slot->pos = 0;
+    slot->looping = looping;
+    ++active_voices;
+    cv.notify_one();
+}
+
+void AudioEngine::play(const std::string& name) {
+    start(name, false);
+}
+
+void AudioEngine::loop(const std::string& name) {
+    start(name, true);
+}
+
+void AudioEngine::stop(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = clips.find(name);
+    if (it == clips.end()) return;
+    for (auto& v : voices) {
+        if (v.clip == &it->second) {
+            v.clip = nullptr;
+            --active_voices;
+        }
+    }
+}
+
+void AudioEngine::writePeriod(const int16_t* data) {
+    // 空闲后再次播放时设备处于欠载状态，recover 后重写即可
+    snd_pcm_sframes_t written = snd_pcm_writei(pcm_handle, data, PERIOD_FRAMES);
+    if (written < 0) {
+        written = snd_pcm_recover(pcm_handle, static_cast<int>(written), 1);
+        if (written >= 0) written = snd_pcm_writei(pcm_handle, data, PERIOD_FRAMES);
+    }
+    if (written < 0) {
+        std::cerr << "[ERROR] Audio write failed: " << snd_strerror(static_cast<int>(written)) << std::endl;
+    }
+}
+
+void AudioEngine::mixLoop() {
+    ThreadProfile::apply(ThreadProfile::Role::Audio);
+    const size_t period_samples = PERIOD_FRAMES * CHANNELS;
+    std::vector<int32_t> acc(period_samples);
+    std::vector<int16_t> out(period_samples);
+
+    while (running.load()) {
+        const int16_t* direct = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [this] { return active_voices > 0 || !running.load(); });
+            if (!running.load()) break;
+
+            // 单路且剩余数据足够一个周期：直接把缓存交给设备，不拷贝
+            if (active_voices == 1) {
+                for (auto& v : voices) {
+                    if (v.clip && v.clip->samples - v.pos >= period_samples) {
+                        direct = v.clip->data + v.pos;
+                        v.pos += period_samples;
+                        if (v.pos == v.clip->samples) {
+                            if (v.looping) {
+                                v.pos = 0;
+                            } else {
+                                v.clip = nullptr;
+                                --active_voices;
+                            }
+                        }
+                    }
+                }
+            }
+
+            if (!direct) {
+                std::fill(acc.begin(), acc.end(), 0);
+                for (auto& v : voices) {
+                    if (!v.clip) continue;
+                    const int16_t* src = v.clip->data;
+                    size_t i = 0;
+                    while (i < period_samples) {
+                        size_t n = std::min(period_samples - i, v.clip->samples - v.pos);
+                        for (size_t k = 0; k < n; ++k) acc[i + k] += src[v.pos + k];
+                        i += n;
+                        v.pos += n;
+                        if (v.pos < v.clip->samples) continue;
+                        // 循环音回到开头继续填满本周期，首尾无缝衔接
+                        if (v.looping) {
+                            v.pos = 0;
+                        } else {
+                            v.clip = nullptr;
+                            --active_voices;
+                            break;
+                        }
+                    }
+                }
+                for (size_t i = 0; i < period_samples; ++i) {
+                    out[i] = static_cast<int16_t>(std::clamp<int32_t>(acc[i], -32768, 32767));
+                }
+            }
+        }
+
+        writePeriod(direct ? direct : out.data());
+    }
+}
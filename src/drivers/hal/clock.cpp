@@ -0,0 +1,27 @@
+#include "clock.h"
+#include <atomic>
+#include <thread>
+
+namespace Clock {
+
+static std::atomic<ClockSource*> current{nullptr};
+
+void setSource(ClockSource* source) {
+    current.store(source);
+}
+
+uint64_t nowNs() {
+    if (ClockSource* s = current.load()) return s->nowNs();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void sleepNs(uint64_t ns) {
+    if (ClockSource* s = current.load()) {
+        s->sleepNs(ns);
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::nanoseconds(ns));
+}
+
+}  // namespace Clock
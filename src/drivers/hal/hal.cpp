@@ -0,0 +1,177 @@
+#include "hal.h"
+#include "sim_board.h"
+#include <gpiod.h>
+#include <fcntl.h>
+#include <linux/i2c-dev.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace Hal {
+
+static std::atomic<int> selected{-1};
+
+Backend backend() {
+    int b = selected.load();
+    if (b < 0) {
+        const char* env = std::getenv("ROBO_HAL");
+        b = (env && std::strcmp(env, "sim") == 0) ? static_cast<int>(Backend::Sim) : static_cast<int>(Backend::Real);
+        selected.store(b);
+    }
+    return static_cast<Backend>(b);
+}
+
+void setBackend(Backend b) {
+    selected.store(static_cast<int>(b));
+}
+
+// 所有驱动共用一个 gpiochip0 句柄，最后一根线释放时关闭
+static std::shared_ptr<gpiod_chip> openChip() {
+    static std::mutex mtx;
+    static std::weak_ptr<gpiod_chip> cached;
+    std::lock_guard<std::mutex> lock(mtx);
+    auto chip = cached.lock();
+    if (!chip) {
+        gpiod_chip* raw = gpiod_chip_open_by_name("gpiochip0");
+        if (!raw) throw std::runtime_error("无法打开 GPIO 芯片");
+        chip.reset(raw, gpiod_chip_close);
+        cached = chip;
+    }
+    return chip;
+}
+
+class GpiodLine : public GpioLine {
+public:
+    GpiodLine(int offset, const char* consumer, bool output, int initial) : chip(openChip()) {
+        line = gpiod_chip_get_line(chip.get(), offset);
+        if (!line) throw std::runtime_error("无法获取 GPIO 线 " + std::to_string(offset));
+        int ret = output ? gpiod_line_request_output(line, consumer, initial)
+                         : gpiod_line_request_input(line, consumer);
+        if (ret < 0) throw std::runtime_error("无法设置 GPIO 线方向 " + std::to_string(offset));
+    }
+
+    ~GpiodLine() override {
+        gpiod_line_release(line);
+    }
+
+    void set(int value) override { gpiod_line_set_value(line, value); }
+    int get() override { return gpiod_line_get_value(line); }
+
+private:
+    std::shared_ptr<gpiod_chip> chip;
+    gpiod_line* line = nullptr;
+};
+
+// 请求双边沿事件的输入线：内核在中断里记录边沿时间，测脉宽不受测量线程被抢占影响
+class GpiodEdgeLine : public GpioLine {
+public:
+    GpiodEdgeLine(int offset, const char* consumer) : chip(openChip()) {
+        line = gpiod_chip_get_line(chip.get(), offset);
+        if (!line) throw std::runtime_error("无法获取 GPIO 线 " + std::to_string(offset));
+        if (gpiod_line_request_both_edges_events(line, consumer) < 0) {
+            throw std::runtime_error("无法请求 GPIO 边沿事件 " + std::to_string(offset));
+        }
+    }
+
+    ~GpiodEdgeLine() override {
+        gpiod_line_release(line);
+    }
+
+    void set(int) override {}
+    int get() override { return gpiod_line_get_value(line); }
+
+    int waitLevel(int level, int timeout_us, uint64_t& t_ns) override {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeout_us);
+        while (true) {
+            auto left = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - std::chrono::steady_clock::now());
+            if (left.count() <= 0) return 0;
+            timespec ts{static_cast<time_t>(left.count() / 1000000000), static_cast<long>(left.count() % 1000000000)};
+            int rc = gpiod_line_event_wait(line, &ts);
+            if (rc <= 0) return rc;
+            gpiod_line_event ev;
+            if (gpiod_line_event_read(line, &ev) < 0) return -1;
+            // 相反方向的边沿（上一次测量留下的）跳过
+            if ((ev.event_type == GPIOD_LINE_EVENT_RISING_EDGE) != (level == 1)) continue;
+            t_ns = static_cast<uint64_t>(ev.ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ev.ts.tv_nsec);
+            return 1;
+        }
+    }
+
+    void clearEdges() override {
+        timespec zero{0, 0};
+        gpiod_line_event ev;
+        while (gpiod_line_event_wait(line, &zero) > 0 && gpiod_line_event_read(line, &ev) == 0) {}
+    }
+
+private:
+    std::shared_ptr<gpiod_chip> chip;
+    gpiod_line* line = nullptr;
+};
+
+class LinuxI2cBus : public I2cBus {
+public:
+    LinuxI2cBus(const char* device, uint8_t address) {
+        if ((file = open(device, O_RDWR)) < 0) {
+            throw std::runtime_error("Failed to open I2C device");
+        }
+        if (ioctl(file, I2C_SLAVE, address) < 0) {
+            close(file);
+            throw std::runtime_error("Failed to set I2C address");
+        }
+    }
+
+    ~LinuxI2cBus() override {
+        if (file >= 0) close(file);
+    }
+
+    bool writeRegister(uint8_t reg, uint8_t value) override {
+        uint8_t buffer[2] = {reg, value};
+        return write(file, buffer, 2) == 2;
+    }
+
+    bool readRegisters(uint8_t reg, uint8_t* buf, size_t len) override {
+        if (write(file, &reg, 1) != 1) return false;
+        return read(file, buf, len) == static_cast<ssize_t>(len);
+    }
+
+private:
+    int file = -1;
+};
+
+std::unique_ptr<GpioLine> outputLine(int offset, const char* consumer, int initial) {
+    if (backend() == Backend::Sim) return SimBoard::instance().openLine(offset, true, initial);
+    return std::make_unique<GpiodLine>(offset, consumer, true, initial);
+}
+
+std::unique_ptr<GpioLine> inputLine(int offset, const char* consumer) {
+    if (backend() == Backend::Sim) return SimBoard::instance().openLine(offset, false, 0);
+    return std::make_unique<GpiodLine>(offset, consumer, false, 0);
+}
+
+std::unique_ptr<GpioLine> edgeLine(int offset, const char* consumer) {
+    if (backend() == Backend::Sim) return SimBoard::instance().openLine(offset, false, 0);
+    return std::make_unique<GpiodEdgeLine>(offset, consumer);
+}
+
+std::unique_ptr<PwmChannel> softPwm(int offset, const char* consumer, int period_us, ThreadProfile::Role role) {
+    return std::make_unique<SoftPwmChannel>(outputLine(offset, consumer, 0), period_us, role);
+}
+
+std::unique_ptr<PwmChannel> hardwarePwm(int chip, int channel, int period_us) {
+    if (backend() == Backend::Sim) {
+        return std::make_unique<SoftPwmChannel>(SimBoard::instance().openLine(1000 + chip * 10 + channel, true, 0), period_us);
+    }
+    return std::make_unique<SysfsPwmChannel>(chip, channel, period_us);
+}
+
+std::unique_ptr<I2cBus> i2cBus(const char* device, uint8_t address) {
+    if (backend() == Backend::Sim) return SimBoard::instance().openI2c(address);
+    return std::make_unique<LinuxI2cBus>(device, address);
+}
+
+}  // namespace Hal
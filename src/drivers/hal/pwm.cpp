@@ -1,23 +1,29 @@
 #include "motor.h"
+#include "metrics.h"
+#include "thread_profile.h"
 
-void Motor::pwmLoop(gpiod_line* pin1, gpiod_line* pin2, std::atomic<int>& duty, std::atomic<bool>& direction) {
+void Motor::pwmLoop(GpioLine* pin1, GpioLine* pin2, std::atomic<int>& duty, std::atomic<bool>& direction) {
+    ThreadProfile::apply(ThreadProfile::Role::MotorPwm);
     int period_us = 1000000 / PWM_FREQUENCY;
+    static const Metrics::Loop& loop = Metrics::loop("motor_pwm", period_us * 1000ull, "Motor soft-PWM loop");
+    Metrics::LoopTimer timer(loop);
     while (running.load()) {
+        timer.tick();
         int currentDuty = duty.load();
         int high_time_us = (period_us * currentDuty) / PWM_RESOLUTION;
         bool dir = direction.load();
 
-        gpiod_line_set_value(pin1, dir ? 1 : 0);
-        gpiod_line_set_value(pin2, dir ? 0 : 1);
+        pin1->set(dir ? 1 : 0);
+        pin2->set(dir ? 0 : 1);
 
         if (high_time_us > 0)
             std::this_thread::sleep_for(std::chrono::microseconds(high_time_us));
         if (currentDuty < 100) {
-            gpiod_line_set_value(pin1, 0);
-            gpiod_line_set_value(pin2, 0);
+            pin1->set(0);
+            pin2->set(0);
             std::this_thread::sleep_for(std::chrono::microseconds(period_us - high_time_us));
         }
     }
-    gpiod_line_set_value(pin1, 0);
-    gpiod_line_set_value(pin2, 0);
+    pin1->set(0);
+    pin2->set(0);
 }
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "pwm_channel.h"
+#include "metrics.h"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <unistd.h>
+
+SoftPwmChannel::SoftPwmChannel(std::unique_ptr<GpioLine> line, int period_us, ThreadProfile::Role role)
+    : line(std::move(line)),
+      period_us(period_us),
+      pulse_us(0),
+      enabled(true),
+      running(true),
+      role(role)
+{
+    pwm_thread = std::thread(&SoftPwmChannel::pwmLoop, this);
+}
+
+SoftPwmChannel::~SoftPwmChannel() {
+    running.store(false);
+    if (pwm_thread.joinable()) pwm_thread.join();
+    line->set(0);
+}
+
+void SoftPwmChannel::setPeriodUs(int us) {
+    if (us > 0) period_us.store(us);
+}
+
+void SoftPwmChannel::setPulseUs(int us) {
+    pulse_us.store(us < 0 ? 0 : us);
+}
+
+void SoftPwmChannel::enable(bool on) {
+    enabled.store(on);
+}
+
+void SoftPwmChannel::pwmLoop() {
+    // 实时调度和绑定核心由线程配置决定，防止迁移带来的抖动
+    ThreadProfile::apply(role);
+
+    const Metrics::Loop& loop = Metrics::loop("soft_pwm{period_us=\"" + std::to_string(period_us.load()) + "\"}",
+                                              period_us.load() * 1000ull, "Soft-PWM channel loop");
+    Metrics::LoopTimer timer(loop);
+    while (running.load()) {
+        timer.tick();
+        int period = period_us.load();
+        int high = enabled.load() ? pulse_us.load() : 0;
+        if (high > period) high = period;
+
+        if (high > 0) {
+            line->set(1);
+            std::this_thread::sleep_for(std::chrono::microseconds(high));
+        }
+        if (high < period) {
+            line->set(0);
+            std::this_thread::sleep_for(std::chrono::microseconds(period - high));
+        }
+    }
+}
+
+SysfsPwmChannel::SysfsPwmChannel(int chip, int channel, int period_us) {
+    std::string chippath = "/sys/class/pwm/pwmchip" + std::to_string(chip);
+    path = chippath + "/pwm" + std::to_string(channel);
+
+    FILE* fp = fopen((chippath + "/export").c_str(), "w");
+    if (!fp) {
+        throw std::runtime_error("PWM 设备不存在，请在 /boot/firmware/config.txt 中添加 dtoverlay=pwm-2chan");
+    }
+    fprintf(fp, "%d", channel);
+    fclose(fp);
+    usleep(100000);  // 等待 pwmN 子目录创建
+
+    setPeriodUs(period_us);
+    setPulseUs(0);
+    enable(true);
+}
+
+SysfsPwmChannel::~SysfsPwmChannel() {
+    enable(false);
+}
+
+bool SysfsPwmChannel::writeSys(const std::string& name, long long value) const {
+    FILE* fp = fopen((path + "/" + name).c_str(), "w");
+    if (!fp) return false;
+    int r = fprintf(fp, "%lld", value);
+    fclose(fp);
+    return r > 0;
+}
+
+void SysfsPwmChannel::setPeriodUs(int us) {
+    writeSys("period", us * 1000LL);
+}
+
+void SysfsPwmChannel::setPulseUs(int us) {
+    writeSys("duty_cycle", us * 1000LL);
+}
+
+void SysfsPwmChannel::enable(bool on) {
+    writeSys("enable", on ? 1 : 0);
+}
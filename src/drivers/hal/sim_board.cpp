@@ -0,0 +1,157 @@
+#include "sim_board.h"
+#include "clock.h"
+#include <cstring>
+
+// 仿真 GPIO 句柄：只是指向板上 Line 状态的视图
+class SimBoard::SimGpioLine : public GpioLine {
+public:
+    SimGpioLine(SimBoard& board, Line& line) : board(board), line(line) {}
+
+    void set(int value) override {
+        value = value ? 1 : 0;
+        if (line.value.exchange(value) != value) board.recordEdge(line, value);
+    }
+
+    int get() override {
+        if (!line.output && line.input_handler) return line.input_handler(board.now());
+        return line.value.load();
+    }
+
+private:
+    SimBoard& board;
+    Line& line;
+};
+
+class SimBoard::SimI2cBus : public I2cBus {
+public:
+    SimI2cBus(SimBoard& board, I2cDevice& dev) : board(board), dev(dev) {}
+
+    bool writeRegister(uint8_t reg, uint8_t value) override {
+        std::lock_guard<std::mutex> lock(dev.mtx);
+        dev.regs[reg] = value;
+        dev.write_log.push_back({board.now(), reg, value});
+        return true;
+    }
+
+    bool readRegisters(uint8_t reg, uint8_t* buf, size_t len) override {
+        std::unique_lock<std::mutex> lock(dev.mtx);
+        ++dev.reads;
+        if (dev.read_handler) {
+            auto handler = dev.read_handler;
+            lock.unlock();
+            return handler(reg, buf, len);
+        }
+
+        auto it = dev.scripted.find(reg);
+        if (it != dev.scripted.end() && !it->second.empty()) {
+            std::vector<uint8_t> bytes = std::move(it->second.front());
+            it->second.pop_front();
+            size_t n = bytes.size() < len ? bytes.size() : len;
+            std::memcpy(buf, bytes.data(), n);
+            std::memset(buf + n, 0, len - n);
+            return true;
+        }
+        for (size_t i = 0; i < len; ++i) buf[i] = dev.regs[(reg + i) & 0xFF];
+        return true;
+    }
+
+private:
+    SimBoard& board;
+    I2cDevice& dev;
+};
+
+std::vector<SimBoard::Edge> SimBoard::Line::edges() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return log;
+}
+
+void SimBoard::Line::clearEdges() {
+    std::lock_guard<std::mutex> lock(mtx);
+    log.clear();
+    dropped = 0;
+}
+
+void SimBoard::I2cDevice::script(uint8_t reg, std::vector<uint8_t> bytes) {
+    std::lock_guard<std::mutex> lock(mtx);
+    scripted[reg].push_back(std::move(bytes));
+}
+
+std::vector<SimBoard::I2cDevice::Write> SimBoard::I2cDevice::writes() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return write_log;
+}
+
+SimBoard& SimBoard::instance() {
+    static SimBoard board;
+    return board;
+}
+
+void SimBoard::setClock(std::function<uint64_t()> c) {
+    std::lock_guard<std::mutex> lock(mtx);
+    clock = std::move(c);
+}
+
+uint64_t SimBoard::now() const {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (clock) return clock();
+    }
+    return Clock::nowNs();
+}
+
+SimBoard::Line& SimBoard::line(int offset) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto& l = lines[offset];
+    if (!l) {
+        l = std::make_unique<Line>();
+        l->offset = offset;
+    }
+    return *l;
+}
+
+SimBoard::I2cDevice& SimBoard::i2c(uint8_t address) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto& d = devices[address];
+    if (!d) {
+        d = std::make_unique<I2cDevice>();
+        d->address = address;
+    }
+    return *d;
+}
+
+void SimBoard::reset() {
+    std::lock_guard<std::mutex> lock(mtx);
+    lines.clear();
+    devices.clear();
+    clock = nullptr;
+}
+
+std::unique_ptr<GpioLine> SimBoard::openLine(int offset, bool output, int initial) {
+    Line& l = line(offset);
+    l.output = output;
+    if (output) l.value.store(initial ? 1 : 0);
+    return std::make_unique<SimGpioLine>(*this, l);
+}
+
+std::unique_ptr<I2cBus> SimBoard::openI2c(uint8_t address) {
+    return std::make_unique<SimI2cBus>(*this, i2c(address));
+}
+
+void SimBoard::recordEdge(Line& l, int value) {
+    // 不记录也没有回调时不取时间戳，避免 PWM 线程频繁去抢仿真时钟的锁
+    if (edge_limit.load() == 0 && !l.edge_handler) {
+        std::lock_guard<std::mutex> lock(l.mtx);
+        ++l.dropped;
+        return;
+    }
+    Edge e{now(), value};
+    {
+        std::lock_guard<std::mutex> lock(l.mtx);
+        if (l.log.size() < edge_limit.load()) {
+            l.log.push_back(e);
+        } else {
+            ++l.dropped;
+        }
+    }
+    if (l.edge_handler) l.edge_handler(e);
+}
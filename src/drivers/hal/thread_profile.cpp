@@ -0,0 +1,287 @@
+#include "thread_profile.h"
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <json.hpp>
+
+#define DEFAULT_CONFIG_PATH "../config/threads.json"
+#define ROLE_COUNT 10
+
+namespace ThreadProfile {
+
+namespace {
+
+std::mutex mtx;
+std::atomic<bool> ready{false};
+Profile profiles[ROLE_COUNT];
+std::atomic<bool> warned[ROLE_COUNT];
+
+const char* ROLE_NAMES[ROLE_COUNT] = {
+    "none", "motor_pwm", "servo_pwm", "imu", "ultrasonic", "nav", "audio", "vision", "gui", "background"
+};
+
+bool isControl(Role role) {
+    switch (role) {
+    case Role::MotorPwm:
+    case Role::ServoPwm:
+    case Role::Imu:
+    case Role::Ultrasonic:
+    case Role::Nav:
+        return true;
+    default:
+        return false;
+    }
+}
+
+int parsePolicy(const std::string& name) {
+    if (name == "fifo") return SCHED_FIFO;
+    if (name == "rr") return SCHED_RR;
+    return SCHED_OTHER;
+}
+
+const char* policyName(int policy) {
+    if (policy == SCHED_FIFO) return "fifo";
+    if (policy == SCHED_RR) return "rr";
+    return "other";
+}
+
+// "2-3,5" 形式的 CPU 列表（/sys/devices/system/cpu/isolated）
+std::set<int> parseCpuList(const std::string& text) {
+    std::set<int> cpus;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty() || item == "\n") continue;
+        size_t dash = item.find('-');
+        int lo = std::atoi(item.c_str());
+        int hi = dash == std::string::npos ? lo : std::atoi(item.c_str() + dash + 1);
+        for (int c = lo; c <= hi; ++c) cpus.insert(c);
+    }
+    return cpus;
+}
+
+std::set<int> controlCpus() {
+    std::set<int> cpus;
+    for (int i = 0; i < ROLE_COUNT; ++i) {
+        if (profiles[i].control) cpus.insert(profiles[i].cpus.begin(), profiles[i].cpus.end());
+    }
+    return cpus;
+}
+
+std::string cpuString(const std::vector<int>& cpus) {
+    std::string s;
+    for (int c : cpus) s += (s.empty() ? "" : ",") + std::to_string(c);
+    return s.empty() ? "any" : s;
+}
+
+// 没有配置文件时保持原来的行为：只有舵机 PWM 走 FIFO 80 并绑定核心 2
+void loadDefaults() {
+    for (int i = 0; i < ROLE_COUNT; ++i) {
+        profiles[i] = Profile();
+        profiles[i].policy = SCHED_OTHER;
+        profiles[i].control = isControl(static_cast<Role>(i));
+    }
+    Profile& servo = profiles[static_cast<int>(Role::ServoPwm)];
+    servo.policy = SCHED_FIFO;
+    servo.priority = 80;
+    servo.cpus = {2};
+}
+
+bool loadFile(const std::string& path, bool& lock_memory) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+
+    nlohmann::json j;
+    try {
+        in >> j;
+    } catch (const std::exception& e) {
+        std::cerr << "[ERROR] Failed to parse thread config " << path << ": " << e.what() << "\n";
+        return false;
+    }
+
+    lock_memory = j.value("mlockall", false);
+    if (!j.contains("roles") || !j["roles"].is_object()) return true;
+    for (int i = 1; i < ROLE_COUNT; ++i) {
+        if (!j["roles"].contains(ROLE_NAMES[i])) continue;
+        const auto& r = j["roles"][ROLE_NAMES[i]];
+        Profile& p = profiles[i];
+        p.policy = parsePolicy(r.value("policy", std::string("other")));
+        p.priority = p.policy == SCHED_OTHER ? 0 : r.value("priority", 1);
+        p.cpus = r.value("cpus", std::vector<int>());
+    }
+    return true;
+}
+
+// 非控制角色没写 cpus 时放到控制核心以外的全部核心上
+void fillNonControlCpus() {
+    std::set<int> control = controlCpus();
+    if (control.empty()) return;
+    std::vector<int> rest;
+    int n = static_cast<int>(std::thread::hardware_concurrency());
+    for (int c = 0; c < n; ++c) {
+        if (!control.count(c)) rest.push_back(c);
+    }
+    for (int i = 1; i < ROLE_COUNT; ++i) {
+        if (!profiles[i].control && profiles[i].cpus.empty()) profiles[i].cpus = rest;
+    }
+}
+
+}  // namespace
+
+bool configure(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (ready.load()) return true;
+
+        const char* env = std::getenv("ROBO_THREAD_CONFIG");
+        std::string file = !path.empty() ? path : (env && *env ? env : DEFAULT_CONFIG_PATH);
+
+        loadDefaults();
+        bool lock_memory = false;
+        if (!loadFile(file, lock_memory)) {
+            std::cout << "[INFO] No thread config at " << file << ", using default scheduling.\n";
+        }
+        fillNonControlCpus();
+
+        // 锁住现有和以后分配的页，控制线程不会因为缺页卡在换页上
+        if (lock_memory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+            std::cerr << "⚠️ 警告: mlockall 失败（需要 root 或调大 ulimit -l）\n";
+        }
+
+        for (int i = 1; i < ROLE_COUNT; ++i) {
+            const Profile& p = profiles[i];
+            std::cout << "[INFO] Thread role " << ROLE_NAMES[i] << ": " << policyName(p.policy)
+                      << " " << p.priority << ", cpus " << cpuString(p.cpus) << "\n";
+        }
+        ready.store(true);
+    }
+
+    // 调用线程（主线程/GUI）之后创建的线程都继承它的核心集合
+    apply(Role::Gui);
+    return checkIsolation();
+}
+
+bool configured() {
+    return ready.load();
+}
+
+const char* roleName(Role role) {
+    return ROLE_NAMES[static_cast<int>(role)];
+}
+
+Profile profile(Role role) {
+    std::lock_guard<std::mutex> lock(mtx);
+    return profiles[static_cast<int>(role)];
+}
+
+void apply(Role role) {
+    if (role == Role::None || !ready.load()) return;
+    int i = static_cast<int>(role);
+    const Profile& p = profiles[i];
+
+    bool ok = true;
+    struct sched_param sch_params;
+    sch_params.sched_priority = p.priority;
+    if (pthread_setschedparam(pthread_self(), p.policy, &sch_params) != 0) ok = false;
+
+    if (!p.cpus.empty()) {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        for (int c : p.cpus) CPU_SET(c, &cpuset);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) != 0) ok = false;
+    }
+
+    if (!ok && !warned[i].exchange(true)) {
+        std::cerr << "⚠️ 警告: 无法设置线程 " << ROLE_NAMES[i] << " 的调度参数（实时策略需要 root）\n";
+    }
+}
+
+Scope::Scope(Role role) {
+    if (role == Role::None || !ready.load()) return;
+    struct sched_param sch_params;
+    CPU_ZERO(&cpus);
+    saved = pthread_getschedparam(pthread_self(), &policy, &sch_params) == 0 &&
+            pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus) == 0;
+    priority = sch_params.sched_priority;
+    apply(role);
+}
+
+Scope::~Scope() {
+    if (!saved) return;
+    struct sched_param sch_params;
+    sch_params.sched_priority = priority;
+    pthread_setschedparam(pthread_self(), policy, &sch_params);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus);
+}
+
+bool checkIsolation() {
+    std::set<int> control;
+    std::vector<Profile> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        control = controlCpus();
+        snapshot.assign(profiles, profiles + ROLE_COUNT);
+    }
+    if (control.empty()) {
+        std::cout << "[INFO] Control threads are not pinned, skipping CPU isolation check.\n";
+        return true;
+    }
+
+    bool isolated = true;
+    int n = static_cast<int>(std::thread::hardware_concurrency());
+    for (int c : control) {
+        if (c >= n) {
+            std::cerr << "[ERROR] Control CPU " << c << " does not exist (" << n << " CPUs).\n";
+            isolated = false;
+        }
+    }
+
+    // 配置层面：视觉/GUI/音频/后台线程不能落在控制核心上
+    for (int i = 1; i < ROLE_COUNT; ++i) {
+        if (snapshot[i].control) continue;
+        for (int c : snapshot[i].cpus) {
+            if (control.count(c)) {
+                std::cerr << "[ERROR] Thread role " << ROLE_NAMES[i] << " shares control CPU " << c << ".\n";
+                isolated = false;
+            }
+        }
+    }
+
+    // 运行层面：主线程的核心集合会被 Qt/OpenCV 的工作线程继承
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) == 0) {
+        for (int c : control) {
+            if (c < CPU_SETSIZE && CPU_ISSET(c, &cpuset)) {
+                std::cerr << "[ERROR] Main thread may run on control CPU " << c
+                          << ", vision and GUI threads will inherit it.\n";
+                isolated = false;
+            }
+        }
+    }
+
+    // 内核层面：不在 isolcpus 里的核心仍可能跑别的进程和内核线程，只提示
+    std::ifstream sys("/sys/devices/system/cpu/isolated");
+    std::string text;
+    std::getline(sys, text);
+    std::set<int> kernel_isolated = parseCpuList(text);
+    for (int c : control) {
+        if (!kernel_isolated.count(c)) {
+            std::cout << "[INFO] Control CPU " << c
+                      << " is not isolated by the kernel; add isolcpus= to cmdline.txt to keep other processes off it.\n";
+        }
+    }
+
+    if (isolated) std::cout << "[INFO] Control CPUs are isolated from vision and GUI threads.\n";
+    return isolated;
+}
+
+}  // namespace ThreadProfile
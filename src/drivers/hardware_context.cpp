@@ -0,0 +1,107 @@
+#include "hardware_context.h"
+#include "trace.h"
+#include "metrics.h"
+#include "thread_profile.h"
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+
+HardwareContext& HardwareContext::instance() {
+    static HardwareContext context;
+    return context;
+}
+
+HardwareContext::~HardwareContext() {
+    shutdown();
+}
+
+bool HardwareContext::init() {
+    std::lock_guard<std::mutex> lock(mtx);
+
+    // 设备线程在下面创建，先确定各角色的调度策略和核心（main() 里已调用过则直接返回）
+    ThreadProfile::configure();
+
+    // 设置了 ROBO_TRACE_DIR 时，本次开机的传感器与控制指令都记录到该目录
+    const char* trace_dir = std::getenv("ROBO_TRACE_DIR");
+    if (trace_dir && *trace_dir && !Trace::active()) {
+        char name[64];
+        std::time_t now = std::time(nullptr);
+        std::tm tm{};
+        localtime_r(&now, &tm);
+        std::strftime(name, sizeof(name), "/trace-%Y%m%d-%H%M%S.rht", &tm);
+        Trace::start(std::string(trace_dir) + name);
+    }
+
+    // 本机 Prometheus 端点，ROBO_METRICS_PORT=0 关闭
+    const char* metrics_port = std::getenv("ROBO_METRICS_PORT");
+    int port = metrics_port ? std::atoi(metrics_port) : 9105;
+    if (port > 0) Metrics::serve(port);
+
+    // 每个设备单独捕获异常，缺一个不影响其他设备
+    if (!motor_) {
+        try {
+            MotorPins pins = MOTOR_PINS;
+            motor_ = std::make_unique<Motor>(pins);
+        } catch (const std::exception& e) {
+            std::cerr << "[ERROR] Motor init failed: " << e.what() << "\n";
+        }
+    }
+    if (!servo_) {
+        try {
+            servo_ = std::make_unique<Servo>(SERVO_PIN);
+        } catch (const std::exception& e) {
+            std::cerr << "[ERROR] Servo init failed: " << e.what() << "\n";
+        }
+    }
+    if (!yaw_) {
+        try {
+            yaw_ = std::make_unique<YawTracker>();
+            // 提前启动姿态融合，第一次转弯前滤波器已收敛
+            yaw_->start(YAW_RATE_HZ);
+        } catch (const std::exception& e) {
+            std::cerr << "[ERROR] IMU init failed: " << e.what() << "\n";
+            yaw_.reset();
+        }
+    }
+    if (!ultrasonic_) {
+        try {
+            ultrasonic_ = std::make_unique<UltrasonicSensor>();
+        } catch (const std::exception& e) {
+            std::cerr << "[DEBUG] Ultrasonic sensor unavailable, obstacle governor disabled: " << e.what() << "\n";
+        }
+    }
+
+    bool ok = motor_ && servo_ && yaw_;
+    if (ok) std::cout << "[INFO] Hardware context ready.\n";
+    return ok;
+}
+
+void HardwareContext::shutdown() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (motor_) motor_->stop();
+    ultrasonic_.reset();
+    yaw_.reset();
+    servo_.reset();
+    motor_.reset();
+    Trace::stop();
+    Metrics::stopServing();
+}
+
+bool HardwareContext::ready() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return motor_ && servo_ && yaw_;
+}
+
+bool HardwareContext::tryAcquire() {
+    return !busy.exchange(true);
+}
+
+void HardwareContext::release() {
+    busy.store(false);
+}
+
+void HardwareContext::stopAll() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (motor_) motor_->stop();
+    if (servo_) servo_->center();
+}
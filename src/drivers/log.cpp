@@ -0,0 +1,207 @@
+#include "log.h"
+#include "thread_profile.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define LOG_RING_RECORDS 1024      // 每个线程的缓冲条数（约 130KB）
+#define LOG_POLL_MS 5
+
+namespace Log {
+
+namespace {
+
+struct Ring {
+    alignas(64) std::atomic<size_t> head{0};   // 生产者推进
+    alignas(64) std::atomic<size_t> tail{0};   // 后台线程推进
+    std::atomic<bool> orphaned{false};         // 所属线程已退出
+    Record slots[LOG_RING_RECORDS];
+};
+
+class Logger {
+public:
+    static Logger& instance() {
+        // 不析构：退出阶段其他静态对象的析构函数里仍可能写日志
+        static Logger* logger = new Logger();
+        return *logger;
+    }
+
+    std::shared_ptr<Ring> add() {
+        auto ring = std::make_shared<Ring>();
+        std::lock_guard<std::mutex> lock(mtx);
+        rings.push_back(ring);
+        return ring;
+    }
+
+    // 等到调用时刻之前写入的记录都已输出
+    void flush() {
+        std::vector<std::pair<std::shared_ptr<Ring>, size_t>> marks;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            for (auto& r : rings) marks.emplace_back(r, r->head.load(std::memory_order_acquire));
+        }
+        for (auto& m : marks) {
+            while (m.first->tail.load(std::memory_order_acquire) < m.second) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        std::lock_guard<std::mutex> lock(output_mtx);
+    }
+
+    std::atomic<Level> threshold{static_cast<Level>(LOG_LEVEL < LOG_LEVEL_OFF ? LOG_LEVEL : LOG_LEVEL_ERROR)};
+    std::atomic<uint64_t> lost{0};
+
+private:
+    Logger() {
+        worker = std::thread(&Logger::run, this);
+        worker.detach();
+        std::atexit([] { Logger::instance().flush(); });
+    }
+
+    void run() {
+        // 第一条日志常来自控制线程，别继承它的实时策略和核心
+        ThreadProfile::apply(ThreadProfile::Role::Background);
+        std::vector<Record> batch;
+        std::vector<std::shared_ptr<Ring>> snapshot;
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                snapshot = rings;
+            }
+
+            std::lock_guard<std::mutex> out(output_mtx);
+            batch.clear();
+            for (auto& r : snapshot) {
+                size_t tail = r->tail.load(std::memory_order_relaxed);
+                size_t head = r->head.load(std::memory_order_acquire);
+                for (size_t i = tail; i < head; ++i) batch.push_back(r->slots[i % LOG_RING_RECORDS]);
+                r->tail.store(head, std::memory_order_release);
+            }
+
+            // 各线程的记录按时间合并
+            std::stable_sort(batch.begin(), batch.end(),
+                             [](const Record& a, const Record& b) { return a.t_ns < b.t_ns; });
+            for (const auto& rec : batch) emit(rec);
+            if (!batch.empty()) {
+                std::fflush(stdout);
+                std::fflush(stderr);
+            }
+
+            // 线程已退出且缓冲已取空的直接移除
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                rings.erase(std::remove_if(rings.begin(), rings.end(), [](const std::shared_ptr<Ring>& r) {
+                    return r->orphaned.load() && r->tail.load() == r->head.load();
+                }), rings.end());
+            }
+            snapshot.clear();
+
+            if (batch.empty()) std::this_thread::sleep_for(std::chrono::milliseconds(LOG_POLL_MS));
+        }
+    }
+
+    void emit(const Record& r) {
+        line.clear();
+        int arg = 0;
+        for (const char* p = r.fmt; *p; ++p) {
+            if (p[0] == '{' && p[1] == '}' && arg < r.nargs) {
+                appendArg(r, arg++);
+                ++p;
+            } else {
+                line.push_back(*p);
+            }
+        }
+        line.push_back('\n');
+        std::fwrite(line.data(), 1, line.size(), r.level >= Warn ? stderr : stdout);
+    }
+
+    void appendArg(const Record& r, int i) {
+        char buf[32];
+        switch (r.kinds[i]) {
+        case Record::Int:
+            std::snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(r.values[i].i));
+            break;
+        case Record::Uint:
+            std::snprintf(buf, sizeof(buf), "%llu", static_cast<unsigned long long>(r.values[i].u));
+            break;
+        case Record::Float:
+            std::snprintf(buf, sizeof(buf), "%g", r.values[i].f);
+            break;
+        case Record::Char:
+            line.push_back(static_cast<char>(r.values[i].i));
+            return;
+        case Record::Text:
+            line.append(r.text + r.values[i].u);
+            return;
+        }
+        line.append(buf);
+    }
+
+    std::mutex mtx;            // 只保护 rings 列表，线程第一次写日志时注册一次
+    std::mutex output_mtx;     // 后台线程输出一批期间持有，flush 借此等到输出完成
+    std::vector<std::shared_ptr<Ring>> rings;
+    std::thread worker;
+    std::string line;
+};
+
+// 线程退出时把缓冲交给后台线程处理完再释放
+struct Local {
+    std::shared_ptr<Ring> ring;
+    ~Local() {
+        if (ring) ring->orphaned.store(true);
+    }
+};
+
+thread_local Local local;
+
+Ring& ring() {
+    if (!local.ring) local.ring = Logger::instance().add();
+    return *local.ring;
+}
+
+}  // namespace
+
+Record* claim() {
+    Ring& r = ring();
+    size_t head = r.head.load(std::memory_order_relaxed);
+    if (head - r.tail.load(std::memory_order_acquire) >= LOG_RING_RECORDS) return nullptr;
+    return &r.slots[head % LOG_RING_RECORDS];
+}
+
+void publish() {
+    Ring& r = ring();
+    r.head.store(r.head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void drop() {
+    Logger::instance().lost.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t timestamp() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void setLevel(Level level) {
+    Logger::instance().threshold.store(level);
+}
+
+Level level() {
+    return Logger::instance().threshold.load(std::memory_order_relaxed);
+}
+
+uint64_t dropped() {
+    return Logger::instance().lost.load(std::memory_order_relaxed);
+}
+
+void flush() {
+    Logger::instance().flush();
+}
+
+}  // namespace Log
@@ -0,0 +1,220 @@
+#include "metrics.h"
+#include "thread_profile.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <thread>
+#include <unistd.h>
+
+// 单个抓取连接的收发超时：连上不发请求的客户端不能卡住端点和退出流程
+#define CLIENT_TIMEOUT_MS 1000
+
+namespace Metrics {
+
+namespace {
+
+struct Entry {
+    std::string help;
+    std::unique_ptr<Counter> counter;
+    std::unique_ptr<Histogram> histogram;
+};
+
+// 按名字排序，同一指标族的不同标签自然相邻
+std::mutex registry_mtx;
+std::map<std::string, Entry> registry;
+std::map<std::string, std::unique_ptr<Loop>> loops;
+
+Entry& entry(const std::string& name, const std::string& help) {
+    Entry& e = registry[name];
+    if (e.help.empty()) e.help = help;
+    return e;
+}
+
+// name{a="b"} -> name, a="b"
+void splitName(const std::string& name, std::string& base, std::string& labels) {
+    size_t brace = name.find('{');
+    if (brace == std::string::npos) {
+        base = name;
+        labels.clear();
+    } else {
+        base = name.substr(0, brace);
+        labels = name.substr(brace + 1, name.size() - brace - 2);
+    }
+}
+
+std::string withLabels(const std::string& labels, const std::string& extra = "") {
+    if (labels.empty() && extra.empty()) return "";
+    if (labels.empty()) return "{" + extra + "}";
+    if (extra.empty()) return "{" + labels + "}";
+    return "{" + labels + "," + extra + "}";
+}
+
+std::string seconds(uint64_t ns) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.9g", ns * 1e-9);
+    return buf;
+}
+
+std::mutex server_mtx;
+int server_fd = -1;
+std::thread server_thread;
+
+void serveLoop(int fd) {
+    ThreadProfile::apply(ThreadProfile::Role::Background);
+    while (true) {
+        int client = accept(fd, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            return;   // stopServing 关闭了监听套接字
+        }
+        timeval timeout{};
+        timeout.tv_sec = CLIENT_TIMEOUT_MS / 1000;
+        timeout.tv_usec = (CLIENT_TIMEOUT_MS % 1000) * 1000;
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        char request[1024];
+        ssize_t n = recv(client, request, sizeof(request) - 1, 0);
+        request[n > 0 ? n : 0] = '\0';
+
+        std::string body, status = "200 OK";
+        if (std::strncmp(request, "GET /metrics", 12) == 0 || std::strncmp(request, "GET / ", 6) == 0) {
+            body = render();
+        } else {
+            status = "404 Not Found";
+            body = "not found\n";
+        }
+        std::string response = "HTTP/1.0 " + status +
+                               "\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                               std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+        size_t sent = 0;
+        while (sent < response.size()) {
+            ssize_t w = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+            if (w <= 0) break;
+            sent += w;
+        }
+        close(client);
+    }
+}
+
+}  // namespace
+
+uint64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Counter& counter(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(registry_mtx);
+    Entry& e = entry(name, help);
+    if (!e.counter) e.counter = std::make_unique<Counter>();
+    return *e.counter;
+}
+
+Histogram& histogram(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(registry_mtx);
+    Entry& e = entry(name, help);
+    if (!e.histogram) e.histogram = std::make_unique<Histogram>();
+    return *e.histogram;
+}
+
+const Loop& loop(const std::string& name, uint64_t expected_ns, const std::string& help) {
+    {
+        std::lock_guard<std::mutex> lock(registry_mtx);
+        auto it = loops.find(name);
+        if (it != loops.end()) return *it->second;
+    }
+    // 标签放在后缀之后：soft_pwm{period_us="20000"} -> soft_pwm_period_seconds{period_us="20000"}
+    std::string base, labels;
+    splitName(name, base, labels);
+    std::string tail = labels.empty() ? "" : "{" + labels + "}";
+
+    auto l = std::make_unique<Loop>();
+    l->expected_ns = expected_ns;
+    l->period = &histogram(base + "_period_seconds" + tail, help + " period");
+    l->jitter = &histogram(base + "_jitter_seconds" + tail, help + " deviation from the target period");
+    l->overruns = &counter(base + "_overruns_total" + tail, help + " periods longer than 1.5x target");
+
+    std::lock_guard<std::mutex> lock(registry_mtx);
+    auto& slot = loops[name];
+    if (!slot) slot = std::move(l);
+    return *slot;
+}
+
+std::string render() {
+    std::lock_guard<std::mutex> lock(registry_mtx);
+    std::string out;
+    std::string last_base;
+    for (const auto& [name, e] : registry) {
+        std::string base, labels;
+        splitName(name, base, labels);
+        if (base != last_base) {
+            out += "# HELP " + base + " " + e.help + "\n";
+            out += "# TYPE " + base + (e.histogram ? " histogram\n" : " counter\n");
+            last_base = base;
+        }
+
+        if (e.counter) {
+            out += base + withLabels(labels) + " " + std::to_string(e.counter->value()) + "\n";
+        }
+        if (e.histogram) {
+            const Histogram& h = *e.histogram;
+            uint64_t cumulative = 0;
+            for (int i = 0; i < Histogram::BUCKETS; ++i) {
+                cumulative += h.bucket(i);
+                std::string le = i == Histogram::BUCKETS - 1 ? "+Inf" : seconds(1000ull << i);
+                out += base + "_bucket" + withLabels(labels, "le=\"" + le + "\"") + " " +
+                       std::to_string(cumulative) + "\n";
+            }
+            out += base + "_sum" + withLabels(labels) + " " + seconds(h.sumNs()) + "\n";
+            out += base + "_count" + withLabels(labels) + " " + std::to_string(h.samples()) + "\n";
+        }
+    }
+    return out;
+}
+
+bool serve(int port) {
+    std::lock_guard<std::mutex> lock(server_mtx);
+    if (server_fd >= 0) return true;
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);   // 只对本机开放
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(fd, 4) < 0) {
+        std::cerr << "[ERROR] Metrics endpoint cannot listen on port " << port << ": " << std::strerror(errno) << std::endl;
+        close(fd);
+        return false;
+    }
+
+    server_fd = fd;
+    server_thread = std::thread(serveLoop, fd);
+    std::cout << "[INFO] Metrics at http://127.0.0.1:" << port << "/metrics" << std::endl;
+    return true;
+}
+
+void stopServing() {
+    std::lock_guard<std::mutex> lock(server_mtx);
+    if (server_fd < 0) return;
+    // shutdown 唤醒阻塞在 accept 上的线程；正在服务的连接最多再等 CLIENT_TIMEOUT_MS
+    shutdown(server_fd, SHUT_RDWR);
+    if (server_thread.joinable()) server_thread.join();
+    close(server_fd);
+    server_fd = -1;
+}
+
+}  // namespace Metrics
@@ -1,39 +1,26 @@
 #include "motor.h"
 #include "pwm.h"
+#include "hal.h"
+#include "trace.h"
 #include <stdexcept>
 #include <iostream>
 
 Motor::Motor(const MotorPins& pins)
-    : chip(nullptr),
-      line_AIN1(nullptr),
-      line_AIN2(nullptr),
-      line_BIN1(nullptr),
-      line_BIN2(nullptr),
-      running(true),
+    : running(true),
       left_duty(0),
       right_duty(0),
       left_direction(true),
       right_direction(true),
       pins(pins)
 {
-    chip = gpiod_chip_open_by_name("gpiochip0");
-    if (!chip) throw std::runtime_error("无法打开 GPIO 芯片");
+    // 引脚经 HAL 申请，真实 gpiochip0 或仿真板由 Hal::backend() 决定
+    line_AIN1 = Hal::outputLine(pins.AIN1, "motor", 0);
+    line_AIN2 = Hal::outputLine(pins.AIN2, "motor", 0);
+    line_BIN1 = Hal::outputLine(pins.BIN1, "motor", 0);
+    line_BIN2 = Hal::outputLine(pins.BIN2, "motor", 0);
 
-    line_AIN1 = gpiod_chip_get_line(chip, pins.AIN1);
-    line_AIN2 = gpiod_chip_get_line(chip, pins.AIN2);
-    line_BIN1 = gpiod_chip_get_line(chip, pins.BIN1);
-    line_BIN2 = gpiod_chip_get_line(chip, pins.BIN2);
-
-    if (!line_AIN1 || !line_AIN2 || !line_BIN1 || !line_BIN2)
-        throw std::runtime_error("无法获取电机控制GPIO线");
-
-    gpiod_line_request_output(line_AIN1, "motor", 0);
-    gpiod_line_request_output(line_AIN2, "motor", 0);
-    gpiod_line_request_output(line_BIN1, "motor", 0);
-    gpiod_line_request_output(line_BIN2, "motor", 0);
-
-    left_pwm_thread = std::thread(&Motor::pwmLoop, this, line_AIN1, line_AIN2, std::ref(left_duty), std::ref(left_direction));
-    right_pwm_thread = std::thread(&Motor::pwmLoop, this, line_BIN1, line_BIN2, std::ref(right_duty), std::ref(right_direction));
+    left_pwm_thread = std::thread(&Motor::pwmLoop, this, line_AIN1.get(), line_AIN2.get(), std::ref(left_duty), std::ref(left_direction));
+    right_pwm_thread = std::thread(&Motor::pwmLoop, this, line_BIN1.get(), line_BIN2.get(), std::ref(right_duty), std::ref(right_direction));
 
     std::cout << "Motor driver initialized." << std::endl;
 }
@@ -47,17 +34,11 @@ void Motor::cleanup() {
     if (left_pwm_thread.joinable()) left_pwm_thread.join();
     if (right_pwm_thread.joinable()) right_pwm_thread.join();
 
-    gpiod_line_set_value(line_AIN1, 0);
-    gpiod_line_set_value(line_AIN2, 0);
-    gpiod_line_set_value(line_BIN1, 0);
-    gpiod_line_set_value(line_BIN2, 0);
-
-    gpiod_line_release(line_AIN1);
-    gpiod_line_release(line_AIN2);
-    gpiod_line_release(line_BIN1);
-    gpiod_line_release(line_BIN2);
+    line_AIN1->set(0);
+    line_AIN2->set(0);
+    line_BIN1->set(0);
+    line_BIN2->set(0);
 
-    if (chip) gpiod_chip_close(chip);
     std::cout << "Motor driver cleaned up." << std::endl;
 }
 
@@ -68,6 +49,7 @@ void Motor::forward(int dutyCycle) {
     right_direction.store(false);
     left_duty.store(dutyCycle);
     right_duty.store(dutyCycle);
+    Trace::motor(leftCommand(), rightCommand());
 }
 
 void Motor::backward(int dutyCycle) {
@@ -77,13 +59,26 @@ void Motor::backward(int dutyCycle) {
     right_direction.store(true);
     left_duty.store(dutyCycle);
     right_duty.store(dutyCycle);
+    Trace::motor(leftCommand(), rightCommand());
+}
+
+int Motor::leftCommand() const {
+    int duty = left_duty.load();
+    return left_direction.load() ? duty : -duty;
+}
+
+int Motor::rightCommand() const {
+    // 右侧电机反向安装，forward() 时方向位为 false
+    int duty = right_duty.load();
+    return right_direction.load() ? -duty : duty;
 }
 
 void Motor::stop() {
     left_duty.store(0);
     right_duty.store(0);
-    gpiod_line_set_value(line_AIN1, 0);
-    gpiod_line_set_value(line_AIN2, 0);
-    gpiod_line_set_value(line_BIN1, 0);
-    gpiod_line_set_value(line_BIN2, 0);
+    line_AIN1->set(0);
+    line_AIN2->set(0);
+    line_BIN1->set(0);
+    line_BIN2->set(0);
+    Trace::motor(0, 0);
 }
\ No newline at end of file
@@ -1,11 +1,11 @@
 // MPU6050.cpp
 #include "mpu6050.h"
-#include <fcntl.h>
-#include <unistd.h>
-#include <sys/ioctl.h>
-#include <linux/i2c-dev.h>
+#include "hal.h"
+#include "clock.h"
+#include "log.h"
+#include "metrics.h"
+#include "thread_profile.h"
 #include <chrono>
-#include <iostream>
 #include <stdexcept>
 
 #define SMPLRT_DIV    0x19
@@ -18,32 +18,25 @@
 
 MPU6050::MPU6050(const char* i2c_device, uint8_t address) 
     : running(false) {
-    // open the IIC
-    if((file = open(i2c_device, O_RDWR)) < 0) {
-        throw std::runtime_error("Failed to open I2C device");
-    }
-    
-    // set the I2C address
-    if(ioctl(file, I2C_SLAVE, address) < 0) {
-        close(file);
-        throw std::runtime_error("Failed to set I2C address");
-    }
-    
+    // 打开 I2C 并设置从机地址，失败时抛异常
+    bus = Hal::i2cBus(i2c_device, address);
+    initializeSensor();
+}
+
+MPU6050::MPU6050(std::unique_ptr<I2cBus> bus)
+    : bus(std::move(bus)), running(false) {
     initializeSensor();
 }
 
 MPU6050::~MPU6050() {
     stop();
-    if(file >= 0) {
-        close(file);
-    }
 }
 
 void MPU6050::initializeSensor() {
     try {
         // 设备复位
         writeRegister(PWR_MGMT_1, 0x80);
-        usleep(100000);  // 等待复位完成
+        Clock::sleepFor(std::chrono::milliseconds(100));  // 等待复位完成
         
         // 唤醒设备并设置时钟源
         writeRegister(PWR_MGMT_1, 0x00);
@@ -81,21 +74,27 @@ void MPU6050::stop() {
 }
 
 void MPU6050::readThreadFunc() {
+    ThreadProfile::apply(ThreadProfile::Role::Imu);
     uint8_t buffer[14];
     uint8_t reg = ACCEL_XOUT_H;
+    const Metrics::Loop& loop = Metrics::loop("imu_read", interval_ms * 1000000ull, "MPU6050 read loop");
+    static Metrics::Histogram& i2c_latency = Metrics::histogram("i2c_read_seconds", "Latency of one 14-byte MPU6050 burst read");
+    static Metrics::Counter& i2c_errors = Metrics::counter("i2c_errors_total", "Failed MPU6050 reads");
+    Metrics::LoopTimer timer(loop);
     
     while(running) {
+        timer.tick();
         try {
             // 获取时间戳
             auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
                 std::chrono::system_clock::now().time_since_epoch()).count();
             
             // 读取传感器数据
-            if(write(file, &reg, 1) != 1) {
-                throw std::runtime_error("I2C register write failed");
-            }
-            
-            if(read(file, buffer, 14) != 14) {
+            uint64_t read_start = Metrics::now();
+            bool ok = bus->readRegisters(reg, buffer, 14);
+            i2c_latency.observe(Metrics::now() - read_start);
+            if(!ok) {
+                i2c_errors.inc();
                 throw std::runtime_error("Incomplete data read");
             }
             
@@ -117,18 +116,17 @@ void MPU6050::readThreadFunc() {
             }
             
         } catch(const std::exception& e) {
-            std::cerr << "Sensor Error: " << e.what() << std::endl;
+            LOG_ERROR("Sensor Error: {}", e.what());
             running = false;
         }
         
         // 维持采样间隔
-        std::this_thread::sleep_for(std::chrono::milliseconds(this->interval_ms));
+        Clock::sleepFor(std::chrono::milliseconds(this->interval_ms));
     }
 }
 
 void MPU6050::writeRegister(uint8_t reg, uint8_t value) {
-    uint8_t buffer[2] = {reg, value};
-    if(write(file, buffer, 2) != 2) {
+    if(!bus->writeRegister(reg, value)) {
         throw std::runtime_error("Failed to write register");
     }
 }
\ No newline at end of file
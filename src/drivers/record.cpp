@@ -1,36 +1,121 @@
 #include "record.h"
+#include "audio_capture.h"
+#include <sndfile.h>
 #include <iostream>
 #include <cstdlib>
+#include <algorithm>
 
 namespace Record {
 
 bool recordToWav(const std::string& outputPath, int durationSec) {
-    // Check if the output path is valid
-    std::string command = "arecord -f cd -t wav -d " + std::to_string(durationSec) + " -r 16000 -c 1 " + outputPath;
-    std::cout << "[INFO] Recording audio to: " << outputPath << " for " << durationSec << " seconds..." << std::endl;
+    SF_INFO info{};
+    info.samplerate = AudioCapture::SAMPLE_RATE;
+    info.channels = 1;
+    info.format = SF_FORMAT_WAV | SF_FORMAT_PCM_16;
+
+    SNDFILE* file = sf_open(outputPath.c_str(), SFM_WRITE, &info);
+    if (!file) {
+        std::cerr << "[ERROR] Failed to open output file: " << outputPath << std::endl;
+        return false;
+    }
 
-    int ret = std::system(command.c_str());
-    if (ret != 0) {
+    AudioCapture capture;
+    if (!capture.start()) {
+        sf_close(file);
         std::cerr << "[ERROR] Failed to record audio." << std::endl;
         return false;
     }
+    std::cout << "[INFO] Recording audio to: " << outputPath << " for " << durationSec << " seconds..." << std::endl;
+
+    int16_t frame[AudioCapture::FRAME_SAMPLES];
+    size_t total = static_cast<size_t>(durationSec) * AudioCapture::SAMPLE_RATE / AudioCapture::FRAME_SAMPLES;
+    size_t written = 0;
+    while (written < total && capture.isRunning()) {
+        if (!capture.waitFrame(frame, 100)) continue;
+        sf_writef_short(file, frame, AudioCapture::FRAME_SAMPLES);
+        ++written;
+    }
+    capture.stop();
+    sf_close(file);
 
+    if (written < total) {
+        std::cerr << "[ERROR] Recording interrupted." << std::endl;
+        return false;
+    }
     std::cout << "[INFO] Recording completed." << std::endl;
     return true;
 }
 
 bool recordWithSilenceDetection(const std::string& outputPath, int silenceThresholdDb, int silenceDurationSec) {
-    std::string command =
-    "sox -t alsa plughw:0,0 " + outputPath +
-    " silence 1 0.1 " + std::to_string(silenceThresholdDb) + "d "
-    "1 " + std::to_string(silenceDurationSec) + " " + std::to_string(silenceThresholdDb) + "d";
+    // 参数沿用原 sox 调用：门限为 dBFS，静音时长为秒
+    VadConfig config;
+    config.threshold_db = silenceThresholdDb > 0 ? -silenceThresholdDb : silenceThresholdDb;
+    config.hangover_frames = silenceDurationSec * 100;
+    return recordUtterance(outputPath, config);
+}
 
-    std::cout << "[INFO] Recording with silence detection to: " << outputPath << std::endl;
-    int ret = std::system(command.c_str());
-    if (ret != 0) {
+bool recordUtterance(const std::string& outputPath, const VadConfig& config, int maxWaitSec, int maxDurationSec) {
+    constexpr size_t FRAME = AudioCapture::FRAME_SAMPLES;
+    constexpr size_t FRAMES_PER_SEC = AudioCapture::SAMPLE_RATE / FRAME;
+    // 保留说话前约 200ms，避免判定开始前的起音被截掉
+    constexpr size_t PREROLL_FRAMES = 10;
+
+    SF_INFO info{};
+    info.samplerate = AudioCapture::SAMPLE_RATE;
+    info.channels = 1;
+    info.format = SF_FORMAT_WAV | SF_FORMAT_PCM_16;
+
+    SNDFILE* file = sf_open(outputPath.c_str(), SFM_WRITE, &info);
+    if (!file) {
+        std::cerr << "[ERROR] Failed to open output file: " << outputPath << std::endl;
+        return false;
+    }
+
+    AudioCapture capture;
+    if (!capture.start()) {
+        sf_close(file);
         std::cerr << "[ERROR] Failed to record audio with silence detection." << std::endl;
         return false;
     }
+    std::cout << "[INFO] Recording with silence detection to: " << outputPath << std::endl;
+
+    VoiceActivityDetector vad(config);
+    int16_t preroll[PREROLL_FRAMES][FRAME];
+    size_t preroll_count = 0;
+    int16_t frame[FRAME];
+    size_t waited = 0, recorded = 0;
+    bool speaking = false, finished = false;
+
+    while (!finished && capture.isRunning()) {
+        if (!capture.waitFrame(frame, 100)) continue;
+        VoiceActivityDetector::Event event = vad.process(frame, FRAME);
+
+        if (!speaking) {
+            if (event == VoiceActivityDetector::Event::SpeechStart) {
+                speaking = true;
+                size_t n = std::min(preroll_count, PREROLL_FRAMES);
+                for (size_t k = preroll_count - n; k < preroll_count; ++k) {
+                    sf_writef_short(file, preroll[k % PREROLL_FRAMES], FRAME);
+                }
+                sf_writef_short(file, frame, FRAME);
+            } else {
+                std::copy(frame, frame + FRAME, preroll[preroll_count++ % PREROLL_FRAMES]);
+                if (++waited >= maxWaitSec * FRAMES_PER_SEC) break;
+            }
+            continue;
+        }
+
+        sf_writef_short(file, frame, FRAME);
+        finished = event == VoiceActivityDetector::Event::SpeechEnd ||
+                   ++recorded >= maxDurationSec * FRAMES_PER_SEC;
+    }
+    capture.stop();
+    sf_close(file);
+
+    if (!speaking) {
+        std::cerr << "[ERROR] No speech detected." << std::endl;
+        return false;
+    }
     std::cout << "[INFO] Recording finished (silence detected)." << std::endl;
     return true;
 }
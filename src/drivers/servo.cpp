@@ -1,9 +1,11 @@
 #include "servo.h"
+#include "hal.h"
+#include "clock.h"
+#include "trace.h"
+#include "log.h"
 #include <iostream>
-#include <unistd.h>
 #include <stdexcept>
 #include <cmath>
-#include <pthread.h>
 
 #define PWM_PERIOD_US 20000
 #define CENTER_DUTY_US 1500
@@ -12,74 +14,35 @@
 #define MAX_ANGLE 90
 
 Servo::Servo(int gpio_pin)
-    : chip(nullptr),
-      line(nullptr),
-      running(true),
-      duty_us(CENTER_DUTY_US),
+    : duty_us(CENTER_DUTY_US),
       pin(gpio_pin)
 {
-    chip = gpiod_chip_open_by_name("gpiochip0");
-    if (!chip) throw std::runtime_error("无法打开 GPIO 芯片");
-
-    line = gpiod_chip_get_line(chip, pin);
-    if (!line) throw std::runtime_error("无法获取 GPIO 线");
-
-    if (gpiod_line_request_output(line, "servo", 0) < 0)
-        throw std::runtime_error("无法设置 GPIO 为输出");
-
-    pwm_thread = std::thread(&Servo::pwmLoop, this, line, std::ref(duty_us));
+    // 调度策略和绑定的核心见 config/threads.json 的 servo_pwm
+    pwm = Hal::softPwm(pin, "servo", PWM_PERIOD_US, ThreadProfile::Role::ServoPwm);
+    pwm->setPulseUs(CENTER_DUTY_US);
     std::cout << "✅ Servo initialized on GPIO pin " << pin << std::endl;
 }
 
-Servo::~Servo() {
-    running.store(false);
-    if (pwm_thread.joinable()) pwm_thread.join();
-
-    gpiod_line_set_value(line, 0);
-    gpiod_line_release(line);
-    if (chip) gpiod_chip_close(chip);
-
-    std::cout << "🧹 Servo cleaned up." << std::endl;
+Servo::Servo(std::unique_ptr<PwmChannel> channel)
+    : pwm(std::move(channel)),
+      duty_us(CENTER_DUTY_US),
+      pin(-1)
+{
+    pwm->setPeriodUs(PWM_PERIOD_US);
+    pwm->setPulseUs(CENTER_DUTY_US);
 }
 
-void Servo::pwmLoop(struct gpiod_line* line, std::atomic<int>& duty_cycle) {
-    // 实时线程调度（需要 root）
-    struct sched_param sch_params;
-    sch_params.sched_priority = 80;
-    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &sch_params) != 0) {
-        std::cerr << "⚠️ 警告: 无法设置实时线程（可能需要 root）\n";
-    }
-
-    // 将线程绑定到特定核心（可选，防止迁移）
-    cpu_set_t cpuset;
-    CPU_ZERO(&cpuset);
-    CPU_SET(2, &cpuset);  // 绑定 CPU 核心2（根据实际核心数调整）
-    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
-
-    int cached_duty = duty_cycle.load();
-    int update_counter = 0;
-
-    while (running.load()) {
-        int high_time = cached_duty;
-        int low_time = PWM_PERIOD_US - high_time;
-
-        gpiod_line_set_value(line, 1);
-        usleep(high_time);
-
-        gpiod_line_set_value(line, 0);
-        usleep(low_time);
-
-        // 每 10 周期更新一次占空比，降低 jitter
-        if (++update_counter % 10 == 0) {
-            cached_duty = duty_cycle.load();
-        }
-    }
+Servo::~Servo() {
+    pwm.reset();
+    std::cout << "🧹 Servo cleaned up." << std::endl;
 }
 
 void Servo::center() {
     duty_us.store(CENTER_DUTY_US);
-    std::cout << "🔄 舵机归中，占空比: " << CENTER_DUTY_US << "us" << std::endl;
-    usleep(500000);
+    pwm->setPulseUs(CENTER_DUTY_US);
+    Trace::servo(CENTER_DUTY_US);
+    LOG_INFO("🔄 舵机归中，占空比: {}us", CENTER_DUTY_US);
+    Clock::sleepFor(std::chrono::milliseconds(500));
 }
 
 void Servo::turn(char direction, int angle) {
@@ -94,13 +57,14 @@ void Servo::turn(char direction, int angle) {
     } else if (direction == 'R' || direction == 'r') {
         target_duty = static_cast<int>(CENTER_DUTY_US + ratio * (RIGHT_MAX_DUTY_US - CENTER_DUTY_US) + 0.5f);
     } else {
-        std::cout << "❌ 无效方向，请用 'L' 或 'R'" << std::endl;
+        LOG_ERROR("❌ 无效方向，请用 'L' 或 'R'");
         return;
     }
 
     duty_us.store(target_duty);
-    std::cout << "🧭 舵机向 " << (direction == 'L' ? "左" : "右")
-              << " 转动 " << angle << "°，占空比设置为 " << target_duty << "us" << std::endl;
+    pwm->setPulseUs(target_duty);
+    Trace::servo(target_duty);
+    LOG_INFO("🧭 舵机向 {} 转动 {}°，占空比设置为 {}us", direction == 'L' ? "左" : "右", angle, target_duty);
 
-    usleep(500000);
+    Clock::sleepFor(std::chrono::milliseconds(500));
 }
\ No newline at end of file
@@ -0,0 +1,214 @@
+#include "timeline.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <json.hpp>
+
+#define MAX_EVENTS 100000     // 一次行程最多缓存的事件数，超出后丢弃
+
+namespace Timeline {
+
+namespace {
+
+struct Event {
+    std::string name;
+    const char* category;
+    std::string detail;
+    char phase;               // 'X' 区间，'i' 瞬时
+    uint64_t ts_ns;
+    uint64_t dur_ns;
+    int tid;
+};
+
+std::atomic<uint32_t> current{0};        // 0 表示未在记录
+uint32_t last_generation = 0;
+std::mutex mtx;
+std::vector<Event> events;
+std::map<int, std::string> thread_names;
+std::string trip_name;
+std::string out_dir;
+uint64_t origin_ns = 0;
+size_t dropped = 0;
+
+uint64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 线程编号从 1 开始按第一次记录的顺序分配，比系统 tid 更好读
+int threadId() {
+    static std::atomic<int> next{1};
+    thread_local int id = next.fetch_add(1);
+    return id;
+}
+
+void push(Event e, uint32_t gen) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (current.load() != gen) return;
+    if (events.size() >= MAX_EVENTS) {
+        ++dropped;
+        return;
+    }
+    events.push_back(std::move(e));
+}
+
+}  // namespace
+
+void begin(const std::string& trip, const std::string& dir) {
+    std::string target = dir;
+    if (target.empty()) {
+        const char* env = std::getenv("ROBO_TIMELINE_DIR");
+        if (env) target = env;
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    events.clear();
+    dropped = 0;
+    if (target.empty()) {
+        current.store(0);
+        return;
+    }
+    events.reserve(1024);
+    trip_name = trip;
+    out_dir = target;
+    origin_ns = nowNs();
+    if (++last_generation == 0) ++last_generation;
+    current.store(last_generation);
+}
+
+// generation 非 0 时只结束该次行程
+static std::string finish(uint32_t generation) {
+    std::vector<Event> trip_events;
+    std::map<int, std::string> names;
+    std::string dir, trip;
+    uint64_t origin;
+    size_t lost;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (current.load() == 0) return "";
+        if (generation != 0 && current.load() != generation) return "";
+        current.store(0);
+        trip_events.swap(events);
+        names = thread_names;
+        dir = out_dir;
+        trip = trip_name;
+        origin = origin_ns;
+        lost = dropped;
+    }
+
+    // Chrome trace 的 ts/dur 单位为微秒
+    nlohmann::json list = nlohmann::json::array();
+    std::map<int, bool> seen;
+    for (const auto& e : trip_events) {
+        nlohmann::json j = {
+            {"name", e.name}, {"cat", e.category}, {"ph", std::string(1, e.phase)},
+            {"ts", (e.ts_ns - origin) / 1000.0}, {"pid", 1}, {"tid", e.tid}
+        };
+        if (e.phase == 'X') j["dur"] = e.dur_ns / 1000.0;
+        if (e.phase == 'i') j["s"] = "t";
+        if (!e.detail.empty()) j["args"] = {{"detail", e.detail}};
+        list.push_back(std::move(j));
+        seen[e.tid] = true;
+    }
+    for (const auto& [tid, unused] : seen) {
+        auto it = names.find(tid);
+        std::string name = it != names.end() ? it->second : "thread-" + std::to_string(tid);
+        list.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", tid},
+                        {"args", {{"name", name}}}});
+    }
+    list.push_back({{"name", "process_name"}, {"ph", "M"}, {"pid", 1}, {"tid", 0},
+                    {"args", {{"name", "trip: " + trip}}}});
+
+    nlohmann::json doc = {
+        {"traceEvents", std::move(list)},
+        {"displayTimeUnit", "ms"},
+        {"otherData", {{"trip", trip}, {"dropped", lost}}}
+    };
+
+    // 精确到毫秒，仍然撞名（同一毫秒内连续失败的识别）时加序号
+    auto wall = std::chrono::system_clock::now();
+    std::time_t now = std::chrono::system_clock::to_time_t(wall);
+    int ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        wall.time_since_epoch()).count() % 1000);
+    std::tm tm{};
+    localtime_r(&now, &tm);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &tm);
+    char name[64];
+    std::snprintf(name, sizeof(name), "/trip-%s-%03d", stamp, ms);
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    std::string path = dir + name + ".json";
+    for (int n = 1; std::filesystem::exists(path, ec); ++n) {
+        path = dir + name + "-" + std::to_string(n) + ".json";
+    }
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "[ERROR] Cannot write timeline " << path << std::endl;
+        return "";
+    }
+    out << doc.dump();
+    std::cout << "[INFO] Trip timeline written to " << path << std::endl;
+    return path;
+}
+
+std::string end() {
+    return finish(0);
+}
+
+Trip::Trip(const std::string& trip, const std::string& dir) {
+    begin(trip, dir);
+    generation = current.load();
+}
+
+Trip::~Trip() {
+    if (!kept && generation != 0) finish(generation);
+}
+
+bool active() {
+    return current.load(std::memory_order_relaxed) != 0;
+}
+
+void nameThread(const std::string& name) {
+    int tid = threadId();
+    std::lock_guard<std::mutex> lock(mtx);
+    thread_names[tid] = name;
+}
+
+void instant(const std::string& name, const char* category, const std::string& detail) {
+    uint32_t gen = current.load(std::memory_order_relaxed);
+    if (gen == 0) return;
+    push({name, category, detail, 'i', nowNs(), 0, threadId()}, gen);
+}
+
+Span::Span(const char* name, const char* category, std::string detail)
+    : category(category), generation(current.load(std::memory_order_relaxed)) {
+    if (generation == 0) return;
+    this->name = name;
+    this->detail = std::move(detail);
+    start_ns = nowNs();
+}
+
+Span::Span(std::string name, const char* category, std::string detail)
+    : category(category), generation(current.load(std::memory_order_relaxed)) {
+    if (generation == 0) return;
+    this->name = std::move(name);
+    this->detail = std::move(detail);
+    start_ns = nowNs();
+}
+
+Span::~Span() {
+    if (generation == 0) return;
+    uint64_t end_ns = nowNs();
+    push({std::move(name), category, std::move(detail), 'X', start_ns, end_ns - start_ns, threadId()}, generation);
+}
+
+}  // namespace Timeline
@@ -0,0 +1,246 @@
+#include "trace.h"
+#include "clock.h"
+#include "thread_profile.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#define TRACE_MAGIC "RHGTRACE"
+#define TRACE_VERSION 1
+#define RECORD_HEADER_BYTES 12
+#define FLUSH_BYTES (64 * 1024)          // 攒够就唤醒写线程
+#define FLUSH_INTERVAL_MS 200
+#define MAX_BACKLOG_BYTES (8 * 1024 * 1024)
+
+namespace Trace {
+
+namespace {
+
+// 双缓冲：采集线程往 front 追加，写线程交换后把 back 写盘
+class Recorder {
+public:
+    ~Recorder() { close(); }
+
+    bool open(const std::string& path) {
+        close();
+        FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f) {
+            std::cerr << "[ERROR] Cannot open trace file " << path << std::endl;
+            return false;
+        }
+        uint32_t header[2] = {TRACE_VERSION, 0};
+        std::fwrite(TRACE_MAGIC, 1, 8, f);
+        std::fwrite(header, sizeof(header), 1, f);
+
+        std::lock_guard<std::mutex> lock(mtx);
+        file = f;
+        front.clear();
+        front.reserve(FLUSH_BYTES * 2);
+        lost.store(0);
+        running = true;
+        writer = std::thread(&Recorder::writerLoop, this);
+        return true;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!running) return;
+            running = false;
+        }
+        cv.notify_one();
+        if (writer.joinable()) writer.join();
+        std::fclose(file);
+        file = nullptr;
+    }
+
+    void write(Type type, const void* payload, uint16_t len) {
+        uint64_t t = Clock::nowNs();
+        uint16_t kind = static_cast<uint16_t>(type);
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!running) return;
+        if (front.size() + RECORD_HEADER_BYTES + len > MAX_BACKLOG_BYTES) {
+            lost.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        size_t at = front.size();
+        front.resize(at + RECORD_HEADER_BYTES + len);
+        std::memcpy(&front[at], &t, 8);
+        std::memcpy(&front[at + 8], &kind, 2);
+        std::memcpy(&front[at + 10], &len, 2);
+        if (len) std::memcpy(&front[at + RECORD_HEADER_BYTES], payload, len);
+        if (front.size() >= FLUSH_BYTES) cv.notify_one();
+    }
+
+    uint64_t dropped() const { return lost.load(std::memory_order_relaxed); }
+
+private:
+    void writerLoop() {
+        ThreadProfile::apply(ThreadProfile::Role::Background);
+        std::vector<uint8_t> back;
+        back.reserve(FLUSH_BYTES * 2);
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            cv.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS),
+                        [this] { return !running || front.size() >= FLUSH_BYTES; });
+            bool stopping = !running;
+            front.swap(back);
+            lock.unlock();
+
+            if (!back.empty()) {
+                std::fwrite(back.data(), 1, back.size(), file);
+                std::fflush(file);
+                back.clear();
+            }
+            if (stopping) return;
+            lock.lock();
+        }
+    }
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<uint8_t> front;
+    std::thread writer;
+    FILE* file = nullptr;
+    bool running = false;
+    std::atomic<uint64_t> lost{0};
+};
+
+// 记录器常驻，采集线程读到 enabled 后即使恰好遇上 stop 也不会访问已释放的对象
+Recorder recorder;
+std::atomic<bool> enabled{false};
+std::mutex control_mtx;
+
+}  // namespace
+
+bool start(const std::string& path) {
+    std::lock_guard<std::mutex> lock(control_mtx);
+    enabled.store(false);
+    if (!recorder.open(path)) return false;
+    enabled.store(true);
+    std::cout << "[INFO] Recording trace to " << path << std::endl;
+    return true;
+}
+
+void stop() {
+    std::lock_guard<std::mutex> lock(control_mtx);
+    enabled.store(false);
+    recorder.close();
+}
+
+bool active() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+uint64_t dropped() {
+    return recorder.dropped();
+}
+
+void imu(const float* acc, const float* gyro) {
+    if (!active()) return;
+    float payload[6] = {acc[0], acc[1], acc[2], gyro[0], gyro[1], gyro[2]};
+    recorder.write(Type::Imu, payload, sizeof(payload));
+}
+
+void range(float cm) {
+    if (!active()) return;
+    recorder.write(Type::Range, &cm, sizeof(cm));
+}
+
+void motor(int left, int right) {
+    if (!active()) return;
+    int16_t payload[2] = {static_cast<int16_t>(left), static_cast<int16_t>(right)};
+    recorder.write(Type::Motor, payload, sizeof(payload));
+}
+
+void servo(int pulse_us) {
+    if (!active()) return;
+    int32_t payload = pulse_us;
+    recorder.write(Type::Servo, &payload, sizeof(payload));
+}
+
+void nav(NavEvent event, int value, const std::string& text) {
+    if (!active()) return;
+    std::vector<uint8_t> payload(5 + std::min<size_t>(text.size(), UINT16_MAX - 5));
+    int32_t v = value;
+    payload[0] = static_cast<uint8_t>(event);
+    std::memcpy(&payload[1], &v, 4);
+    std::memcpy(&payload[5], text.data(), payload.size() - 5);
+    recorder.write(Type::Nav, payload.data(), static_cast<uint16_t>(payload.size()));
+}
+
+bool load(const std::string& path, std::vector<Sample>& out) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) {
+        std::cerr << "[ERROR] Cannot open trace file " << path << std::endl;
+        return false;
+    }
+    char magic[8];
+    uint32_t header[2];
+    if (std::fread(magic, 1, 8, f) != 8 || std::memcmp(magic, TRACE_MAGIC, 8) != 0 ||
+        std::fread(header, sizeof(header), 1, f) != 1 || header[0] != TRACE_VERSION) {
+        std::cerr << "[ERROR] " << path << " is not a trace file" << std::endl;
+        std::fclose(f);
+        return false;
+    }
+
+    uint8_t head[RECORD_HEADER_BYTES];
+    std::vector<uint8_t> payload;
+    while (std::fread(head, 1, RECORD_HEADER_BYTES, f) == RECORD_HEADER_BYTES) {
+        Sample s;
+        uint16_t kind, len;
+        std::memcpy(&s.t_ns, head, 8);
+        std::memcpy(&kind, head + 8, 2);
+        std::memcpy(&len, head + 10, 2);
+        payload.resize(len);
+        if (len && std::fread(payload.data(), 1, len, f) != len) break;
+        s.type = static_cast<Type>(kind);
+
+        switch (s.type) {
+        case Type::Imu:
+            if (len < 24) continue;
+            std::memcpy(s.v, payload.data(), 24);
+            break;
+        case Type::Range:
+            if (len < 4) continue;
+            std::memcpy(s.v, payload.data(), 4);
+            break;
+        case Type::Motor: {
+            if (len < 4) continue;
+            int16_t lr[2];
+            std::memcpy(lr, payload.data(), 4);
+            s.a = lr[0];
+            s.b = lr[1];
+            break;
+        }
+        case Type::Servo: {
+            if (len < 4) continue;
+            int32_t pulse;
+            std::memcpy(&pulse, payload.data(), 4);
+            s.a = pulse;
+            break;
+        }
+        case Type::Nav: {
+            if (len < 5) continue;
+            int32_t v;
+            std::memcpy(&v, &payload[1], 4);
+            s.a = payload[0];
+            s.b = v;
+            s.text.assign(payload.begin() + 5, payload.end());
+            break;
+        }
+        default:
+            continue;   // 新版本增加的类型，跳过
+        }
+        out.push_back(std::move(s));
+    }
+    std::fclose(f);
+    return true;
+}
+
+}  // namespace Trace
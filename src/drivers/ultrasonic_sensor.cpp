@@ -0,0 +1,66 @@
+#include "ultrasonic_sensor.h"
+#include "hal.h"
+#include "thread_profile.h"
+#include <iostream>
+#include <chrono>
+#include <stdexcept>
+
+// 回波超时：HC-SR04 最大量程约 4m，往返约 23ms
+#define ECHO_TIMEOUT_US 30000
+#define SOUND_CM_PER_US 0.0343f
+
+UltrasonicSensor::UltrasonicSensor(int trig_pin, int echo_pin, int interval_ms)
+    : running(true),
+      distance_cm(RANGE_NO_ECHO),
+      interval_ms(interval_ms)
+{
+    trig_line = Hal::outputLine(trig_pin, "ultrasonic", 0);
+    // 回声脚按边沿事件打开，脉宽取内核时间戳，测量线程被 PWM/IMU 抢占不会把距离测远
+    echo_line = Hal::edgeLine(echo_pin, "ultrasonic");
+
+    sensor_thread = std::thread(&UltrasonicSensor::measureLoop, this);
+    std::cout << "Ultrasonic sensor initialized." << std::endl;
+}
+
+UltrasonicSensor::~UltrasonicSensor() {
+    running.store(false);
+    if (sensor_thread.joinable()) sensor_thread.join();
+
+    trig_line->set(0);
+}
+
+float UltrasonicSensor::getDistance() const {
+    return distance_cm.load(std::memory_order_relaxed);
+}
+
+float UltrasonicSensor::measureOnce() {
+    // 上一次超时留下的边沿不能算进这次
+    echo_line->clearEdges();
+
+    // 发送 10us 触发脉冲
+    trig_line->set(0);
+    std::this_thread::sleep_for(std::chrono::microseconds(2));
+    trig_line->set(1);
+    std::this_thread::sleep_for(std::chrono::microseconds(10));
+    trig_line->set(0);
+
+    // 等待回声信号（带超时，避免传感器掉线时卡死线程）
+    // HC-SR04 每次触发后都会拉高回声脚，一直不拉高说明传感器没有工作
+    uint64_t rise_ns = 0, fall_ns = 0;
+    if (echo_line->waitLevel(1, ECHO_TIMEOUT_US, rise_ns) <= 0) return RANGE_ERROR;
+    // 超量程时回声脚保持高电平，超时即无回波
+    int fell = echo_line->waitLevel(0, ECHO_TIMEOUT_US, fall_ns);
+    if (fell < 0) return RANGE_ERROR;
+    if (fell == 0) return RANGE_NO_ECHO;
+    float travel = (fall_ns - rise_ns) / 1000.0f;
+
+    return travel * SOUND_CM_PER_US / 2.0f;
+}
+
+void UltrasonicSensor::measureLoop() {
+    ThreadProfile::apply(ThreadProfile::Role::Ultrasonic);
+    while (running.load()) {
+        distance_cm.store(measureOnce(), std::memory_order_relaxed);
+        std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+    }
+}
@@ -1,19 +1,30 @@
 #include "yaw_tracker.h"
+#include "trace.h"
 #include <chrono>
 #include "MadgwickAHRS.h"
 
-// 全局实例（或作为成员变量）
-Madgwick madgwick;
+YawTracker::YawTracker() : mpu(std::make_unique<MPU6050>()) {}
+
+YawTracker::YawTracker(std::unique_ptr<MPU6050> mpu) : mpu(std::move(mpu)) {}
 
 void YawTracker::start(int hz) {
+    if (started) return;
+    started = true;
     madgwick.begin(hz);  // 初始化采样频率
-    mpu.registerCallback([this](uint64_t ts, const float* acc, const float* gyro) {
+    if (!mpu) return;
+    mpu->registerCallback([this](uint64_t ts, const float* acc, const float* gyro) {
         this->handleMPUData(ts, acc, gyro);
     });
-    mpu.start(hz);
+    // MPU6050::start 取的是采样间隔（ms），不是频率；两者不一致时滤波器按错误的 dt 积分
+    mpu->start(hz > 0 ? 1000 / hz : 10);
 }
 
 void YawTracker::handleMPUData(uint64_t, const float* acc, const float* gyro) {
+    Trace::imu(acc, gyro);
+    feed(acc, gyro);
+}
+
+void YawTracker::feed(const float* acc, const float* gyro) {
     madgwick.updateIMU(
         gyro[0], gyro[1], gyro[2],  // 单位：°/s
         acc[0], acc[1], acc[2]      // 单位：g
@@ -26,4 +37,4 @@ float YawTracker::getAngle() const {
 
 void YawTracker::reset() {
     // MadgwickAHRS 通常不带 reset，这里你可以重建对象或忽略
-}
\ No newline at end of file
+}
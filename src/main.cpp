@@ -4,9 +4,12 @@
 #include <thread> 
 
 #include "record.h"
+#include "thread_profile.h"
 
 int main(int argc, char *argv[]) {
 
+    // 在 Qt 和 OpenCV 创建线程之前把主线程移出控制核心，它们的线程会继承这个核心集合
+    ThreadProfile::configure();
 
     QApplication a(argc, argv);
 
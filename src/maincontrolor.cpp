@@ -1,89 +1,585 @@
 // maincontroller.cpp
 #include "maincontroller.h"
 #include "nav.h"
-#include "motor.h"
-#include "servo.h"
+#include "hardware_context.h"
 //#include "servonew.h" // hardwear pwm not working
 #include "yaw_tracker.h"
+#include "audio_engine.h"
+#include "timeline.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <fstream>
 #include <thread>
+#include <QDate>
+#include <QDateTime>
 #include "face_recognizer.h"
 #include "json.hpp"
 
+// LBPH distance above which a face match is not trusted
+#define FACE_MATCH_MAX_DISTANCE 80.0
+// A hot-tier hit this close skips the cold gallery; anything looser is checked against it
+#define FACE_HOT_MATCH_DISTANCE 50.0
+// How long remote mode waits for robo_core to answer a recognition request
+#define REMOTE_RECOGNIZE_TIMEOUT_MS 10000
+// The keeper takes over once the navigation loop has missed this many ticks
+#define MOTION_KEEPER_STALE_TICKS 2
+// How long recognition waits for a fresh camera frame
+#define CAMERA_FRAME_TIMEOUT_MS 500
+// Face tracking window per recognition: keep the sharpest frontal crop seen within it
+#define RECOGNIZE_WINDOW_MS 1500
+// Quality score good enough to stop collecting frames early (see FaceQualityGate::assess)
+#define RECOGNIZE_GOOD_SCORE 2.0
+
 void playAudio(const std::string& path) {
-    std::string cmd = "mplayer -ao alsa:device=hw=1.0 -volume 100 \"" + path + "\" > /dev/null 2>&1";
-    system(cmd.c_str());
+    // 非阻塞：交给常驻的音频引擎混音播放
+    AudioEngine::instance().play(path);
 }
 
 
 MainController::MainController() : recognizer(std::make_shared<FaceRecognizerLib>()) {}
 
+MainController::~MainController() {
+    stopWorker();
+    stopMotionKeeper();
+}
+
 bool MainController::init() {
+    const char* core = std::getenv("ROBO_CORE");
+    if (core && std::string(core) == "remote") return initRemote();
+    return initLocal();
+}
+
+bool MainController::initRemote() {
+    bus = StateBus::attach();
+    if (!bus) return false;
+    if (!bus->alive(1000000000ull)) {
+        std::cerr << "[DEBUG] robo_core is not publishing state.\n";
+    }
+
+    // Manual identification stays in the GUI process; robo_core keeps the mirror in sync
+    patientStore = std::make_shared<PatientStore>();
+    if (patientStore->open("../config/hospital_guide.db")) {
+        patientSearch.build(*patientStore);
+        searchSession = std::make_unique<PatientSearchIndex::Session>(patientSearch);
+    } else {
+        std::cerr << "[DEBUG] Failed to open local patient store.\n";
+    }
+    return true;
+}
+
+bool MainController::initLocal() {
+    {
+        std::lock_guard<std::mutex> lock(workerMtx);
+        workerRunning = true;
+    }
+    worker = std::thread(&MainController::workerLoop, this);
 
     // Initialize face recognizer
     std::string face_folder = "../source/face";
 
-    if (!recognizer->init(face_folder)) {
-        std::cerr << "[DEBUG] Failed to initialize face recognition.\n";
-        return false;
+    // Recognition is optional: without it the robot still navigates by manual or voice request
+    faceReady = recognizer->init(face_folder);
+    if (!faceReady) {
+        std::cerr << "[ERROR] Failed to initialize face recognition, recognition disabled.\n";
+    } else {
+        // Capture straight from the camera; ROBO_CAMERA can point at a device or an image folder.
+        // Without a camera, fall back to the capture file written by the external tool
+        const char* camera_spec = std::getenv("ROBO_CAMERA");
+        camera = Camera::open(camera_spec && *camera_spec ? camera_spec : CAMERA_DEVICE);
+        if (!camera) {
+            std::cerr << "[DEBUG] No camera, recognizing from ../source/tmp/capture.jpg.\n";
+        }
+    }
+
+    // Open the speaker once and decode the navigation prompts up front
+    AudioEngine& audio = AudioEngine::instance();
+    if (audio.init("plughw:1,0")) {
+        audio.load("start", "../source/starts.mp3");
+        audio.load("hold",  "../source/hold.mp3");
+        audio.load("stop",  "../source/stops.mp3");
+        audio.load("speak", "../source/speak.wav");
+    } else {
+        std::cerr << "[DEBUG] Audio engine unavailable, prompts disabled.\n";
+    }
+
+    // Local patient mirror, kept fresh from the hospital MySQL server in the background
+    patientStore = std::make_shared<PatientStore>();
+    if (patientStore->open("../config/hospital_guide.db")) {
+        // face label -> patient -> appointment -> department, refreshed as registrations change
+        routeIndex = std::make_unique<RouteIndex>(*patientStore);
+        routeIndex->rebuild(QDate::currentDate().toString("yyyy-MM-dd").toStdString());
+        patientSearch.build(*patientStore);
+        searchSession = std::make_unique<PatientSearchIndex::Session>(patientSearch);
+
+        // Today's patients are matched against a small hot gallery before the full one
+        if (faceReady) {
+            recognizer->setHotThreshold(FACE_HOT_MATCH_DISTANCE);
+            facePrefetcher = std::make_unique<FacePrefetcher>(*patientStore, *recognizer);
+            facePrefetcher->start();
+        }
+
+        patientSync = std::make_unique<PatientSync>(*patientStore, HospitalDbConfig());
+        patientSync->setChangeCallback([this](const std::vector<int>& patientIds) {
+            routeIndex->update(patientIds);
+            if (facePrefetcher) facePrefetcher->notifyPatients(patientIds);
+            for (int id : patientIds) {
+                if (auto p = patientStore->findPatient(id)) patientSearch.upsert(*p);
+            }
+        });
+        patientSync->start();
+    } else {
+        std::cerr << "[DEBUG] Failed to open local patient store.\n";
+    }
+
+    // Offline keyword spotter over the department names in nav.json
+    std::ifstream navFile("../config/nav.json");
+    if (navFile.is_open()) {
+        try {
+            navFile >> navJson;
+        } catch (const std::exception& e) {
+            std::cerr << "[DEBUG] Failed to parse navigation config: " << e.what() << "\n";
+        }
+    }
+    VadConfig vad;
+    vad.hangover_frames = 30;
+    spotter = std::make_unique<KeywordSpotter>(vad);
+    if (spotter->loadTemplates("../source/keywords", KeywordSpotter::vocabularyFromNav(navJson)) == 0) {
+        std::cerr << "[DEBUG] No voice templates found, voice navigation disabled.\n";
+        spotter.reset();
+    } else {
+        // Runs inside feed() on the capture thread: hand the department over instead of navigating here
+        spotter->setCallback([this](const std::string& department, float) {
+            if (voiceArmed.exchange(false)) {
+                post([this, department] { startNavigationTo(QString::fromStdString(department)); });
+            }
+        });
+        microphone = std::make_unique<AudioCapture>();
+        microphone->setFrameCallback([this](const int16_t* frame, size_t samples) {
+            if (!voiceArmed.load()) return;
+            // The spotter is only ever touched from this thread, so reset is serialized with feed
+            if (voiceResetPending.exchange(false)) spotter->reset();
+            spotter->feed(frame, samples);
+        });
     }
 
-    // Initialize Motor, Servo, and YawTracker
+    // Initialize Motor, Servo, YawTracker and ultrasonic once; navigation reuses them
+    HardwareContext& hw = HardwareContext::instance();
+    if (!hw.init()) {
+        std::cerr << "[DEBUG] Drive hardware incomplete, navigation disabled.\n";
+    }
+    Nav::speedGovernor.attach(hw.ultrasonic());
+    if (hw.motor()) {
+        keeperRunning.store(true);
+        motionKeeper = std::thread(&MainController::motionKeeperLoop, this);
+    }
 
     return true;
 }
 
-QString MainController::recognizeFace() {
-    // std::string result = recognizer->recognize("../source/tmp/capture.jpg");
-    // return QString::fromStdString(result);
-    return QString();
+QString MainController::departmentForPatient(const QString& name, const QString& birthDate) {
+    if (!patientStore) return QString();
+
+    auto patients = patientStore->findPatients(name.trimmed().toStdString(), birthDate.trimmed().toStdString());
+    if (patients.empty()) return QString();
+
+    std::string today = QDateTime::currentDateTime().toString("yyyy-MM-dd 00:00:00").toStdString();
+    auto registration = patientStore->nextRegistration(patients.front().id, today);
+    if (!registration) return QString();
+
+    auto department = patientStore->findDepartment(registration->departmentId);
+    return department ? QString::fromStdString(department->name) : QString();
 }
 
-void MainController::startNavigationTo(const QString& departmentName) {
- 
-    std::string audio_start = "../source/starts.mp3";
-    std::string audio_stop  = "../source/stops.mp3";
+std::vector<PatientMatch> MainController::searchPatients(const QString& name, const QString& birthDate,
+                                                        const QString& gender, int limit) {
+    if (!searchSession || limit <= 0) return {};
 
-    // Load navigation JSON
-    nlohmann::json navJson;
-    std::ifstream navFile("../config/nav.json");
-    if (!navFile.is_open()) {
-        std::cerr << "[DEBUG] Failed to open navigation config file.\n";
+    PatientSearchFilter filter;
+    filter.birthDate = birthDate.trimmed().toStdString();
+    filter.gender = gender.trimmed().toStdString();
+    return searchSession->search(name.toStdString(), filter, static_cast<size_t>(limit));
+}
+
+bool MainController::startVoiceNavigation() {
+    if (bus) return sendCommand(BusCommandType::VoiceStart);
+    if (!spotter || !microphone) return false;
+    if (!microphone->isRunning() && !microphone->start()) return false;
+    voiceResetPending.store(true);
+    voiceArmed.store(true);
+    return true;
+}
+
+void MainController::stopVoiceNavigation() {
+    if (bus) {
+        sendCommand(BusCommandType::VoiceStop);
         return;
     }
-    navFile >> navJson;
-    navFile.close();
+    voiceArmed.store(false);
+}
+
+QString MainController::recognizeFace() {
+    if (bus) {
+        uint32_t id = 0;
+        return sendCommand(BusCommandType::Recognize, "", &id) ? waitForRecognition(id) : QString();
+    }
+    if (!faceReady) return QString();
+    // 一次导引的时间线从识别开始，到导航线程结束时导出；识别失败时在这里就结束
+    Timeline::Trip trip("face recognition");
+    Timeline::nameThread("ui");
+    std::pair<std::string, double> result;
+    if (camera) {
+        // Track faces over a short window and match only the best crop, instead of
+        // matching whatever the first frame holds (often motion-blurred or turned away)
+        FaceTracker tracker;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(RECOGNIZE_WINDOW_MS);
+        {
+            Timeline::Span span("face_track", "vision");
+            while (std::chrono::steady_clock::now() < deadline) {
+                Camera::Frame frame = camera->latest(CAMERA_FRAME_TIMEOUT_MS);
+                if (!frame) {
+                    std::cerr << "[DEBUG] No camera frame within " << CAMERA_FRAME_TIMEOUT_MS << " ms.\n";
+                    break;
+                }
+                recognizer->track(frame->gray, tracker, frame->t_ns);
+                const FaceTracker::Track* best = tracker.best();
+                if (best && best->best.score >= RECOGNIZE_GOOD_SCORE) break;
+            }
+        }
+        const FaceTracker::Track* best = tracker.best();
+        if (!best) {
+            std::cerr << "[DEBUG] No face passed the quality gate within " << RECOGNIZE_WINDOW_MS << " ms.\n";
+            return QString();
+        }
+        result = recognizer->recognizeCrop(best->crop);
+    } else {
+        result = recognizer->recognize("../source/tmp/capture.jpg");
+    }
+    auto [label, distance] = result;
+    if (distance < 0 || distance > FACE_MATCH_MAX_DISTANCE || !routeIndex) return QString();
+    Timeline::instant("patient recognized", "trip", label);
+
+    std::optional<PatientRoute> route;
+    {
+        Timeline::Span span("route_lookup", "db", label);
+        std::string today = QDate::currentDate().toString("yyyy-MM-dd").toStdString();
+        if (routeIndex->builtFor() != today) routeIndex->rebuild(today);
+        route = routeIndex->lookup(label);
+    }
+    if (!route) {
+        std::cerr << "[DEBUG] No upcoming appointment for face: " << label << "\n";
+        return QString();
+    }
+    // The trip continues into navigation, which ends it
+    trip.keep();
+    return QString::fromStdString(route->departmentName);
+}
+
+QString MainController::recognizeAndGuide() {
+    if (bus) {
+        uint32_t id = 0;
+        return sendCommand(BusCommandType::RecognizeAndGuide, "", &id) ? waitForRecognition(id) : QString();
+    }
+    QString department = recognizeFace();
+    // Navigation never started, so nothing else will end the recognition trip
+    if (!department.isEmpty() && !startNavigationTo(department)) Timeline::end();
+    return department;
+}
 
+void MainController::recognizeAsync(bool guide, std::function<void(const QString&)> done) {
+    bool queued = post([this, guide, done] {
+        done(guide ? recognizeAndGuide() : recognizeFace());
+    });
+    if (!queued) done(QString());
+}
+
+bool MainController::startNavigationTo(const QString& departmentName) {
+
+    // Navigation JSON is loaded once in init()
     std::string department = departmentName.trimmed().toStdString();
+    if (bus) return sendCommand(BusCommandType::Navigate, department);
     if (!navJson.contains(department)) {
         std::cerr << "[DEBUG] Department not found: " << department << "\n";
-        return;
+        return false;
+    }
+
+    HardwareContext& hw = HardwareContext::instance();
+    if (!hw.ready()) {
+        std::cerr << "[DEBUG] Drive hardware not ready.\n";
+        return false;
     }
-    
-    MotorPins pins = {17, 16, 22, 23};
-    auto motor = std::make_shared<Motor>(pins);
-    auto servo = std::make_shared<Servo>(18);
-    auto yaw   = std::make_shared<YawTracker>();
-    std::thread([motor, servo, yaw, department, navData = navJson, audio_start, audio_stop]() {
-        playAudio(audio_start);
+    if (!hw.tryAcquire()) {
+        std::cerr << "[DEBUG] Navigation already in progress.\n";
+        return false;
+    }
+
+    // 手动或语音发起的导航没有识别阶段，从这里开始记录
+    if (!Timeline::active()) Timeline::begin(department);
+    Timeline::instant("navigation requested", "trip", department);
+
+    std::thread([&hw, department, navData = navJson]() {
+        Timeline::nameThread("nav");
+        {
+            Timeline::Span span("audio_prompt", "audio", "start");
+            playAudio("start");
+        }
         Nav::startNavigation.store(true);
-        Nav::pauseNavigation.store(false);
-        Nav::navCV.notify_all();
+        Nav::motion.release(MotionSource::Pause);
 
-        Nav::navigationThread(motor.get(), servo.get(), yaw.get(), department, navData);
+        Nav::navigationThread(hw.motor(), hw.servo(), hw.yaw(), department, navData);
 
-        playAudio(audio_stop);
+        hw.release();
+        {
+            Timeline::Span span("audio_prompt", "audio", "stop");
+            playAudio("stop");
+        }
+        Timeline::end();
     }).detach();
+    return true;
+}
+
+void MainController::pauseNavigation() {
+    if (bus) {
+        sendCommand(BusCommandType::Pause);
+        return;
+    }
+    Nav::motion.hold(MotionSource::Pause);
+}
+
+void MainController::resumeNavigation() {
+    if (bus) {
+        sendCommand(BusCommandType::Resume);
+        return;
+    }
+    Nav::motion.release(MotionSource::Pause);
+}
+
+void MainController::cancelNavigation() {
+    if (bus) {
+        sendCommand(BusCommandType::Cancel);
+        return;
+    }
+    Nav::startNavigation.store(false);
+    Nav::motion.release(MotionSource::Pause);
+}
+
+void MainController::teleop(int duty) {
+    if (bus) {
+        sendCommand(BusCommandType::Teleop, "", nullptr, duty);
+        return;
+    }
+    Nav::motion.drive(MotionSource::Teleop, duty);
+}
+
+void MainController::releaseTeleop() {
+    if (bus) {
+        sendCommand(BusCommandType::TeleopRelease);
+        return;
+    }
+    Nav::motion.release(MotionSource::Teleop);
+}
+
+void MainController::emergencyStop(bool engage) {
+    if (bus) {
+        sendCommand(BusCommandType::EmergencyStop, "", nullptr, engage ? 1 : 0);
+        return;
+    }
+    if (!engage) {
+        Nav::motion.release(MotionSource::Emergency);
+        return;
+    }
+    Nav::motion.hold(MotionSource::Emergency);
+    // Apply right away; if the navigation loop is mid-tick its next tick stops the motors
+    Motor* motor = HardwareContext::instance().motor();
+    if (motor) Nav::motion.tick(*motor);
+}
+
+void MainController::motionKeeperLoop() {
+    const uint64_t stale_ns = MOTION_KEEPER_STALE_TICKS * Nav::NAV_TICK_MS * 1000000ull;
+    Motor* motor = HardwareContext::instance().motor();
+    while (keeperRunning.load()) {
+        // Tick every period while teleop is requested, plus one tick after it is released to stop the motors.
+        // A running trip ticks on its own, so only step in when its loop has gone quiet
+        bool pending = Nav::motion.active(MotionSource::Teleop) || Nav::motion.winner() == MotionSource::Teleop;
+        bool tripTicking = Nav::progress().step >= 0 && Nav::motion.sinceLastTickNs() <= stale_ns;
+        if (pending && !tripTicking) Nav::motion.tick(*motor);
+        std::this_thread::sleep_for(std::chrono::milliseconds(Nav::NAV_TICK_MS));
+    }
+}
+
+void MainController::stopMotionKeeper() {
+    keeperRunning.store(false);
+    if (motionKeeper.joinable()) motionKeeper.join();
+}
+
+bool MainController::post(std::function<void()> job) {
+    std::lock_guard<std::mutex> lock(workerMtx);
+    if (!workerRunning) return false;
+    jobs.push_back(std::move(job));
+    workerCv.notify_one();
+    return true;
+}
+
+void MainController::workerLoop() {
+    std::unique_lock<std::mutex> lock(workerMtx);
+    while (true) {
+        workerCv.wait(lock, [this] { return !jobs.empty() || !workerRunning; });
+        if (jobs.empty()) break;
+        std::function<void()> job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+        job();
+        lock.lock();
+    }
+}
+
+void MainController::stopWorker() {
+    {
+        std::lock_guard<std::mutex> lock(workerMtx);
+        if (!workerRunning) return;
+        workerRunning = false;
+        // Anything still queued belongs to the session being shut down
+        jobs.clear();
+    }
+    workerCv.notify_one();
+    if (worker.joinable()) worker.join();
+}
+
+bool MainController::robotState(RobotState& out) {
+    if (bus) return bus->read(out);
+    out = collectState();
+    return true;
+}
+
+RobotState MainController::collectState() {
+    RobotState s;
+    s.t_ns = StateBus::nowNs();
+
+    Nav::Progress progress = Nav::progress();
+    copyBusText(s.target, progress.target);
+    s.step = progress.step;
+    s.steps = progress.steps;
+    copyBusText(s.action, progress.action);
+    s.value = progress.value;
+    MotionSource winner = Nav::motion.winner();
+    if (winner == MotionSource::Emergency) {
+        s.nav = NavState::Stopped;
+    } else if (winner == MotionSource::Pause) {
+        s.nav = NavState::Paused;
+    } else if (progress.step >= 0) {
+        s.nav = NavState::Running;
+    }
+    s.motion_source = static_cast<int32_t>(winner);
+
+    HardwareContext& hw = HardwareContext::instance();
+    s.hardware_ready = hw.ready();
+    if (hw.yaw()) s.heading_deg = hw.yaw()->getAngle();
+    if (hw.ultrasonic()) s.obstacle_cm = hw.ultrasonic()->getDistance();
+    s.range_fault = Nav::speedGovernor.sensorFault();
+    if (hw.motor()) {
+        s.left_duty = hw.motor()->leftCommand();
+        s.right_duty = hw.motor()->rightCommand();
+    }
+    if (hw.servo()) s.servo_us = hw.servo()->pulseUs();
+    // No battery sense line on the current board
+    s.battery_v = std::nanf("");
+
+    std::lock_guard<std::mutex> lock(recognitionMtx);
+    s.recognition_id = lastRecognitionId;
+    copyBusText(s.recognized, lastRecognized);
+    return s;
+}
+
+void MainController::handleCommand(const BusCommand& cmd) {
+    switch (cmd.type) {
+    case BusCommandType::Navigate:
+        startNavigationTo(QString::fromUtf8(cmd.text));
+        break;
+    case BusCommandType::Pause:
+        pauseNavigation();
+        break;
+    case BusCommandType::Resume:
+        resumeNavigation();
+        break;
+    case BusCommandType::Cancel:
+        cancelNavigation();
+        break;
+    case BusCommandType::Recognize:
+    case BusCommandType::RecognizeAndGuide: {
+        // Off the bus loop: stop, pause and e-stop must not queue behind the camera window
+        uint32_t id = cmd.id;
+        recognizeAsync(cmd.type == BusCommandType::RecognizeAndGuide, [this, id](const QString& department) {
+            std::lock_guard<std::mutex> lock(recognitionMtx);
+            lastRecognized = department.toStdString();
+            lastRecognitionId = id;
+        });
+        break;
+    }
+    case BusCommandType::VoiceStart:
+        startVoiceNavigation();
+        break;
+    case BusCommandType::VoiceStop:
+        stopVoiceNavigation();
+        break;
+    case BusCommandType::Teleop:
+        teleop(cmd.value);
+        break;
+    case BusCommandType::TeleopRelease:
+        releaseTeleop();
+        break;
+    case BusCommandType::EmergencyStop:
+        emergencyStop(cmd.value != 0);
+        break;
+    default:
+        std::cerr << "[DEBUG] Unknown bus command " << static_cast<uint32_t>(cmd.type) << "\n";
+    }
+}
+
+bool MainController::sendCommand(BusCommandType type, const std::string& text, uint32_t* id, int32_t value) {
+    BusCommand cmd;
+    cmd.type = type;
+    cmd.id = bus->nextCommandId();
+    cmd.value = value;
+    copyBusText(cmd.text, text);
+    if (!bus->send(cmd)) {
+        std::cerr << "[DEBUG] robo_core command queue full.\n";
+        return false;
+    }
+    if (id) *id = cmd.id;
+    return true;
+}
+
+QString MainController::waitForRecognition(uint32_t id) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(REMOTE_RECOGNIZE_TIMEOUT_MS);
+    RobotState state;
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (bus->read(state) && state.recognition_id == id) return QString::fromUtf8(state.recognized);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::cerr << "[DEBUG] robo_core did not answer recognition request " << id << "\n";
+    return QString();
 }
 
 void MainController::exitSystem() {
-    // Stop navigation
+    if (bus) {
+        // robo_core keeps running for the next GUI session; just stop the robot
+        cancelNavigation();
+        releaseTeleop();
+        return;
+    }
+    stopVoiceNavigation();
+    if (microphone) microphone->stop();
+    stopWorker();
+    if (patientSync) patientSync->stop();
+    if (facePrefetcher) facePrefetcher->stop();
+    if (camera) camera->stop();
+
+    // Stop navigation and manual drive
     Nav::startNavigation.store(false);
-    Nav::pauseNavigation.store(false);
-    Nav::navCV.notify_all();
+    Nav::motion.release(MotionSource::Pause);
+    Nav::motion.release(MotionSource::Teleop);
+    stopMotionKeeper();
 
-    // Stop motors and clean up resources
-    MotorPins pins = {17, 16, 22, 23};  //init motor
-    Motor motor(pins);                 
-    motor.stop();                      // stop motor
+    // Stop motors on the shared hardware handles
+    HardwareContext::instance().stopAll();
 }
\ No newline at end of file
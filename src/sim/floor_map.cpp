@@ -0,0 +1,124 @@
+#include "floor_map.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <regex>
+#include <sstream>
+
+#define BEAM_HALF_ANGLE_DEG 15.0
+
+FloorMap::FloorMap(double scale_m) : scale_m(scale_m) {}
+
+void FloorMap::add(const std::string& name, double x1, double y1, double x2, double y2) {
+    Room r{name, std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2)};
+    if (room_list.empty()) {
+        min_x = r.x1; min_y = r.y1; max_x = r.x2; max_y = r.y2;
+    } else {
+        min_x = std::min(min_x, r.x1); min_y = std::min(min_y, r.y1);
+        max_x = std::max(max_x, r.x2); max_y = std::max(max_y, r.y2);
+    }
+    room_list.push_back(r);
+}
+
+bool FloorMap::load(PatientStore& store) {
+    std::vector<DepartmentRecord> departments = store.allDepartments();
+    for (const auto& d : departments) add(d.name, d.x1, d.y1, d.x2, d.y2);
+    return !departments.empty();
+}
+
+bool FloorMap::loadSql(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "[ERROR] Cannot open " << path << std::endl;
+        return false;
+    }
+    std::stringstream ss;
+    ss << in.rdbuf();
+    std::string sql = ss.str();
+
+    size_t begin = sql.find("INSERT INTO Departments");
+    if (begin == std::string::npos) return false;
+    size_t end = sql.find(';', begin);
+    std::string values = sql.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+
+    // ('Name', x1, y1, x2, y2)
+    static const std::regex tuple(R"re(\('((?:[^']|'')*)',\s*(-?\d+),\s*(-?\d+),\s*(-?\d+),\s*(-?\d+)\))re");
+    size_t before = room_list.size();
+    for (std::sregex_iterator it(values.begin(), values.end(), tuple), last; it != last; ++it) {
+        const std::smatch& m = *it;
+        add(m[1].str(), std::stod(m[2].str()), std::stod(m[3].str()),
+            std::stod(m[4].str()), std::stod(m[5].str()));
+    }
+    return room_list.size() > before;
+}
+
+const FloorMap::Room* FloorMap::find(const std::string& name) const {
+    for (const auto& r : room_list) {
+        if (r.name == name) return &r;
+    }
+    return nullptr;
+}
+
+double FloorMap::castRay(double x, double y, double heading) const {
+    // 换算到地图单位
+    double ox = x / scale_m, oy = y / scale_m;
+    double dx = std::cos(heading), dy = std::sin(heading);
+    const double inf = std::numeric_limits<double>::infinity();
+
+    // 外墙：从内部射出，取离开外包矩形的距离
+    auto exit = [&](double o, double d, double lo, double hi) {
+        if (d > 1e-12) return (hi - o) / d;
+        if (d < -1e-12) return (lo - o) / d;
+        return inf;
+    };
+    double best = std::min(exit(ox, dx, min_x, max_x), exit(oy, dy, min_y, max_y));
+    best = std::max(best, 0.0);
+
+    // 科室矩形：slab 法求射线进入距离
+    for (const auto& r : room_list) {
+        if (ox >= r.x1 && ox <= r.x2 && oy >= r.y1 && oy <= r.y2) continue;
+        double t_near = -inf, t_far = inf;
+        bool miss = false;
+        for (int axis = 0; axis < 2 && !miss; ++axis) {
+            double o = axis ? oy : ox;
+            double d = axis ? dy : dx;
+            double lo = axis ? r.y1 : r.x1;
+            double hi = axis ? r.y2 : r.x2;
+            if (std::abs(d) < 1e-12) {
+                if (o < lo || o > hi) miss = true;
+                continue;
+            }
+            double t1 = (lo - o) / d, t2 = (hi - o) / d;
+            if (t1 > t2) std::swap(t1, t2);
+            t_near = std::max(t_near, t1);
+            t_far = std::min(t_far, t2);
+            if (t_near > t_far) miss = true;
+        }
+        if (!miss && t_far >= 0.0 && t_near >= 0.0) best = std::min(best, t_near);
+    }
+    return best * scale_m;
+}
+
+double FloorMap::distanceTo(const Room& r, double x, double y) const {
+    double mx = x / scale_m, my = y / scale_m;
+    double dx = std::max({r.x1 - mx, 0.0, mx - r.x2});
+    double dy = std::max({r.y1 - my, 0.0, my - r.y2});
+    return std::hypot(dx, dy) * scale_m;
+}
+
+MapRangeSource::MapRangeSource(const FloorMap& map, const RobotModel& robot, double max_range_cm)
+    : map(map), robot(robot), max_range_cm(max_range_cm) {}
+
+float MapRangeSource::getDistance() const {
+    Pose p = robot.pose();
+    const double half = BEAM_HALF_ANGLE_DEG * M_PI / 180.0;
+    double nearest = std::min({map.castRay(p.x, p.y, p.heading - half),
+                               map.castRay(p.x, p.y, p.heading),
+                               map.castRay(p.x, p.y, p.heading + half)});
+    double cm = nearest * 100.0;
+    // 超声波超量程无回波
+    if (cm > max_range_cm) return RANGE_NO_ECHO;
+    return static_cast<float>(cm);
+}
@@ -0,0 +1,234 @@
+// 无头仿真：在虚拟时钟上快速回放 nav.json 中的路线，统计终点误差与到达用时
+//
+//   robo_sim [--nav ../config/nav.json] [--db ../config/hospital_guide.db]
+//            [--sql ../SQL/hospital_guide_init.sql] [--route 名称]... [--repeat N]
+//            [--start x,y,heading] [--scale 米/地图单位] [--timeout 秒] [--seed N]
+//            [--csv 输出文件] [--record 记录文件] [--verbose]
+//
+// 回放现场记录（HardwareContext 在设置 ROBO_TRACE_DIR 时写出）：
+//   robo_sim --replay trace.rht [--speed 倍速] [--imu-rate Hz] [--out 回放记录]
+#include "floor_map.h"
+#include "log.h"
+#include "patient_store.h"
+#include "route_sim.h"
+#include "trace_replay.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+// 终点航向误差超过这个值说明姿态融合出了问题（采样率、单位、积分），单独标出来并以非 0 退出
+#define HEADING_ALARM_DEG 15.0
+
+namespace {
+
+struct Stats {
+    int runs = 0;
+    int timeouts = 0;
+    double time_s = 0.0;
+    double error_m = 0.0;
+    double max_error_m = 0.0;
+    double heading_deg = 0.0;
+    double max_heading_deg = 0.0;
+    double target_m = 0.0;
+};
+
+void usage() {
+    std::cerr << "用法: robo_sim [--nav file] [--db file] [--sql file] [--route name]... [--repeat N]\n"
+                 "                [--start x,y,heading] [--scale m] [--timeout s] [--seed N]\n"
+                 "                [--csv file] [--record file] [--verbose]\n"
+                 "      robo_sim --replay trace.rht [--speed x] [--imu-rate hz] [--out file] [--verbose]\n";
+}
+
+int replay(const std::string& path, const ReplayOptions& opt, bool verbose) {
+    std::vector<Trace::Sample> samples;
+    if (!Trace::load(path, samples)) return 1;
+    std::vector<TraceTrip> trips = findTrips(samples);
+    std::cout << "[INFO] " << path << ": " << samples.size() << " records, "
+              << trips.size() << " trips" << std::endl;
+
+    TraceReplay engine(samples);
+    for (size_t i = 0; i < trips.size(); ++i) {
+        std::ostringstream sink;
+        std::streambuf* saved = verbose ? nullptr : std::cout.rdbuf(sink.rdbuf());
+        ReplayOptions trip_opt = opt;
+        if (!opt.out_path.empty() && trips.size() > 1) trip_opt.out_path += "." + std::to_string(i);
+        ReplayReport r = engine.run(trips[i], trip_opt);
+        if (saved) std::cout.rdbuf(saved);
+
+        std::printf("\n#%zu %s  (%d IMU, %d range samples)\n", i, r.recorded.target.c_str(),
+                    r.imu_samples, r.range_samples);
+        std::printf("  %-14s %8s %10s %10s\n", "step", "value", "recorded_s", "replayed_s");
+        size_t steps = std::max(r.recorded.steps.size(), r.replayed.steps.size());
+        for (size_t k = 0; k < steps; ++k) {
+            const TraceTrip::Step* a = k < r.recorded.steps.size() ? &r.recorded.steps[k] : nullptr;
+            const TraceTrip::Step* b = k < r.replayed.steps.size() ? &r.replayed.steps[k] : nullptr;
+            const TraceTrip::Step* s = a ? a : b;
+            std::printf("  %-14s %8d %10s %10s\n", s->action.c_str(), s->value,
+                        a ? std::to_string(a->at_s).substr(0, 6).c_str() : "-",
+                        b ? std::to_string(b->at_s).substr(0, 6).c_str() : "-");
+        }
+        std::printf("  %-14s %8s %10.3f %10.3f\n", r.recorded.completed ? "end" : "end (cancel)", "",
+                    r.recorded.duration(), r.replayed.duration());
+        if (r.divergence < 0) {
+            std::printf("  motor commands identical (%zu changes)\n", r.recorded.commands.size());
+        } else {
+            std::printf("  motor commands diverge at change #%d of %zu/%zu\n", r.divergence,
+                        r.recorded.commands.size(), r.replayed.commands.size());
+        }
+    }
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string nav_path = "../config/nav.json";
+    std::string db_path = "../config/hospital_guide.db";
+    std::string sql_path = "../SQL/hospital_guide_init.sql";
+    std::string csv_path;
+    std::string record_path;
+    std::string replay_path;
+    ReplayOptions replay_opt;
+    std::vector<std::string> routes;
+    int repeat = 1;
+    bool verbose = false;
+    double scale = 0.5;
+    double start_x = 17.0, start_y = 27.0, start_heading = 0.0;   // 地图单位 / 度
+    SimOptions opt;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                usage();
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if (arg == "--nav") nav_path = next();
+        else if (arg == "--db") db_path = next();
+        else if (arg == "--sql") sql_path = next();
+        else if (arg == "--route") routes.push_back(next());
+        else if (arg == "--repeat") repeat = std::max(1, std::atoi(next().c_str()));
+        else if (arg == "--scale") scale = std::atof(next().c_str());
+        else if (arg == "--timeout") opt.timeout_s = std::atof(next().c_str());
+        else if (arg == "--seed") opt.seed = static_cast<unsigned>(std::atoi(next().c_str()));
+        else if (arg == "--csv") csv_path = next();
+        else if (arg == "--record") record_path = next();
+        else if (arg == "--replay") replay_path = next();
+        else if (arg == "--speed") replay_opt.speed = std::atof(next().c_str());
+        else if (arg == "--imu-rate") replay_opt.imu_rate_hz = std::atoi(next().c_str());
+        else if (arg == "--out") replay_opt.out_path = next();
+        else if (arg == "--verbose") verbose = true;
+        else if (arg == "--start") {
+            if (std::sscanf(next().c_str(), "%lf,%lf,%lf", &start_x, &start_y, &start_heading) < 2) {
+                usage();
+                return 1;
+            }
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    // 导航过程的逐步输出很多，默认只看告警
+    if (!verbose) Log::setLevel(Log::Warn);
+    if (!replay_path.empty()) return replay(replay_path, replay_opt, verbose);
+
+    std::ifstream navFile(nav_path);
+    if (!navFile) {
+        std::cerr << "❌ 无法打开 " << nav_path << std::endl;
+        return 1;
+    }
+    nlohmann::json navJson;
+    navFile >> navJson;
+    if (routes.empty()) {
+        for (auto it = navJson.begin(); it != navJson.end(); ++it) routes.push_back(it.key());
+    }
+
+    // 楼层图：优先本地患者库，没有时解析建库脚本
+    FloorMap map(scale);
+    PatientStore store;
+    if (!(store.open(db_path) && map.load(store)) && !map.loadSql(sql_path)) {
+        std::cerr << "❌ 无法加载科室平面图" << std::endl;
+        return 1;
+    }
+    std::cout << "[INFO] Floor map: " << map.rooms().size() << " departments, "
+              << scale << " m/unit" << std::endl;
+
+    opt.start.x = start_x * scale;
+    opt.start.y = start_y * scale;
+    opt.start.heading = start_heading * M_PI / 180.0;
+
+    std::ofstream csv;
+    if (!csv_path.empty()) {
+        csv.open(csv_path);
+        csv << "department,run,timed_out,time_s,x_m,y_m,heading_deg,ideal_x_m,ideal_y_m,"
+               "error_m,heading_error_deg,target_distance_m,left_ticks,right_ticks\n";
+    }
+
+    std::map<std::string, Stats> stats;
+    double sim_total = 0.0;
+    auto wall_start = std::chrono::steady_clock::now();
+    // 驱动构造/析构等仍走 std::cout 的提示也静音
+    std::ostringstream sink;
+    std::streambuf* saved = verbose ? nullptr : std::cout.rdbuf(sink.rdbuf());
+    {
+        RouteSimulator sim(map, opt);
+        if (!record_path.empty()) Trace::start(record_path);
+        for (int run = 0; run < repeat; ++run) {
+            for (const auto& route : routes) {
+                RouteResult r = sim.run(route, navJson);
+                sink.str("");
+                sim_total += r.time_s;
+
+                Stats& s = stats[route];
+                ++s.runs;
+                s.timeouts += r.timed_out;
+                s.time_s += r.time_s;
+                s.error_m += r.error_m;
+                s.max_error_m = std::max(s.max_error_m, r.error_m);
+                s.heading_deg += std::abs(r.heading_error_deg);
+                s.max_heading_deg = std::max(s.max_heading_deg, std::abs(r.heading_error_deg));
+                s.target_m += r.target_distance_m;
+
+                if (csv.is_open()) {
+                    csv << '"' << route << "\"," << run << ',' << r.timed_out << ',' << r.time_s << ','
+                        << r.final_pose.x << ',' << r.final_pose.y << ','
+                        << r.final_pose.heading * 180.0 / M_PI << ','
+                        << r.ideal_pose.x << ',' << r.ideal_pose.y << ','
+                        << r.error_m << ',' << r.heading_error_deg << ',' << r.target_distance_m << ','
+                        << r.left_ticks << ',' << r.right_ticks << '\n';
+                }
+            }
+        }
+        Trace::stop();
+    }
+    if (saved) std::cout.rdbuf(saved);
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+
+    std::printf("%-36s %5s %4s %8s %8s %8s %8s %8s\n",
+                "department", "runs", "t/o", "time_s", "err_m", "max_m", "hdg_deg", "target_m");
+    int alarms = 0;
+    for (const auto& [name, s] : stats) {
+        bool alarm = s.max_heading_deg > HEADING_ALARM_DEG;
+        alarms += alarm;
+        std::printf("%-36.36s %5d %4d %8.2f %8.3f %8.3f %8.1f %8.2f%s\n",
+                    name.c_str(), s.runs, s.timeouts, s.time_s / s.runs, s.error_m / s.runs,
+                    s.max_error_m, s.heading_deg / s.runs, s.target_m / s.runs, alarm ? "  !" : "");
+    }
+    std::printf("\n%d routes, %.1f s simulated in %.2f s wall (%.0fx real time)\n",
+                repeat * static_cast<int>(routes.size()), sim_total, wall, wall > 0 ? sim_total / wall : 0.0);
+    if (alarms) {
+        std::fprintf(stderr, "[ERROR] %d route(s) ended more than %.0f deg off the expected heading (marked !)\n",
+                     alarms, HEADING_ALARM_DEG);
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include "robot_model.h"
+#include "sim_board.h"
+#include <algorithm>
+#include <cmath>
+
+// 编码器 A/B 相引脚（与 tests/drivers/encoder 一致）
+#define ENC_LEFT_A  27
+#define ENC_LEFT_B  26
+#define ENC_RIGHT_A 20
+#define ENC_RIGHT_B 21
+
+#define GRAVITY 9.80665
+#define DEG (M_PI / 180.0)
+
+RobotModel::RobotModel(const RobotParams& params, unsigned seed) : p(params), rng(seed) {}
+
+void RobotModel::attach(const Motor* m, const Servo* s) {
+    std::lock_guard<std::mutex> lock(mtx);
+    motor = m;
+    servo = s;
+}
+
+void RobotModel::reset(const Pose& pose) {
+    std::lock_guard<std::mutex> lock(mtx);
+    state = pose;
+    v_left = v_right = 0.0;
+    yaw_rate = accel = 0.0;
+    dist_left = dist_right = 0.0;
+    ticks_left = ticks_right = 0;
+    updateEncoders();
+}
+
+double RobotModel::wheelTarget(int command) const {
+    int duty = std::abs(command);
+    if (duty <= p.deadband_duty) return 0.0;
+    double v = p.max_speed_mps * (duty - p.deadband_duty) / (100.0 - p.deadband_duty);
+    return command < 0 ? -v : v;
+}
+
+double RobotModel::steadySpeed(int duty) const {
+    return wheelTarget(duty);
+}
+
+double RobotModel::steerAngle(int pulse_us) const {
+    // 舵机 600~2400us 对应 ±90°，小于中位为左
+    double servo_deg = (1500 - pulse_us) / 900.0 * 90.0;
+    double wheel_deg = std::clamp(servo_deg * p.steer_ratio, -p.max_steer_deg, p.max_steer_deg);
+    return wheel_deg * DEG;
+}
+
+void RobotModel::step(double dt) {
+    std::lock_guard<std::mutex> lock(mtx);
+    int left = motor ? motor->leftCommand() : 0;
+    int right = motor ? motor->rightCommand() : 0;
+    int pulse = servo ? servo->pulseUs() : 1500;
+
+    // 轮速一阶滞后
+    double k = 1.0 - std::exp(-dt / p.motor_tau_s);
+    double v_before = 0.5 * (v_left + v_right);
+    v_left += (wheelTarget(left) - v_left) * k;
+    v_right += (wheelTarget(right) - v_right) * k;
+
+    // 舵机限速转向
+    double target = steerAngle(pulse);
+    double max_delta = p.servo_rate_dps * p.steer_ratio * DEG * dt;
+    steer += std::clamp(target - steer, -max_delta, max_delta);
+
+    // 前轮转向 + 两侧差速
+    double v = 0.5 * (v_left + v_right);
+    yaw_rate = v * std::tan(steer) / p.wheelbase_m + (v_right - v_left) / p.track_m;
+    accel = (v - v_before) / dt;
+
+    state.heading += yaw_rate * dt;
+    state.x += v * std::cos(state.heading) * dt;
+    state.y += v * std::sin(state.heading) * dt;
+
+    dist_left += v_left * dt;
+    dist_right += v_right * dt;
+    updateEncoders();
+}
+
+void RobotModel::updateEncoders() {
+    long l = static_cast<long>(std::floor(dist_left * p.ticks_per_m));
+    long r = static_cast<long>(std::floor(dist_right * p.ticks_per_m));
+    if (l == ticks_left && r == ticks_right && (l || r)) return;
+    ticks_left = l;
+    ticks_right = r;
+
+    // 正交编码：00 -> 01 -> 11 -> 10
+    static const int gray[4][2] = {{0, 0}, {0, 1}, {1, 1}, {1, 0}};
+    SimBoard& board = SimBoard::instance();
+    const int* gl = gray[((l % 4) + 4) % 4];
+    const int* gr = gray[((r % 4) + 4) % 4];
+    board.line(ENC_LEFT_A).value.store(gl[0]);
+    board.line(ENC_LEFT_B).value.store(gl[1]);
+    board.line(ENC_RIGHT_A).value.store(gr[0]);
+    board.line(ENC_RIGHT_B).value.store(gr[1]);
+}
+
+Pose RobotModel::pose() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return state;
+}
+
+double RobotModel::speed() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return 0.5 * (v_left + v_right);
+}
+
+long RobotModel::leftTicks() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return ticks_left;
+}
+
+long RobotModel::rightTicks() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return ticks_right;
+}
+
+void RobotModel::imuRegisters(uint8_t* buf, size_t len) {
+    std::lock_guard<std::mutex> lock(mtx);
+    double v = 0.5 * (v_left + v_right);
+    double ax = accel / GRAVITY + p.accel_noise_g * unit(rng);
+    double ay = v * yaw_rate / GRAVITY + p.accel_noise_g * unit(rng);
+    double az = 1.0 + p.accel_noise_g * unit(rng);
+    double gx = p.gyro_noise_dps * unit(rng);
+    double gy = p.gyro_noise_dps * unit(rng);
+    double gz = yaw_rate / DEG + p.gyro_bias_dps + p.gyro_noise_dps * unit(rng);
+
+    // ±2g: 16384 LSB/g，±250dps: 131 LSB/(°/s)
+    auto raw = [](double value, double scale) {
+        return static_cast<int16_t>(std::clamp(value * scale, -32768.0, 32767.0));
+    };
+    int16_t words[7] = {raw(ax, 16384), raw(ay, 16384), raw(az, 16384), 0,
+                        raw(gx, 131), raw(gy, 131), raw(gz, 131)};
+    for (size_t i = 0; i < len; ++i) {
+        uint16_t w = static_cast<uint16_t>(words[(i / 2) % 7]);
+        buf[i] = (i % 2 == 0) ? static_cast<uint8_t>(w >> 8) : static_cast<uint8_t>(w & 0xFF);
+    }
+}
@@ -0,0 +1,130 @@
+#include "route_sim.h"
+#include "hal.h"
+#include "hardware_context.h"
+#include "nav.h"
+#include "sim_board.h"
+#include <cmath>
+#include <iostream>
+
+#define MPU_ADDRESS 0x68
+#define MPU_DATA_REG 0x3B
+
+// 与 nav.cpp / servo.cpp 一致：前进占空比 40，转弯时舵机打 45°
+#define NAV_FORWARD_DUTY 40
+#define NAV_TURN_SERVO_DEG 45
+#define SERVO_CENTER_US 1500
+#define SERVO_SPAN_US 900
+
+RouteSimulator::RouteSimulator(const FloorMap& map, const SimOptions& options)
+    : map(map),
+      opt(options),
+      clock(options.step_ns),
+      model(options.robot, options.seed),
+      range(map, model)
+{
+    Hal::setBackend(Hal::Backend::Sim);
+    SimBoard& board = SimBoard::instance();
+    board.reset();
+    board.setEdgeLimit(0);   // PWM 波形不需要留档
+
+    // 本线程驱动导航，先加入锁步再切换时钟，保证其他线程启动时不会抢跑
+    clock.enter();
+    clock.setStepCallback([this](uint64_t from, uint64_t to) { step(from, to); });
+    Clock::setSource(&clock);
+
+    board.i2c(MPU_ADDRESS).read_handler = [this](uint8_t reg, uint8_t* buf, size_t len) {
+        if (reg != MPU_DATA_REG) return false;
+        model.imuRegisters(buf, len);
+        return true;
+    };
+
+    MotorPins pins = MOTOR_PINS;
+    motor = std::make_unique<Motor>(pins);
+    servo = std::make_unique<Servo>(SERVO_PIN);
+    yaw = std::make_unique<YawTracker>();
+    yaw->start(YAW_RATE_HZ);
+    clock.waitForParticipants(2);   // 本线程 + IMU 采集线程
+    model.attach(motor.get(), servo.get());
+    Nav::speedGovernor.attach(&range);
+}
+
+RouteSimulator::~RouteSimulator() {
+    Nav::speedGovernor.attach(nullptr);
+    model.attach(nullptr, nullptr);
+    // 先放开时钟，采集线程才能从 sleep 返回并被 join
+    clock.release();
+    yaw.reset();
+    servo.reset();
+    motor.reset();
+    Clock::setSource(nullptr);
+    SimBoard::instance().reset();
+}
+
+void RouteSimulator::step(uint64_t from_ns, uint64_t to_ns) {
+    model.step((to_ns - from_ns) * 1e-9);
+    uint64_t deadline = deadline_ns.load();
+    if (deadline && to_ns >= deadline && !timed_out.exchange(true)) {
+        Nav::startNavigation.store(false);
+    }
+}
+
+Pose RouteSimulator::idealEnd(const nlohmann::json& path) const {
+    Pose p = opt.start;
+    const double v = model.steadySpeed(NAV_FORWARD_DUTY);
+    const int turn_us = SERVO_SPAN_US * NAV_TURN_SERVO_DEG / 90;
+
+    for (const auto& step : path) {
+        if (!step.contains("action") || !step.contains("value")) continue;
+        std::string action = step["action"];
+        double value = step["value"];
+
+        if (action == "moveForward") {
+            double s = v * value / 1000.0;
+            p.x += s * std::cos(p.heading);
+            p.y += s * std::sin(p.heading);
+        } else if (action == "turnLeft" || action == "turnRight") {
+            bool left = action == "turnLeft";
+            double delta = model.steerAngle(SERVO_CENTER_US + (left ? -turn_us : turn_us));
+            double curvature = std::tan(delta) / model.params().wheelbase_m;
+            double dh = (left ? 1.0 : -1.0) * value * M_PI / 180.0;
+            // 定曲率圆弧
+            p.x += (std::sin(p.heading + dh) - std::sin(p.heading)) / curvature;
+            p.y += (std::cos(p.heading) - std::cos(p.heading + dh)) / curvature;
+            p.heading += dh;
+        }
+    }
+    return p;
+}
+
+RouteResult RouteSimulator::run(const std::string& department, const nlohmann::json& navJson) {
+    RouteResult r;
+    r.department = department;
+
+    model.reset(opt.start);
+    timed_out.store(false);
+    uint64_t start = clock.nowNs();
+    deadline_ns.store(start + static_cast<uint64_t>(opt.timeout_s * 1e9));
+
+    Nav::startNavigation.store(true);
+    Nav::navigationThread(motor.get(), servo.get(), yaw.get(), department, navJson);
+    Nav::startNavigation.store(false);
+    motor->stop();
+
+    deadline_ns.store(0);
+    r.time_s = (clock.nowNs() - start) * 1e-9;
+    r.timed_out = timed_out.load();
+    r.final_pose = model.pose();
+    r.left_ticks = model.leftTicks();
+    r.right_ticks = model.rightTicks();
+
+    if (navJson.contains(department) && navJson[department].contains("path")) {
+        r.ideal_pose = idealEnd(navJson[department]["path"]);
+        r.error_m = std::hypot(r.final_pose.x - r.ideal_pose.x, r.final_pose.y - r.ideal_pose.y);
+        double dh = std::remainder(r.final_pose.heading - r.ideal_pose.heading, 2.0 * M_PI);
+        r.heading_error_deg = dh * 180.0 / M_PI;
+    }
+    if (const FloorMap::Room* room = map.find(department)) {
+        r.target_distance_m = map.distanceTo(*room, r.final_pose.x, r.final_pose.y);
+    }
+    return r;
+}
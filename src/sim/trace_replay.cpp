@@ -0,0 +1,180 @@
+#include "trace_replay.h"
+#include "hal.h"
+#include "hardware_context.h"
+#include "nav.h"
+#include "range_source.h"
+#include "sim_board.h"
+#include "virtual_clock.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+
+// 回放超过原记录时长的倍数后视为卡住，取消导航
+#define REPLAY_TIMEOUT_FACTOR 3.0
+#define REPLAY_TIMEOUT_SLACK_S 10.0
+
+namespace {
+
+// 按时间戳给出记录中的超声波读数（取不晚于当前时刻的最后一条）
+class TraceRangeSource : public RangeSource {
+public:
+    void add(uint64_t rel_ns, float cm) { readings.emplace_back(rel_ns, cm); }
+    size_t size() const { return readings.size(); }
+
+    float getDistance() const override {
+        uint64_t now = Clock::nowNs();
+        auto it = std::upper_bound(readings.begin(), readings.end(), std::make_pair(now, 1e30f));
+        if (it == readings.begin()) return RANGE_NO_ECHO;
+        return std::prev(it)->second;
+    }
+
+private:
+    std::vector<std::pair<uint64_t, float>> readings;
+};
+
+}  // namespace
+
+std::vector<TraceTrip> findTrips(const std::vector<Trace::Sample>& samples) {
+    std::vector<TraceTrip> trips;
+    TraceTrip* open = nullptr;
+    for (const auto& s : samples) {
+        if (s.type == Trace::Type::Nav) {
+            auto event = static_cast<Trace::NavEvent>(s.a);
+            if (event == Trace::NavEvent::Start) {
+                TraceTrip trip;
+                size_t split = s.text.find('\n');
+                trip.target = s.text.substr(0, split);
+                if (split != std::string::npos) {
+                    trip.path = nlohmann::json::parse(s.text.substr(split + 1), nullptr, false);
+                }
+                trip.start_ns = trip.end_ns = s.t_ns;
+                trips.push_back(std::move(trip));
+                open = &trips.back();
+            } else if (open && event == Trace::NavEvent::Step) {
+                open->steps.push_back({s.text, s.b, (s.t_ns - open->start_ns) * 1e-9});
+            } else if (open && event == Trace::NavEvent::End) {
+                open->end_ns = s.t_ns;
+                open->completed = s.b != 0;
+                open = nullptr;
+            }
+        } else if (open && s.type == Trace::Type::Motor) {
+            std::pair<int, int> cmd(s.a, s.b);
+            if (open->commands.empty() || open->commands.back() != cmd) open->commands.push_back(cmd);
+            open->end_ns = s.t_ns;
+        }
+    }
+    return trips;
+}
+
+TraceReplay::TraceReplay(const std::vector<Trace::Sample>& samples) : samples(samples) {}
+
+ReplayReport TraceReplay::run(const TraceTrip& trip, const ReplayOptions& opt) {
+    ReplayReport report;
+    report.recorded = trip;
+    if (!trip.path.is_array()) {
+        std::cerr << "[ERROR] Trip to " << trip.target << " has no path in the trace" << std::endl;
+        return report;
+    }
+
+    // 导航开始时刻对齐到虚拟时间 0，之前的 IMU 数据用来预热
+    const uint64_t warmup_ns = static_cast<uint64_t>(opt.warmup_s * 1e9);
+    const uint64_t from = trip.start_ns > warmup_ns ? trip.start_ns - warmup_ns : 0;
+    const uint64_t deadline = static_cast<uint64_t>(
+        (trip.duration() * REPLAY_TIMEOUT_FACTOR + REPLAY_TIMEOUT_SLACK_S) * 1e9);
+    std::vector<std::pair<uint64_t, const Trace::Sample*>> imu;
+    std::vector<const Trace::Sample*> warmup;
+    TraceRangeSource range;
+    for (const auto& s : samples) {
+        if (s.t_ns < from) continue;
+        if (s.t_ns > trip.start_ns + deadline) break;
+        if (s.type == Trace::Type::Imu) {
+            if (s.t_ns < trip.start_ns) warmup.push_back(&s);
+            else imu.emplace_back(s.t_ns - trip.start_ns, &s);
+        } else if (s.type == Trace::Type::Range && s.t_ns >= trip.start_ns) {
+            range.add(s.t_ns - trip.start_ns, s.v[0]);
+        }
+    }
+    report.imu_samples = static_cast<int>(warmup.size() + imu.size());
+    report.range_samples = static_cast<int>(range.size());
+
+    std::string out = opt.out_path;
+    bool temporary = out.empty();
+    if (temporary) {
+        char name[] = "/tmp/robo_replay_XXXXXX";
+        int fd = mkstemp(name);
+        if (fd < 0) {
+            std::cerr << "[ERROR] Cannot create temporary trace file" << std::endl;
+            return report;
+        }
+        close(fd);
+        out = name;
+    }
+
+    Hal::setBackend(Hal::Backend::Sim);
+    SimBoard& board = SimBoard::instance();
+    board.reset();
+    board.setEdgeLimit(0);
+
+    VirtualClock clock;
+    clock.enter();
+    Clock::setSource(&clock);
+    {
+        MotorPins pins = MOTOR_PINS;
+        Motor motor(pins);
+        Servo servo(SERVO_PIN);
+        YawTracker yaw(nullptr);
+        yaw.start(opt.imu_rate_hz);
+        for (const auto* s : warmup) yaw.feed(s->v, s->v + 3);
+
+        // IMU 帧在时钟推进时按原时间戳送入；导航线程读 yaw 之前，该时刻及以前的帧都已送完
+        size_t next = 0;
+        const auto wall_start = std::chrono::steady_clock::now();
+        clock.setStepCallback([&](uint64_t, uint64_t to) {
+            while (next < imu.size() && imu[next].first <= to) {
+                yaw.feed(imu[next].second->v, imu[next].second->v + 3);
+                ++next;
+            }
+            if (to >= deadline) Nav::startNavigation.store(false);
+            if (opt.speed > 0.0) {
+                std::this_thread::sleep_until(wall_start + std::chrono::nanoseconds(
+                    static_cast<int64_t>(to / opt.speed)));
+            }
+        });
+
+        Nav::speedGovernor.attach(&range);
+        nlohmann::json navJson;
+        navJson[trip.target]["path"] = trip.path;
+
+        Trace::start(out);
+        Nav::startNavigation.store(true);
+        Nav::navigationThread(&motor, &servo, &yaw, trip.target, navJson);
+        Nav::startNavigation.store(false);
+        Trace::stop();
+
+        Nav::speedGovernor.attach(nullptr);
+        clock.setStepCallback(nullptr);
+        clock.release();
+    }
+    Clock::setSource(nullptr);
+    board.reset();
+
+    std::vector<Trace::Sample> replayed;
+    if (Trace::load(out, replayed)) {
+        std::vector<TraceTrip> trips = findTrips(replayed);
+        if (!trips.empty()) report.replayed = trips.front();
+    }
+    if (temporary) std::remove(out.c_str());
+
+    const auto& a = report.recorded.commands;
+    const auto& b = report.replayed.commands;
+    for (size_t i = 0; i < std::max(a.size(), b.size()); ++i) {
+        if (i >= a.size() || i >= b.size() || a[i] != b[i]) {
+            report.divergence = static_cast<int>(i);
+            break;
+        }
+    }
+    return report;
+}
@@ -0,0 +1,105 @@
+#include "virtual_clock.h"
+
+namespace {
+
+// 线程退出时自动离开所属的虚拟时钟
+struct Membership {
+    VirtualClock* clock = nullptr;
+    ~Membership() {
+        if (clock) clock->leave();
+    }
+};
+
+thread_local Membership membership;
+
+}  // namespace
+
+VirtualClock::VirtualClock(uint64_t max_step_ns) : max_step(max_step_ns ? max_step_ns : 1000000) {}
+
+VirtualClock::~VirtualClock() {
+    release();
+    if (membership.clock == this) membership.clock = nullptr;
+}
+
+uint64_t VirtualClock::nowNs() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return now;
+}
+
+void VirtualClock::setStepCallback(StepCallback cb) {
+    std::lock_guard<std::mutex> lock(mtx);
+    step = std::move(cb);
+}
+
+void VirtualClock::enter() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (membership.clock == this) return;
+    if (membership.clock) membership.clock->leave();
+    membership.clock = this;
+    ++participants;
+    cv.notify_all();
+}
+
+void VirtualClock::waitForParticipants(int n) {
+    std::unique_lock<std::mutex> lock(mtx);
+    cv.wait(lock, [&] { return participants >= n || released; });
+}
+
+void VirtualClock::sleepNs(uint64_t ns) {
+    std::unique_lock<std::mutex> lock(mtx);
+    if (released) return;
+    if (membership.clock != this) {
+        lock.unlock();
+        enter();
+        lock.lock();
+        if (released) return;
+    }
+
+    const uint64_t wake = now + ns;
+    auto slot = wakeups.emplace(wake, 0);
+    ++sleeping;
+    while (!released && now < wake) {
+        // 已到期但还没跑起来的线程也算作睡眠中，要等它先运行
+        if (sleeping == participants && wakeups.begin()->first > now) {
+            advanceLocked();
+        } else {
+            cv.wait(lock);
+        }
+    }
+    wakeups.erase(slot);
+    --sleeping;
+}
+
+void VirtualClock::advanceLocked() {
+    // 所有参与者都在睡：把时间推进到最早的唤醒时刻
+    uint64_t target = wakeups.begin()->first;
+    while (now < target) {
+        uint64_t next = target - now > max_step ? now + max_step : target;
+        if (step) step(now, next);
+        now = next;
+    }
+    cv.notify_all();
+}
+
+void VirtualClock::leave() {
+    std::lock_guard<std::mutex> lock(mtx);
+    leaveLocked();
+}
+
+void VirtualClock::leaveLocked() {
+    if (membership.clock != this) return;
+    membership.clock = nullptr;
+    --participants;
+    // 剩下的参与者可能都在等这个线程
+    cv.notify_all();
+    if (!released && participants > 0 && sleeping == participants &&
+        !wakeups.empty() && wakeups.begin()->first > now) {
+        advanceLocked();
+    }
+}
+
+void VirtualClock::release() {
+    std::lock_guard<std::mutex> lock(mtx);
+    released = true;
+    cv.notify_all();
+}
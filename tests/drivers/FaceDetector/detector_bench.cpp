@@ -0,0 +1,195 @@
+// 人脸检测基准：同一组图片上对比 Haar 与 DNN 检测器的单帧延迟、批量吞吐和召回率
+// 用法（在 build 目录下）：
+//   ./detector_bench <图片目录> [标注文件] [--runs N] [--batch N] [--threads N]
+//                    [--model 模型] [--config 配置] [--cascade 级联文件]
+// 标注文件每行一张脸：<文件名> x y w h，同一文件多张脸写多行；
+// 不给标注时认为每张图恰好一张脸，召回率 = 检出至少一张脸的图片比例。
+#include "face_detector.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define IOU_MATCH 0.4   // Haar 框偏紧、SSD 框偏松，0.4 对两者都公平
+
+struct Sample {
+    std::string name;
+    cv::Mat gray;
+    std::vector<cv::Rect> truth;   // 标注的人脸框
+};
+
+struct Result {
+    std::vector<double> ms;        // 每帧延迟
+    int truth = 0;
+    int hits = 0;
+    int false_pos = 0;
+};
+
+static double iou(const cv::Rect& a, const cv::Rect& b) {
+    int x1 = std::max(a.x, b.x), y1 = std::max(a.y, b.y);
+    int x2 = std::min(a.x + a.width, b.x + b.width), y2 = std::min(a.y + a.height, b.y + b.height);
+    if (x2 <= x1 || y2 <= y1) return 0.0;
+    double inter = static_cast<double>(x2 - x1) * (y2 - y1);
+    return inter / (a.area() + b.area() - inter);
+}
+
+static void score(const Sample& s, bool annotated, const std::vector<cv::Rect>& found, Result& r) {
+    if (!annotated) {
+        r.truth += 1;
+        r.hits += found.empty() ? 0 : 1;
+        r.false_pos += found.size() > 1 ? static_cast<int>(found.size()) - 1 : 0;
+        return;
+    }
+    std::vector<bool> used(found.size(), false);
+    for (const auto& t : s.truth) {
+        r.truth += 1;
+        for (size_t i = 0; i < found.size(); ++i) {
+            if (!used[i] && iou(t, found[i]) >= IOU_MATCH) {
+                used[i] = true;
+                r.hits += 1;
+                break;
+            }
+        }
+    }
+    r.false_pos += static_cast<int>(std::count(used.begin(), used.end(), false));
+}
+
+static double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    size_t i = std::min(v.size() - 1, static_cast<size_t>(p * (v.size() - 1) + 0.5));
+    return v[i];
+}
+
+static void report(const std::string& name, const Result& r) {
+    double sum = 0.0;
+    for (double v : r.ms) sum += v;
+    double mean = r.ms.empty() ? 0.0 : sum / r.ms.size();
+    double recall = r.truth ? 100.0 * r.hits / r.truth : 0.0;
+    std::printf("%-14s %8.2f %8.2f %8.2f %9.1f%% %6d/%-6d %6d\n", name.c_str(), mean, percentile(r.ms, 0.5),
+                percentile(r.ms, 0.95), recall, r.hits, r.truth, r.false_pos);
+}
+
+static Result runSingle(FaceDetector& detector, const std::vector<Sample>& samples, bool annotated, int runs) {
+    Result r;
+    // 预热：第一次前向会分配网络内部缓冲
+    if (!samples.empty()) detector.detect(samples.front().gray);
+    for (int run = 0; run < runs; ++run) {
+        for (const auto& s : samples) {
+            auto t0 = std::chrono::steady_clock::now();
+            std::vector<cv::Rect> found = detector.detect(s.gray);
+            auto t1 = std::chrono::steady_clock::now();
+            r.ms.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+            if (run == 0) score(s, annotated, found, r);
+        }
+    }
+    return r;
+}
+
+// 每 batch 张一组前向，记录的是摊到每张图上的时间
+static Result runBatch(FaceDetector& detector, const std::vector<Sample>& samples, bool annotated, int runs, int batch) {
+    Result r;
+    std::vector<cv::Mat> frames;
+    for (int run = 0; run < runs; ++run) {
+        for (size_t start = 0; start < samples.size(); start += batch) {
+            size_t end = std::min(samples.size(), start + batch);
+            frames.clear();
+            for (size_t i = start; i < end; ++i) frames.push_back(samples[i].gray);
+            auto t0 = std::chrono::steady_clock::now();
+            auto found = detector.detectBatch(frames);
+            auto t1 = std::chrono::steady_clock::now();
+            double per = std::chrono::duration<double, std::milli>(t1 - t0).count() / frames.size();
+            for (size_t i = start; i < end; ++i) {
+                r.ms.push_back(per);
+                if (run == 0) score(samples[i], annotated, found[i - start], r);
+            }
+        }
+    }
+    return r;
+}
+
+static std::map<std::string, std::vector<cv::Rect>> loadLabels(const std::string& path) {
+    std::map<std::string, std::vector<cv::Rect>> labels;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream ss(line);
+        std::string name;
+        cv::Rect r;
+        if (ss >> name >> r.x >> r.y >> r.width >> r.height) labels[name].push_back(r);
+    }
+    return labels;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <image dir> [labels.txt] [--runs N] [--batch N] [--threads N]"
+                  << " [--model M] [--config C] [--cascade X]\n";
+        return 1;
+    }
+    std::string image_dir = argv[1];
+    std::string label_file;
+    int runs = 3, batch = 4;
+    DnnDetectorConfig dnn_cfg;
+    std::string cascade = HAAR_CASCADE_PATH;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--runs" && has_value) runs = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--batch" && has_value) batch = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--threads" && has_value) dnn_cfg.threads = std::atoi(argv[++i]);
+        else if (arg == "--model" && has_value) dnn_cfg.model = argv[++i];
+        else if (arg == "--config" && has_value) dnn_cfg.config = argv[++i];
+        else if (arg == "--cascade" && has_value) cascade = argv[++i];
+        else label_file = arg;
+    }
+
+    bool annotated = !label_file.empty();
+    auto labels = annotated ? loadLabels(label_file) : std::map<std::string, std::vector<cv::Rect>>();
+
+    std::vector<std::string> files;
+    for (const auto& entry : std::filesystem::directory_iterator(image_dir)) {
+        if (entry.is_regular_file()) files.push_back(entry.path().string());
+    }
+    std::sort(files.begin(), files.end());
+
+    std::vector<Sample> samples;
+    for (const auto& file : files) {
+        Sample s;
+        s.gray = cv::imread(file, cv::IMREAD_GRAYSCALE);
+        if (s.gray.empty()) continue;
+        s.name = std::filesystem::path(file).filename().string();
+        if (annotated) {
+            auto it = labels.find(s.name);
+            if (it != labels.end()) s.truth = it->second;
+        }
+        samples.push_back(std::move(s));
+    }
+    if (samples.empty()) {
+        std::cerr << "no readable images in " << image_dir << std::endl;
+        return 1;
+    }
+    std::cout << samples.size() << " images, " << runs << " runs, "
+              << (annotated ? "IoU-matched against " + label_file : std::string("one face per image assumed")) << "\n\n";
+    std::printf("%-14s %8s %8s %8s %10s %13s %6s\n", "detector", "mean ms", "p50 ms", "p95 ms", "recall", "hits/faces", "extra");
+
+    HaarFaceDetector haar;
+    if (haar.load(cascade)) report("haar", runSingle(haar, samples, annotated, runs));
+
+    DnnFaceDetector dnn;
+    if (dnn.load(dnn_cfg)) {
+        report("dnn", runSingle(dnn, samples, annotated, runs));
+        report("dnn batch " + std::to_string(batch), runBatch(dnn, samples, annotated, runs, batch));
+    } else {
+        std::cerr << "DNN model not found, download it into source/models (see README)\n";
+    }
+    return 0;
+}